@@ -35,4 +35,11 @@ namespace FB
 }
 namespace FB::Actors {
     RE::Actor* ResolveActorForEvent(const FBEvent& e, ActorRole role);
+
+    // Marks a new update frame: the loaded-actor positions behind Target resolution are refreshed
+    // by the first query after this, so any number of queries in one frame share one refresh.
+    void BeginFrame();
+
+    // Actor behind a bound handle, or nullptr once the handle is stale (reference unloaded/deleted).
+    RE::Actor* ResolveHandle(const RE::ActorHandle& handle);
 }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// In-game benchmark of the plugin's hot paths, for comparing builds on the same machine and save.
+//
+// Run() times each case against stand-ins wherever the real path would change the game:
+//   config.build     FBConfig::BuildSnapshot on a generated Data tree (INIs only, no .hkx)
+//   maps.resolve     FB::Maps node and morph key resolution
+//   update.tick      a private FBUpdate ticking timelines and tweens bound to form IDs no
+//                    actor uses, so every write stops at the engine lookup
+//   events.contend   producer threads pushing into a private FBEvents while one thread drains
+//   transform.apply  FBTransform on the player's head node, writing back the scale it had
+//   morph.flush      FB::Morph Set + Flush to a counting IBodyMorphSink
+// The report is written as JSON to FullBodiedBench.json next to the plugin log. Info logging is
+// muted while the cases run so it does not dominate the timings. The cases count toward
+// FB::Metrics like any other work.
+//
+// Game thread only; the game is blocked while it runs (a few seconds at scale 1). tests/ builds the
+// same cases for Linux against a stand-in engine layer (fb_bench).
+namespace FB::Bench {
+    // `scale` multiplies every case's size (1..16). Returns the report path, empty on failure.
+    std::filesystem::path Run(std::uint32_t scale);
+}
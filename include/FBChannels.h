@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "FBStructs.h"
+
+// Per-actor channel table.
+//
+// Every scalar engine value we drive (a node scale, a morph/expression) is a channel.
+// Timelines and tweens never write the engine directly; they contribute a layer to the
+// channel (one layer per source), and the table is resolved once per tick into a single
+// final value per channel. Only that value is written by FBUpdate.
+//
+// The table is pure data (no RE types) and does not know the engine base value of a
+// channel. A resolved channel is an affine function of the base: value = a * base + b.
+// Override makes a = 0, Additive adds to b, Multiply scales both.
+
+enum class ChannelKind : std::uint8_t
+{
+    Scale,
+    Morph
+};
+
+enum class ChannelOp : std::uint8_t
+{
+    Set,      // write a * base + b
+    Restore,  // last layer removed with restore: write base (scale) / clear (morph), then forget
+    Forget    // last layer removed without restore: leave the engine as-is (after `flush`), forget base
+};
+
+struct ChannelWrite
+{
+    std::uint32_t formID = 0;
+    ChannelKind kind = ChannelKind::Scale;
+    ChannelOp op = ChannelOp::Set;
+    std::string name;
+    float a = 1.0f;
+    float b = 0.0f;
+    bool flush = false;  // Forget only: a/b hold a final value that was never written
+    bool force = false;  // Set only: re-sent by sustain even though the value did not change
+
+    [[nodiscard]] float Apply(float base) const noexcept { return a * base + b; }
+};
+
+class FBChannelTable {
+public:
+    // Set (or replace) the layer owned by `source` on a channel. Creates the channel if needed.
+    void SetLayer(std::uint32_t formID, ChannelKind kind, std::string_view name, std::uint64_t source,
+                  const LayerSpec& spec, float value);
+
+    // Value of the layer owned by `source`, if that source has one on this channel.
+    std::optional<float> GetLayerValue(std::uint32_t formID, ChannelKind kind, std::string_view name,
+                                       std::uint64_t source) const;
+
+    // Resolved value for a known base (nullopt if the channel has no layers).
+    std::optional<float> GetResolvedValue(std::uint32_t formID, ChannelKind kind, std::string_view name,
+                                          float base) const;
+
+    bool HasChannel(std::uint32_t formID, ChannelKind kind, std::string_view name) const;
+
+    // Drop every layer owned by `source`. With restore=false, channels left without layers are
+    // forgotten without being written (the engine keeps whatever was last applied).
+    void RemoveSource(std::uint64_t source, bool restore);
+
+    // Drop the single layer owned by `source` on one channel (same release rules as RemoveSource).
+    void RemoveLayer(std::uint32_t formID, ChannelKind kind, std::string_view name, std::uint64_t source,
+                     bool restore);
+
+    // Force a re-send of every channel of `kind` that `source` contributes to (sustain).
+    void MarkSourceDirty(std::uint64_t source, ChannelKind kind);
+
+    // Force a re-send of one channel (its last write did not reach the engine). False if gone.
+    bool MarkChannelDirty(std::uint32_t formID, ChannelKind kind, std::string_view name);
+
+    // Resolve all dirty channels; appends one write per changed channel.
+    void Resolve(std::vector<ChannelWrite>& out);
+
+    void Clear();
+
+    std::size_t ChannelCount() const;
+
+    static float Identity(BlendMode mode) noexcept { return mode == BlendMode::Multiply ? 1.0f : 0.0f; }
+
+private:
+    struct Layer {
+        std::uint64_t source = 0;
+        LayerSpec spec{};
+        float value = 0.0f;
+    };
+
+    struct Channel {
+        ChannelKind kind = ChannelKind::Scale;
+        std::string name;
+        std::vector<Layer> layers;  // sorted by priority (stable)
+        bool dirty = false;
+        bool force = false;
+        bool pendingRelease = false;
+        bool restoreOnRelease = true;
+        bool flushOnRelease = false;
+        float flushA = 1.0f;
+        float flushB = 0.0f;
+        bool hasLast = false;
+        float lastA = 1.0f;
+        float lastB = 0.0f;
+    };
+
+    using ActorChannels = std::unordered_map<std::string, Channel>;
+
+    static std::string MakeKey(ChannelKind kind, std::string_view name);
+    static void Fold(const Channel& ch, float& a, float& b);
+
+    const Channel* Find(std::uint32_t formID, ChannelKind kind, std::string_view name) const;
+    static bool EraseSource(Channel& ch, std::uint64_t source, bool restore);
+
+    std::unordered_map<std::uint32_t, ActorChannels> _actors;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FBChannels.h"
+#include "FBConfig.h"
+#include "FBStructs.h"
+
+// Output of one evaluation pass of FBUpdate.
+//
+// Built off the game thread from timelines/tweens, then handed over whole: the game thread
+// only reads it and performs the engine calls it lists. FBUpdate keeps two and swaps them,
+// so the next pass fills one while the other is applied; the vectors keep their capacity.
+
+// A fired command that is not channel-driven (Move, ...) and must run through FB::Exec.
+struct FBExecEntry
+{
+    const FBCommand* command = nullptr;  // points into FBCommandBuffer::snapshot
+    FBEvent event;
+    RE::ActorHandle actor;  // bound by the timeline for command->role
+    std::uint64_t source = 0;  // firing timeline id
+};
+
+// A timeline the pass closed: gameplay state always unwinds, visual effects only on a reset.
+struct FBTimelineEnd
+{
+    std::uint64_t source = 0;
+    bool reset = false;
+};
+
+struct FBCommandBuffer
+{
+    std::shared_ptr<const Snapshot> snapshot;  // keeps every FBExecEntry::command alive
+    std::vector<FBExecEntry> execs;            // in firing order
+    std::vector<ChannelWrite> writes;          // one per changed channel
+    std::vector<FBTimelineEnd> ended;          // timelines the pass closed
+
+    [[nodiscard]] bool Empty() const noexcept { return execs.empty() && writes.empty() && ended.empty(); }
+
+    void Clear() {
+        snapshot.reset();
+        execs.clear();
+        writes.clear();
+        ended.clear();
+    }
+};
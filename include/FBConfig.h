@@ -1,33 +1,94 @@
-#pragma once
-
-#include <memory>
-#include <string>
-#include <unordered_map>
-#include <vector>
-
-#include "FBStructs.h"
-#include "FBActors.h"
-
-struct Snapshot {
-    Generation generation = 0;
-    bool ResetOnPairEnd = false;
-    float ResetDelay = 0.0f;
-    float DefaultTweenScale = 0.0f;
-    float DefaultTweenMorph = 0.0f;
-    std::unordered_map<std::string, std::string> eventMap;
-    std::unordered_map<std::string, TimedCommandList> scripts;
-};
-
-
-
-class FBConfig {
-public:
-    bool LoadInitial();
-    bool Reload();
-
-    Generation GetGeneration() const {
-        auto snap = GetSnapshot();
-        return snap ? snap->generation : 0;
-    }
-    std::shared_ptr<const Snapshot> GetSnapshot() const;
-};
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FBStructs.h"
+#include "FBActors.h"
+
+// One [EventMap] entry, resolved once per snapshot.
+struct EventBinding {
+    std::string scriptKey;                  // empty = tag not mapped
+    const TimedCommandList* script = nullptr;  // into Snapshot::scripts; null if the script is missing
+};
+
+struct Snapshot {
+    Generation generation = 0;
+    bool ResetOnPairEnd = false;
+    float ResetDelay = 0.0f;
+    float DefaultTweenScale = 0.0f;
+    float DefaultTweenMorph = 0.0f;
+    float EventCoalesceWindow = 0.05f;  // seconds; repeats of the same (tag, actor) inside it are dropped
+    float MorphEpsilon = 0.001f;        // morph/expression writes changing a value by no more than this are skipped
+
+    // Morph tweens emit a new value once it has moved by MorphTweenStep, or MorphTweenMaxInterval
+    // seconds after the last one (0 = no limit), and always at the end. Step 0 samples every frame,
+    // as scale tweens always do.
+    float MorphTweenStep = 0.02f;
+    float MorphTweenMaxInterval = 0.1f;
+    std::uint32_t PapyrusCallsPerFrame = 8;  // Papyrus calls sent per frame; the rest wait (FBDispatch.h)
+    bool NativeExpressions = true;           // write face animation data directly instead of Actor.SetExpression*
+    bool HkxAnnotations = true;              // also read FB annotations from the clips' .hkx files (FBHkx.h)
+    float StatsLogInterval = 300.0f;         // seconds between runtime stats in the log (0 = off)
+    std::uint32_t FxVoicesPerActor = 4;      // FBFx_Play sounds playing at once per actor; the oldest is stolen
+    std::unordered_map<std::string, std::string> eventMap;
+    // [DevourmentEventMap]: normalized Devourment trigger key (e.g. SwallowSuccess_Stomach) -> script.
+    std::unordered_map<std::string, std::string> devourmentEventMap;
+    std::unordered_map<std::string, TimedCommandList> scripts;
+
+    // eventMap indexed by interned tag id (FBTags.h), so Tick maps an event without hashing strings.
+    std::vector<EventBinding> eventsByTag;
+
+    [[nodiscard]] const EventBinding* FindEvent(TagId tag) const noexcept {
+        if (tag >= eventsByTag.size() || eventsByTag[tag].scriptKey.empty()) {
+            return nullptr;
+        }
+        return &eventsByTag[tag];
+    }
+
+    // devourmentEventMap indexed by interned trigger key (FBTrigger::key).
+    std::vector<EventBinding> devourmentByKey;
+
+    [[nodiscard]] const EventBinding* FindDevourmentTrigger(TagId key) const noexcept {
+        if (key >= devourmentByKey.size() || devourmentByKey[key].scriptKey.empty()) {
+            return nullptr;
+        }
+        return &devourmentByKey[key];
+    }
+};
+
+
+
+class FBConfig {
+public:
+    // The game's Data folder (relative to the working directory).
+    static inline const std::filesystem::path kDataRoot{"Data"};
+
+    FBConfig() = default;
+    // Serves `fixed` instead of the published snapshot; LoadInitial/Reload do not change it
+    // (FBBench drives its own FBUpdate with a generated config).
+    explicit FBConfig(std::shared_ptr<const Snapshot> fixed) : _fixed(std::move(fixed)) {}
+
+    bool LoadInitial();
+    bool Reload();
+
+    // Parses the INIs under `dataRoot` into `out` without publishing it. `out.generation` must
+    // already be set.
+    static bool BuildSnapshot(const std::filesystem::path& dataRoot, Snapshot& out);
+
+    // Fx keys resolve to forms only once the game has loaded its data (kDataLoaded); snapshots
+    // built before that leave every Fx command's form null.
+    static void SetFormsLoaded();
+
+    Generation GetGeneration() const {
+        auto snap = GetSnapshot();
+        return snap ? snap->generation : 0;
+    }
+    std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+private:
+    std::shared_ptr<const Snapshot> _fixed;
+};
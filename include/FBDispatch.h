@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+#include <RE/Skyrim.h>
+
+// Scheduler in front of every Papyrus call the plugin makes.
+//
+// Calls are queued per (actor, key), where the key names what the call writes ("#P3" for a
+// phoneme, "BodyMorphs" for the actor's body-morph batch). A newer call replaces the queued one
+// (body-morph batches are merged instead, latest value per morph). At most one call per key is
+// in flight: completion is tracked through the VM's result functor, and the next value waits
+// for it. Pump() sends at most the per-frame budget, visible actors nearest the player first,
+// so a burst of scenes cannot flood the VM queue that quests and other mods share.
+namespace FB::Dispatch {
+    // One call as handed to the VM: a static call on `className`, or a method call on the
+    // actor's "Actor" script object.
+    struct VmCall {
+        RE::Actor* actor = nullptr;
+        bool isMethod = false;
+        const char* className = nullptr;
+        const char* functionName = nullptr;
+        RE::BSScript::IFunctionArguments* args = nullptr;
+    };
+
+    // Where Pump() sends calls: the game's VM by default, a stand-in VM otherwise. `callback` must
+    // be invoked once the call has run; returning false means nothing was dispatched.
+    class IVirtualMachineBackend {
+    public:
+        virtual ~IVirtualMachineBackend() = default;
+        virtual bool Dispatch(const VmCall& call,
+                              RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>& callback) = 0;
+    };
+
+    // nullptr restores the game's VM.
+    void SetBackend(IVirtualMachineBackend* backend);
+
+    // Actor method call, e.g. Actor.SetExpressionPhoneme. `makeArgs` runs when the call is sent.
+    void EnqueueActorMethod(RE::Actor* actor, std::string key, const char* functionName,
+                            std::function<RE::BSScript::IFunctionArguments*()> makeArgs);
+
+    // FBMorphBridge.FBApplyMorphs for one actor, merged with any batch still queued for it.
+    void EnqueueBodyMorphs(RE::Actor* actor, std::span<const RE::BSFixedString> setNames,
+                           std::span<const float> setValues, std::span<const RE::BSFixedString> clearNames);
+
+    // Game thread, once per frame: retire completed calls, then send up to the budget.
+    void Pump();
+    bool HasPending();
+    void SetBudget(std::uint32_t callsPerFrame);
+
+    // Counters since load.
+    struct Stats {
+        std::uint64_t sent = 0;
+        std::uint64_t completed = 0;
+        std::uint64_t replaced = 0;   // queued calls overwritten by a newer value
+        std::uint64_t deferred = 0;   // frames a ready call waited for budget
+        std::uint64_t timedOut = 0;   // in-flight calls never reported back
+        std::uint64_t rejected = 0;   // the VM refused the call
+        std::size_t pending = 0;
+        std::size_t inFlight = 0;
+    };
+    Stats GetStats();
+}
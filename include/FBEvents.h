@@ -1,41 +1,111 @@
-#include "FBStructs.h"
-
-#include <mutex>
-#include <vector>
-#include <atomic>
-
-namespace RE {
-    struct BSAnimationGraphEvent;
-}
-
-class FBEvents
-{
-public:
-    void Push(const FBEvent& event);
-
-    std::vector<FBEvent> Drain();
-
-    void Clear();
-
-    std::size_t Size() const;
-
-        // Event manager lifecycle hooks (called from FBPlugin message listener)
-    void OnDataLoaded();
-    void OnPostLoadOrNewGame();
-
-    void HandleAnimEvent(const RE::BSAnimationGraphEvent& evn);
-
-private:
-    mutable std::mutex _mutex;
-
-    std::vector<FBEvent> _queue;
-
-        // Anim event plumbing (defined in FBEvents.cpp)
-    void TryRegisterToPlayer();
-    
-
-    std::atomic_bool _registered{false};
-    std::atomic_bool _sawAnyEvent{false};
-    std::atomic_bool _logAllAnimTags{false};
-};
-
+#include "FBStructs.h"
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace RE {
+    class Actor;
+    struct BSAnimationGraphEvent;
+}
+
+struct Snapshot;
+
+class FBEvents
+{
+public:
+    // Bounded multi-producer / single-consumer ring (power of two).
+    static constexpr std::size_t kCapacity = 1024;
+
+    FBEvents();
+
+    // Called after every Push (any thread). Must be cheap; used to wake a parked update pump.
+    using WakeFn = std::function<void()>;
+    void SetWakeHandler(WakeFn wake);
+
+    // Any thread; lock-free. Returns false (and counts a drop) when the ring is full.
+    bool Push(const FBEvent& event);
+
+    // Single consumer. Clears `out` and moves every queued event into it, so the caller's
+    // capacity is reused from tick to tick. Returns 0 if another drain is already running.
+    std::size_t Drain(std::vector<FBEvent>& out);
+
+    void Clear();
+
+    // Approximate while producers are active.
+    std::size_t Size() const;
+
+    std::uint64_t DroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+        // Event manager lifecycle hooks (called from FBPlugin message listener)
+    void OnDataLoaded();
+    void OnPostLoadOrNewGame();
+
+    void HandleAnimEvent(const RE::BSAnimationGraphEvent& evn);
+
+    // Sink registry: every actor with loaded 3D gets the animation sink on its graphs.
+    // Load/unload notifications are coalesced per actor and applied by ProcessRegistrations()
+    // (game thread, at most kMaxRegistrationsPerTick per call).
+    void OnObjectLoaded(std::uint32_t formID, bool loaded);
+    std::size_t ProcessRegistrations();
+    bool HasPendingRegistrations() const { return _pendingRegistrationCount.load(std::memory_order_relaxed) > 0; }
+    std::size_t RegisteredActorCount() const { return _registeredActors.size(); }
+
+    // Rebuild the animation-tag filter from a snapshot's [EventMap] keys and publish it; the
+    // sink starts using it on its next event. Needs the game's string pool (DataLoaded or later).
+    void RebuildTagFilter(const Snapshot& snap);
+
+private:
+    struct TagFilter;  // FBEvents.cpp
+
+    static constexpr std::size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "FBEvents::kCapacity must be a power of two");
+
+    // Vyukov-style cell: `sequence` == position when free for that enqueue, position + 1 when
+    // filled for that dequeue.
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        FBEvent event{};
+    };
+
+    std::array<Cell, kCapacity> _cells;
+    alignas(64) std::atomic<std::size_t> _enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> _dequeuePos{0};
+    alignas(64) std::atomic<std::uint64_t> _dropped{0};
+    std::atomic_flag _draining = ATOMIC_FLAG_INIT;
+
+    WakeFn _wake;
+    std::atomic<std::shared_ptr<const TagFilter>> _tagFilter;
+
+        // Anim event plumbing (defined in FBEvents.cpp)
+    static constexpr std::size_t kMaxRegistrationsPerTick = 16;
+
+    // Graphs our sink is on, so repeated registration passes never add it twice.
+    struct RegisteredActor {
+        std::uint32_t formID = 0;
+        std::vector<const void*> graphs;
+    };
+
+    void RegisterLoadedActors();
+    RegisteredActor& FindOrAddRegistration(std::uint32_t formID);
+    void EraseRegistration(std::uint32_t formID);
+    bool AttachToActor(RE::Actor* actor, RegisteredActor& entry);
+    void DetachFromActor(RE::Actor* actor);
+
+    std::mutex _registrationMutex;
+    std::unordered_map<std::uint32_t, bool> _pendingRegistrations;  // formID -> wants sink attached
+    std::atomic<std::size_t> _pendingRegistrationCount{0};
+    std::vector<std::pair<std::uint32_t, bool>> _registrationBatch;  // reused; game thread
+    std::vector<RegisteredActor> _registeredActors;                   // sorted by formID; game thread
+    std::uint64_t _duplicateRegistrationsSkipped = 0;
+
+    std::atomic_bool _registered{false};
+    std::atomic_bool _sawAnyEvent{false};
+    std::atomic_bool _logAllAnimTags{false};
+};
@@ -1,7 +1,12 @@
-#pragma once
-#include "FBStructs.h"
-
-namespace FB::Exec {
-    void Execute(const FBCommand& cmd, const FBEvent& ctxEvent);
-    void Execute_MainThread(const FBCommand& cmd, const FBEvent& ctxEvent);
-}
+#pragma once
+#include "FBStructs.h"
+
+namespace FB::Exec {
+    void Execute(const FBCommand& cmd, const FBEvent& ctxEvent);
+    void Execute_MainThread(const FBCommand& cmd, const FBEvent& ctxEvent);
+
+    // Same, for an actor the caller already bound for cmd.role (nullptr = unresolved; logged and skipped).
+    // `source` is the timeline firing the command; visual effects are detached when it resets.
+    void Execute_MainThread(const FBCommand& cmd, const FBEvent& ctxEvent, RE::Actor* actor,
+                            std::uint64_t source = 0);
+}
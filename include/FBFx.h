@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <RE/Skyrim.h>
+
+// Timeline sound and visual effects (FBFx_Play(SoundKey), FBFx_Shader(Key[, duration]),
+// FBFx_ArtObject(Node, Key[, duration])).
+//
+// Effect keys are resolved to their form once, when the config is built (FBCommand::form), so
+// firing a key is a single engine call. Sounds started on an actor come from a per-actor voice
+// pool: once an actor has FxVoicesPerActor sounds still playing, the oldest one is stopped to
+// make room, so a fast loop cannot pile up overlapping sounds.
+//
+// Visual effects are cached per actor by (form, node): firing one that is still attached
+// refreshes its lifetime instead of attaching another instance. Each instance remembers the
+// timeline that last fired it, and DetachSource() drops all of a timeline's effects when it resets.
+namespace FB::Fx {
+    // Where sounds are started: the game's audio manager by default, a stand-in otherwise.
+    // Voice ids are the backend's own; 0 means the sound did not start.
+    class IAudioBackend {
+    public:
+        virtual ~IAudioBackend() = default;
+        virtual const char* Name() const = 0;
+        virtual std::uint64_t Start(RE::Actor* actor, RE::BGSSoundDescriptorForm* sound) = 0;
+        virtual void Stop(std::uint64_t voice) = 0;
+        virtual bool IsPlaying(std::uint64_t voice) = 0;
+    };
+
+    // nullptr restores the game's audio manager.
+    void SetAudioBackend(IAudioBackend* backend);
+
+    void SetVoicesPerActor(std::uint32_t voices);
+
+    // Game thread. Plays `sound` on `actor`, stealing the actor's oldest voice if the pool is full.
+    bool Play_MainThread(RE::Actor* actor, RE::BGSSoundDescriptorForm* sound);
+
+    // Actor unloaded: stop its voices and detach its effects.
+    void ForgetActor(std::uint32_t formID);
+
+    // Where visual effects are attached: the actor's reference effects by default, a stand-in
+    // otherwise. `effect` is a TESEffectShader or a BGSArtObject; `node` is empty for the actor's
+    // root. Instance ids are the backend's own; 0 means nothing was attached.
+    class IVisualBackend {
+    public:
+        virtual ~IVisualBackend() = default;
+        virtual const char* Name() const = 0;
+        virtual std::uint64_t Attach(RE::Actor* actor, RE::TESForm* effect, std::string_view node, float duration) = 0;
+        // Restart the instance's lifetime; false if it has already finished.
+        virtual bool Refresh(std::uint64_t instance, float duration) = 0;
+        virtual void Detach(std::uint64_t instance) = 0;
+    };
+
+    // nullptr restores the game's reference effects.
+    void SetVisualBackend(IVisualBackend* backend);
+
+    // Game thread. Attaches `effect` to `actor` (at `node`), or refreshes the instance already
+    // there, on behalf of timeline `source`. duration < 0 lasts until detached.
+    bool Show_MainThread(RE::Actor* actor, RE::TESForm* effect, std::string_view node, float duration,
+                         std::uint64_t source);
+
+    // Game thread. Detaches every effect timeline `source` attached or refreshed last.
+    void DetachSource(std::uint64_t source);
+
+    // Counters since load.
+    struct AudioStats {
+        std::uint64_t starts = 0;
+        std::uint64_t stops = 0;   // voices stopped early (stolen, or their actor unloaded)
+        std::uint64_t steals = 0;  // plays that had to stop a voice first
+        std::uint64_t failed = 0;  // the backend could not start the sound
+        std::size_t voices = 0;    // voices currently tracked
+    };
+    AudioStats GetAudioStats();
+
+    struct VisualStats {
+        std::uint64_t attaches = 0;
+        std::uint64_t refreshes = 0;  // fires served by an instance already attached
+        std::uint64_t detaches = 0;
+        std::uint64_t failed = 0;
+        std::size_t attached = 0;  // instances currently cached
+    };
+    VisualStats GetVisualStats();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+// Annotation tracks read straight from Havok animation files, so a clip can carry its own
+// timeline ("FBScale_Head(1.2)" at 0.5s) instead of, or next to, a per-anim INI.
+//
+// Only binary packfiles (what Skyrim ships: hk_2010, 32- or 64-bit, little-endian) are parsed;
+// the file is memory-mapped and walked through its section fixups without copying it. Binary
+// tagfiles are recognised and skipped with a warning.
+//
+// Results are kept in a cache file between boots, keyed by path and validated by size and mtime;
+// when those changed but the content hash did not (a mod manager re-deploying the file), the
+// entry is reused without parsing. Only annotations that start with "FB" or "2_FB" are kept.
+// FBConfig turns them into TimedCommands with the per-anim INI grammar.
+namespace FB::Hkx {
+    struct Annotation {
+        float time = 0.0f;  // seconds from clip start
+        std::string text;
+    };
+
+    // Parses a packfile image; false if it is not one (or is malformed). Appends to `out`.
+    bool ParseAnnotations(std::span<const std::byte> image, std::vector<Annotation>& out);
+
+    // Cached read of one file. False if the file cannot be read or parsed.
+    bool GetAnnotations(const std::filesystem::path& file, std::vector<Annotation>& out);
+
+    // Where the cache lives (default Data/SKSE/Plugins/FullBodiedAnnotations.cache); loaded on
+    // first use. SaveCache() writes it back if anything changed, keeping only the files read
+    // since it was loaded.
+    void SetCachePath(std::filesystem::path path);
+    void SaveCache();
+
+    // Counters since load.
+    struct Stats {
+        std::uint64_t hits = 0;      // size and mtime matched
+        std::uint64_t hashHits = 0;  // size or mtime changed, content did not
+        std::uint64_t parsed = 0;
+        std::uint64_t failed = 0;       // unreadable or not a packfile
+        std::uint64_t annotations = 0;  // FB annotations returned
+    };
+    Stats GetStats();
+}
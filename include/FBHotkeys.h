@@ -1,7 +1,7 @@
-#pragma once
-#include <functional>
-
-namespace FBHotkeys {
-    using ReloadFn = std::function<void()>;
-    void Install(ReloadFn reload);
-}
+#pragma once
+#include <functional>
+
+namespace FBHotkeys {
+    using ReloadFn = std::function<void()>;
+    void Install(ReloadFn reload);
+}
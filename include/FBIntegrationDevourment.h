@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+class FBTriggers;
+
+// Devourment adapter: turns Devourment's swallow mod events into neutral FBTriggers.
+//
+// Devourment sends Devourment_onSwallow(pred, prey, endo, locus) as a ModEvent with custom
+// arguments, which only Papyrus can receive; papyrus/FB_DevourmentBridge.psc registers for it
+// and forwards the payload to FullBodied.OnDevourmentSwallow, which calls OnSwallow(). The
+// adapter only validates and normalizes: which script runs is looked up by the trigger's key in
+// [DevourmentEventMap] when FBUpdate drains the queue. It never touches the engine, so a fake
+// event source can drive OnSwallow() directly.
+namespace FB::Devourment {
+    // Devourment_onSwallow as forwarded by the bridge; form IDs are 0 for a missing actor.
+    struct SwallowPayload {
+        std::uint32_t predator = 0;
+        std::uint32_t prey = 0;
+        bool endo = false;
+        std::int32_t locus = 0;
+    };
+
+    // Interns the normalized keys and sets the queue triggers are pushed to.
+    void Initialize(FBTriggers& triggers);
+
+    // First pass: a non-endo swallow into the stomach (locus 0) -> SwallowSuccess_Stomach.
+    bool IsSupportedFirstPassCase(const SwallowPayload& payload);
+
+    // Any thread. Validates and normalizes the payload and pushes the trigger; false if it was
+    // ignored or the queue was full. Devourment_onSwallowAttempt and Devourment_onEscape would
+    // get their own entry points here (FBTriggerKind::VoreSwallowAttempt / VoreEscape).
+    bool OnSwallow(const SwallowPayload& payload);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Process-wide runtime counters, readable at any time without stopping the update loop.
+//
+// Each counter is a relaxed atomic on its own cache line, so counting from the game thread and
+// the evaluation pool costs one uncontended add and nothing is synchronised until someone reads.
+// Hot loops should add their totals once per pass rather than once per item. Tick durations and
+// snapshot build times go into power-of-two microsecond histograms. Format() is safe on any thread;
+// per-module statistics (FB::Dispatch, FB::Fx, ...) are game-thread state and are logged by
+// FBUpdate::LogStats() instead.
+namespace FB::Metrics {
+    enum class Counter : std::uint8_t
+    {
+        EventsDrained,
+        TriggersDrained,
+        CommandsFired,      // FBExec commands applied from the command buffer
+        TweensEvaluated,    // tween evaluations in evaluation passes
+        NodeLookups,        // NiAVObject::GetObjectByName calls
+        TasksQueued,        // SKSE task interface submissions
+        PapyrusSent,        // Papyrus calls handed to the VM (FBDispatch)
+        PapyrusSuppressed,  // writes that never became a call: unchanged values, or replaced while queued
+        kCount
+    };
+
+    namespace detail {
+        struct alignas(64) Slot {
+            std::atomic<std::uint64_t> value{0};
+        };
+        inline std::array<Slot, static_cast<std::size_t>(Counter::kCount)> g_counters;
+    }
+
+    // Any thread.
+    inline void Add(Counter counter, std::uint64_t n = 1) noexcept {
+        detail::g_counters[static_cast<std::size_t>(counter)].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Get(Counter counter) noexcept;
+    const char* Name(Counter counter) noexcept;
+
+    void RecordTick(std::chrono::steady_clock::duration duration) noexcept;
+    void RecordSnapshotBuild(std::chrono::steady_clock::duration duration) noexcept;
+
+    // Multi-line report of every counter and histogram (no "[FB]" prefix; the caller logs it).
+    std::string Format();
+}
@@ -1,24 +1,95 @@
-#pragma once
-#include <string_view>
-
-namespace RE {
-    class Actor;
- }
-
-namespace FB::Morph {
-
-    //Papyrus bridge class and functions
-    inline constexpr const char* kBridgeClass = "FBMorphBridge";
-    inline constexpr const char* kFnSetMorph = "FBSetMorph";
-    inline constexpr const char* kFnClear = "FBClearMorph";
-
-
-    //Main-thread calls into Papyrus VM
-    void Set_MainThread(RE::Actor* actor, std::string_view morphName, float value);
-    void Set(RE::Actor* actor, std::string_view morphName, float value);
-
-    // Clear a specific morph (by name/key)
-    void Clear_MainThread(RE::Actor* actor, std::string_view morphName);
-    void Clear(RE::Actor* actor, std::string_view morphName);
-
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include <RE/Skyrim.h>
+
+namespace FB::Morph {
+
+    //Papyrus bridge class and functions
+    inline constexpr const char* kBridgeClass = "FBMorphBridge";
+    inline constexpr const char* kFnApplyMorphs = "FBApplyMorphs";
+
+    // Body-morph key our values are stored under (FBMorphBridge.FBKey()).
+    inline constexpr const char* kMorphKey = "FullBodiedAnimations";
+
+
+    // force: send even if the shadow says the engine already has this value (sustain re-sends).
+    void Set(RE::Actor* actor, std::string_view morphName, float value, bool force = false);
+
+    // Clear a specific morph (by name/key)
+    void Clear_MainThread(RE::Actor* actor, std::string_view morphName);
+    void Clear(RE::Actor* actor, std::string_view morphName);
+
+    // Body morphs and expressions from Set/Clear are batched per actor (last value per morph or
+    // expression slot wins) and sent by Flush_MainThread() as one submission per sink, so each
+    // actor's body is rebuilt and its face data locked once per frame. Game thread only.
+    void Flush_MainThread();
+
+    // Shadow of the values we applied, per actor and morph / expression slot. Set skips writes that
+    // change a slot by no more than the epsilon, Clear skips slots already neutral.
+    void SetEpsilon(float epsilon);
+    std::optional<float> GetApplied(std::uint32_t formID, std::string_view morphName);
+    // Actor unloaded: the engine dropped its expression state (body morphs persist in SKEE).
+    void ForgetExpressions(std::uint32_t formID);
+    // A queued write never reached the engine (actor gone, VM refused the call): forget its slot
+    // so the next Set/Clear sends again. `slotKey` is the resolved morph name, or the dispatch key
+    // of an expression slot ("#P3", "#M1", "#Mood").
+    void ForgetApplied(std::uint32_t formID, std::string_view slotKey);
+    std::uint64_t SentCount();
+    std::uint64_t SuppressedCount();
+
+    // Receives one actor's batch per flush: apply the clears and sets, then rebuild the body once.
+    // setNames and setValues are parallel.
+    class IBodyMorphSink {
+    public:
+        virtual ~IBodyMorphSink() = default;
+        virtual const char* Name() const = 0;
+        virtual void Submit(RE::Actor* actor, std::span<const RE::BSFixedString> setNames,
+                            std::span<const float> setValues, std::span<const RE::BSFixedString> clearNames) = 0;
+    };
+
+    // One phoneme / modifier / mood write. Phoneme and modifier values are 0..1; a mood write sets
+    // the expression override `index` at `value` 0..1 (Papyrus strength / 100).
+    struct ExpressionWrite {
+        enum class Kind : std::uint8_t
+        {
+            Phoneme,
+            Modifier,
+            Mood
+        };
+
+        Kind kind = Kind::Phoneme;
+        std::int32_t index = 0;
+        float value = 0.0f;
+    };
+
+    // Receives one actor's expression writes per flush, in the order they were made.
+    class IExpressionSink {
+    public:
+        virtual ~IExpressionSink() = default;
+        virtual const char* Name() const = 0;
+        virtual void Submit(RE::Actor* actor, std::span<const ExpressionWrite> writes) = 0;
+    };
+
+    // Expressions go to the actor's face animation data directly (the default), or through the
+    // Actor.SetExpression* Papyrus natives. The native sink falls back to Papyrus for an actor
+    // whose face data is not loaded.
+    void SetNativeExpressions(bool enabled);
+
+    // Route expression writes to `sink` instead; nullptr restores the configured backend.
+    void SetExpressionSink(IExpressionSink* sink);
+    const char* ExpressionBackendName();
+
+    // Picks the backend: RaceMenu's native body-morph interface when SKEE answers the interface
+    // exchange, the FBMorphBridge Papyrus script otherwise. Call at kPostPostLoad.
+    void InitBackend();
+
+    // Route batches to `sink` instead (a stand-in that never touches the engine, for timing the
+    // batching itself); nullptr restores the backend chosen by InitBackend().
+    void SetSink(IBodyMorphSink* sink);
+    const char* BackendName();
+
  }
\ No newline at end of file
@@ -1,11 +1,11 @@
-#pragma once
-
-namespace RE {
-    class Actor;
-}
-
-class FBUpdate;
-
-namespace FB {
-    FBUpdate* GetUpdate();
-}
+#pragma once
+
+namespace RE {
+    class Actor;
+}
+
+class FBUpdate;
+
+namespace FB {
+    FBUpdate* GetUpdate();
+}
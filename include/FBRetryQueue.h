@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBChannels.h"
+#include "FBStructs.h"
+
+struct Snapshot;
+
+// Work that found its actor without 3D (still loading, just streamed out) and is tried again later.
+struct FBRetryItem {
+    enum class Kind : std::uint8_t
+    {
+        Event,    // start/reset the event's timeline
+        Channel,  // re-send a channel write (resolved again from the channel table)
+        Exec      // run a non-channel command
+    };
+
+    Kind kind = Kind::Event;
+    std::uint32_t formID = 0;  // actor whose 3D is waited for
+    FBEvent event{};           // Event / Exec context; event.retries counts attempts
+
+    // Channel
+    ChannelKind channelKind = ChannelKind::Scale;
+    std::string channelName;
+
+    // Exec (the snapshot keeps the command alive across a reload)
+    const FBCommand* command = nullptr;
+    std::shared_ptr<const Snapshot> snapshot;
+    std::uint64_t source = 0;  // firing timeline id
+};
+
+// Retry queue on the update clock, backed by a hashed timing wheel.
+//
+// Items are due after kSlotSeconds * 2^attempt (exponential backoff) and dropped after
+// kMaxAttempts. Scheduling and expiry are O(1) per item; the owner advances the wheel from its
+// tick and reports NextDueSeconds() to the pump, so an idle queue is never polled.
+// Game thread only.
+class FBRetryQueue {
+public:
+    static constexpr std::size_t kSlotCount = 64;
+    static constexpr float kSlotSeconds = 0.05f;
+    static constexpr std::uint8_t kMaxAttempts = 6;  // last backoff 1.6s, ~3.2s in total
+
+    // Queue `item` for its next attempt. Returns false (and counts a give-up) once the item has
+    // used all of its attempts.
+    bool Schedule(FBRetryItem item, float nowSeconds);
+
+    // Move every item due by `nowSeconds` into `out` (cleared first).
+    void Collect(float nowSeconds, std::vector<FBRetryItem>& out);
+
+    // Update time of the earliest pending slot, +inf when empty.
+    double NextDueSeconds() const;
+
+    void NoteSuccess() { ++_successes; }
+    void Clear();
+
+    std::size_t Size() const { return _size; }
+    std::uint64_t RetryCount() const { return _retries; }
+    std::uint64_t SuccessCount() const { return _successes; }
+    std::uint64_t GiveUpCount() const { return _giveUps; }
+
+private:
+    std::array<std::vector<FBRetryItem>, kSlotCount> _slots;
+    std::uint64_t _cursor = 0;  // last slot tick collected (absolute: seconds / kSlotSeconds)
+    bool _started = false;
+    std::size_t _size = 0;
+
+    std::uint64_t _retries = 0;
+    std::uint64_t _successes = 0;
+    std::uint64_t _giveUps = 0;
+
+    static std::uint64_t TickOf(float seconds);
+};
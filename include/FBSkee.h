@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RE {
+    class NiAVObject;
+    class TESObjectREFR;
+}
+
+// RaceMenu (SKEE) plugin interfaces, as published in SKEE's IPluginInterface.h.
+// Only the declaration order matters (these are called through SKEE's vtables); nothing past
+// the last function we use is declared.
+namespace SKEE {
+    class IPluginInterface {
+    public:
+        IPluginInterface() = default;
+        virtual ~IPluginInterface() = default;
+        virtual std::uint32_t GetVersion() = 0;
+        virtual void Revert() = 0;
+    };
+
+    class IInterfaceMap {
+    public:
+        virtual IPluginInterface* QueryInterface(const char* name) = 0;
+        virtual bool AddInterface(const char* name, IPluginInterface* pluginInterface) = 0;
+        virtual IPluginInterface* RemoveInterface(const char* name) = 0;
+    };
+
+    // Dispatched to "SKEE" through the SKSE messaging interface; SKEE fills in interfaceMap.
+    struct InterfaceExchangeMessage {
+        enum : std::uint32_t
+        {
+            kExchangeInterface = 0x9E3779B9
+        };
+
+        IInterfaceMap* interfaceMap = nullptr;
+    };
+
+    class IBodyMorphInterface : public IPluginInterface {
+    public:
+        class MorphKeyVisitor;
+        class MorphValueVisitor;
+        class MorphVisitor;
+
+        virtual void SetMorph(RE::TESObjectREFR* actor, const char* morphName, const char* morphKey,
+                              float relative) = 0;
+        virtual float GetMorph(RE::TESObjectREFR* actor, const char* morphName, const char* morphKey) = 0;
+        virtual void ClearMorph(RE::TESObjectREFR* actor, const char* morphName, const char* morphKey) = 0;
+        virtual float GetBodyMorphs(RE::TESObjectREFR* actor, const char* morphName) = 0;
+        virtual void ClearBodyMorphNames(RE::TESObjectREFR* actor, const char* morphName) = 0;
+        virtual void VisitMorphs(RE::TESObjectREFR* actor, MorphVisitor& visitor) = 0;
+        virtual void VisitKeys(RE::TESObjectREFR* actor, const char* name, MorphKeyVisitor& visitor) = 0;
+        virtual void VisitMorphValues(RE::TESObjectREFR* actor, MorphValueVisitor& visitor) = 0;
+        virtual void ClearMorphs(RE::TESObjectREFR* actor) = 0;
+        virtual void ApplyVertexDiff(RE::TESObjectREFR* refr, RE::NiAVObject* rootNode, bool erase = false) = 0;
+        virtual void ApplyBodyMorphs(RE::TESObjectREFR* refr, bool deferUpdate = true) = 0;
+        virtual void UpdateModelWeight(RE::TESObjectREFR* refr, bool immediate = false) = 0;
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <RE/Skyrim.h>
+
+// Gameplay state changed by timelines (FBState_Restrain(1|0), FBState_AI(1|0),
+// FBState_AV(Name, value)), reverted automatically when the timeline ends.
+//
+// The first change a timeline makes to a state records the value it replaced in that
+// timeline's undo journal. Journals live in one arena of fixed-size entries, chained per
+// timeline newest first, so Unwind() restores a timeline's states in reverse order in a single
+// walk. A per-actor bitset remembers which states are currently in effect, so a keyframe that
+// re-fires an unchanged state makes no engine call. The first timeline to change a state owns
+// its revert. Game thread only.
+namespace FB::State {
+    void SetRestrained(RE::Actor* actor, bool restrained, std::uint64_t source);
+    void SetAIEnabled(RE::Actor* actor, bool enabled, std::uint64_t source);
+    // Sets the actor value's base value; `name` as in Papyrus (e.g. "SpeedMult").
+    void SetActorValue(RE::Actor* actor, std::string_view name, float value, std::uint64_t source);
+
+    // Timeline `source` ended: restore everything it changed, newest first.
+    void Unwind(std::uint64_t source);
+
+    // Counters since load.
+    struct Stats {
+        std::uint64_t applied = 0;
+        std::uint64_t skipped = 0;   // already in the requested state
+        std::uint64_t reverted = 0;  // journal entries unwound
+        std::size_t journalEntries = 0;
+    };
+    Stats GetStats();
+}
@@ -1,128 +1,193 @@
-#pragma once
-
-#include <array>
-#include <cstdint>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <unordered_set>
-
-using Generation = std::uint64_t;
-
-
-enum class Easing : std::uint8_t 
-{
-    Linear
-};
-
-enum class ActorRole : std::uint8_t 
-{
-    Self, 
-    Caster, 
-    Target 
-};
-
-enum class FBCommandType : std::uint8_t 
-{
-    Transform,
-    Morph,
-    Fx,
-    State
-};
-
-struct TweenSpec 
-{
-    bool hasTween = false;  // true only if tween= was explicitly present
-    float duration = 0.0f; //seconds
-    float delay = 0.0f; //seconds
-    Easing easing = Easing::Linear;
-};
-
-struct ActorKey 
-{
-    std::uint32_t formID = 0;
-
-    [[nodiscard]] bool IsValid() const noexcept { return formID != 0; }
-
-    friend bool operator==(const ActorKey& a, const ActorKey& b) noexcept {
-        return a.formID == b.formID;
-    }
-};
-
-struct FBEvent 
-{
-    std::string tag{};
-    ActorKey actor{};
-    std::uint8_t retries = 0;
-
-    [[nodiscard]] bool IsValid() const noexcept 
-    { return !tag.empty() && actor.IsValid();
-    }
-};
-
-struct FBCommand 
-{
-    FBCommandType type = FBCommandType::Transform;
-
-    ActorRole role = ActorRole::Self;
-    Generation generation = 0;
-
-    TweenSpec tween{};
-
-    std::string opcode;
-    std::string target;
-    std::string args;
-
-    [[nodiscard]] bool IsValid() const noexcept 
-    {
-        return generation != 0 && !opcode.empty();
-    }
-};
-
-
-
-struct ActiveTimeline
-{
-    FBEvent event;
-    std::string scriptKey;
-    float elapsed = 0.0f;
-    std::size_t nextIndex = 0;
-    std::uint64_t generation = 0;
-    std::unordered_map<std::string, float> originalScale;
-    std::unordered_map<std::string, std::array<float, 3>> originalTranslate;
-    bool commandsComplete = false;
-    float startTimeSeconds = 0.0f;
-    bool resetScheduled = false;
-    double resetAtSeconds = 0.0;
-    bool touchedMorphCaster = false;
-    bool touchedMorphTarget = false;
-    std::unordered_set<std::string> touchedMorphsCaster;
-    std::unordered_set<std::string> touchedMorphsTarget;
-    std::unordered_map<std::string, float> sustainMorphsCaster;
-    std::unordered_map<std::string, float> sustainMorphsTarget;
-
-    // Sustained Move is now an OFFSET (added on top of animated base pose).
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateCaster;
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateTarget;
-
-    // Per-frame base pose cache captured in phase 0 (so later phases don't double-add).
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateBaseCaster;
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateBaseTarget;
-    // optional throttle so we don't spam Papyrus every frame
-    float nextSustainAtSeconds = 0.0f;
-
-    // Additive sustain support: last value we applied (to detect double-apply and derive base).
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateLastAppliedCaster;
-    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateLastAppliedTarget;
-
-
-};
-
-using FBCommandList = std::vector<FBCommand>;
-
-struct TimedCommand {
-    float time = 0.0f;  // seconds since timeline start
-    FBCommand command{};
-};
-
-using TimedCommandList = std::vector<TimedCommand>;
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <RE/Skyrim.h>
+
+using Generation = std::uint64_t;
+using TagId = std::uint16_t;  // interned animation tag, see FBTags.h
+
+
+enum class Easing : std::uint8_t 
+{
+    Linear
+};
+
+enum class ActorRole : std::uint8_t 
+{
+    Self, 
+    Caster, 
+    Target 
+};
+
+enum class FBCommandType : std::uint8_t 
+{
+    Transform,
+    Morph,
+    Fx,
+    State
+};
+
+// How a layer combines with the layers below it on the same channel.
+enum class BlendMode : std::uint8_t
+{
+    Override,
+    Additive,
+    Multiply
+};
+
+struct TweenSpec 
+{
+    bool hasTween = false;  // true only if tween= was explicitly present
+    float duration = 0.0f; //seconds
+    float delay = 0.0f; //seconds
+    Easing easing = Easing::Linear;
+};
+
+struct LayerSpec
+{
+    BlendMode mode = BlendMode::Override;
+    std::int32_t priority = 0;  // higher priority is applied later (on top)
+};
+
+struct ActorKey 
+{
+    std::uint32_t formID = 0;
+
+    [[nodiscard]] bool IsValid() const noexcept { return formID != 0; }
+
+    friend bool operator==(const ActorKey& a, const ActorKey& b) noexcept {
+        return a.formID == b.formID;
+    }
+};
+
+// Fixed-size and trivially copyable so it can live in FBEvents' lock-free ring.
+struct FBEvent 
+{
+    TagId tag = 0;
+    ActorKey actor{};
+    std::uint8_t retries = 0;
+    std::int64_t timestamp = 0;  // steady_clock ticks at HandleAnimEvent (0 = unknown)
+
+    [[nodiscard]] bool IsValid() const noexcept 
+    { return tag != 0 && actor.IsValid();
+    }
+};
+
+// External triggers (FBTriggers.h): gameplay events from other mods, normalized by an
+// integration adapter before they reach the update loop.
+enum class FBTriggerSource : std::uint8_t
+{
+    AnimationGraph,
+    Devourment,
+    External
+};
+
+enum class FBTriggerKind : std::uint8_t
+{
+    AnimationTag,
+    VoreSwallowAttempt,
+    VoreSwallowSuccess,
+    VoreEscape,
+    Custom
+};
+
+// Fixed-size and trivially copyable so it can live in FBTriggers' lock-free ring. `key` is the
+// normalized config key (e.g. SwallowSuccess_Stomach), interned like an animation tag.
+struct FBTrigger
+{
+    FBTriggerSource source = FBTriggerSource::External;
+    FBTriggerKind kind = FBTriggerKind::Custom;
+    TagId key = 0;
+    ActorKey actorA{};  // caster: the predator for vore triggers
+    ActorKey actorB{};  // target: the prey for vore triggers
+    bool success = false;
+    bool endo = false;
+    std::int32_t locus = 0;
+    std::uint8_t retries = 0;
+    std::int64_t timestamp = 0;  // steady_clock ticks when the adapter pushed it (0 = unknown)
+
+    [[nodiscard]] bool IsValid() const noexcept { return key != 0 && actorA.IsValid(); }
+};
+
+struct FBCommand 
+{
+    FBCommandType type = FBCommandType::Transform;
+
+    ActorRole role = ActorRole::Self;
+    Generation generation = 0;
+
+    TweenSpec tween{};
+    LayerSpec layer{};
+
+    std::string opcode;
+    std::string target;
+    std::string args;
+
+    // Fx: the record `target` names, resolved when the config is built (null = unresolved).
+    RE::TESForm* form = nullptr;
+
+    [[nodiscard]] bool IsValid() const noexcept 
+    {
+        return generation != 0 && !opcode.empty();
+    }
+};
+
+
+
+struct ActiveTimeline
+{
+    std::uint64_t id = 0;  // channel layer source id (unique per timeline start)
+    FBEvent event;
+
+    // Actors bound on the game thread when the timeline starts (0 = not resolved), so the
+    // off-thread evaluation never has to look them up.
+    std::uint32_t casterFormID = 0;
+    std::uint32_t targetFormID = 0;
+    // Handles to the same actors, re-validated every tick and only re-resolved once stale.
+    RE::ActorHandle casterHandle;
+    RE::ActorHandle targetHandle;
+    // The target was named by the trigger that started the timeline (FBTrigger::actorB); a stale
+    // handle is re-resolved from targetFormID instead of by nearest actor.
+    bool targetPinned = false;
+    bool closed = false;  // retired by the evaluation pass; erased when the pass is merged
+    std::string scriptKey;
+    float elapsed = 0.0f;
+    std::size_t nextIndex = 0;
+    std::uint64_t generation = 0;
+    std::unordered_map<std::string, std::array<float, 3>> originalTranslate;
+    bool commandsComplete = false;
+    float startTimeSeconds = 0.0f;
+    bool resetScheduled = false;
+    double resetAtSeconds = 0.0;
+
+    // Sustained Move is now an OFFSET (added on top of animated base pose).
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateCaster;
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateTarget;
+
+    // Per-frame base pose cache captured in phase 0 (so later phases don't double-add).
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateBaseCaster;
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateBaseTarget;
+    // optional throttle so we don't spam Papyrus every frame
+    float nextSustainAtSeconds = 0.0f;
+
+    // Additive sustain support: last value we applied (to detect double-apply and derive base).
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateLastAppliedCaster;
+    std::unordered_map<std::string, std::array<float, 3>> sustainTranslateLastAppliedTarget;
+
+
+};
+
+using FBCommandList = std::vector<FBCommand>;
+
+struct TimedCommand {
+    float time = 0.0f;  // seconds since timeline start
+    FBCommand command{};
+};
+
+using TimedCommandList = std::vector<TimedCommand>;
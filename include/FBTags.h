@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string_view>
+
+#include "FBStructs.h"
+
+// Process-wide intern table for animation tags.
+//
+// Events carry a TagId instead of a string so they stay fixed-size and trivially copyable.
+// Ids are stable for the process lifetime and never reused; kNone means "no tag". Names are
+// matched case-insensitively, like the game's BSFixedString pool; Name() returns the first spelling.
+// Interning takes a lock (config load, first sight of a tag); Name() is lock-free so any
+// thread can log an id.
+namespace FB::Tags {
+    inline constexpr TagId kNone = 0;
+    inline constexpr TagId kFBEvent = 1;
+    inline constexpr TagId kPairEnd = 2;
+
+    // kNone if the name is empty or the table is full.
+    TagId Intern(std::string_view name);
+
+    // kNone if the name was never interned.
+    TagId Find(std::string_view name);
+
+    // Empty for kNone / unknown ids.
+    std::string_view Name(TagId id);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "FBStructs.h"
+
+// Queue of external triggers (FBTrigger) pushed by integration adapters such as
+// FBIntegrationDevourment, drained by FBUpdate::Tick right after FBEvents.
+//
+// Same bounded multi-producer / single-consumer ring as FBEvents: adapters push from whatever
+// thread their mod event arrives on (usually a Papyrus VM thread) without taking a lock.
+class FBTriggers
+{
+public:
+    static constexpr std::size_t kCapacity = 256;
+
+    FBTriggers();
+
+    // Called after every Push (any thread). Must be cheap; used to wake a parked update pump.
+    using WakeFn = std::function<void()>;
+    void SetWakeHandler(WakeFn wake);
+
+    // Any thread; lock-free. Returns false (and counts a drop) when the ring is full.
+    bool Push(const FBTrigger& trigger);
+
+    // Single consumer. Clears `out` and moves every queued trigger into it.
+    std::size_t Drain(std::vector<FBTrigger>& out);
+
+    // Approximate while producers are active.
+    std::size_t Size() const;
+
+    std::uint64_t DroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "FBTriggers::kCapacity must be a power of two");
+
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        FBTrigger trigger{};
+    };
+
+    std::array<Cell, kCapacity> _cells;
+    alignas(64) std::atomic<std::size_t> _enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> _dequeuePos{0};
+    alignas(64) std::atomic<std::uint64_t> _dropped{0};
+    std::atomic_flag _draining = ATOMIC_FLAG_INIT;
+
+    WakeFn _wake;
+};
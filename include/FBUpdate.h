@@ -1,68 +1,252 @@
-#pragma once
-#include <unordered_map>
-#include <array>
-#include <atomic>
-#include <memory>
-#include "FBStructs.h"
-
-class FBConfig;
-class FBEvents;
-
-class FBUpdate {
-public:
-    FBUpdate(FBConfig& config, FBEvents& events);
-    void Tick(float dtSeconds);
-    void ApplyPostAnimSustainForActor(RE::Actor* actor, std::uint8_t phase);
-
-
-    std::vector<ActiveTimeline> _activeTimelines;
-    Generation _lastSeenGeneration = 0;
-    std::uint64_t _postAnimEpoch = 0;
-
-    // Tracks last epoch+phase applied for an actor:
-    // key = formID, value = (epoch<<1) | phaseBit (0 or 1)
-    std::unordered_map<std::uint32_t, std::uint64_t> _postAnimLastEpochPhaseByActor;
-
-    // Called from NiAVObject::UpdateWorldData hook.
-    // If this object is in our move registry, apply offset additively to local.translate.
-    void ApplyWorldDataSustainForObject(RE::NiAVObject* obj);
-
-    // Called from post-anim sustain phase 0 to (re)register any moved nodes for this actor.
-    void RefreshMoveRegistryForActor(RE::Actor* actor, std::uint8_t phase);
-
-    struct ActiveTween {
-        FBEvent event{};
-        ActorRole role{ActorRole::Self};
-
-        std::string channelKey;
-        std::string target;
-
-        float startTimeSeconds{0.0f};
-        float durationSeconds{0.0f};
-        float startValue{0.0f};
-        float endValue{0.0f};
-
-        Easing easing{Easing::Linear};
-        Generation generation{0};
-        FBCommandType type{FBCommandType::Transform};
-        bool startCaptured = false;
-    };
-
-    std::unordered_map<std::string, ActiveTween> _activeTweens;
-    std::unordered_map<std::string, float> _lastMorphValue;
-
-private:
-    FBConfig& _config;
-    FBEvents& _events;
-    float _timeSeconds{0.0f};
-
-    // Registry: exact NiAVObject* -> sustained offset.
-    // This is what the UpdateWorldData hook consults.
-    std::unordered_map<RE::NiAVObject*, std::array<float, 3>> _moveRegistry;
-
-    // Optional: throttled proof-of-life counter
-    std::uint32_t _moveRegistryStompCounter = 0;
-};
-
-
-
+#pragma once
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string_view>
+#include "FBChannels.h"
+#include "FBCommandBuffer.h"
+#include "FBRetryQueue.h"
+#include "FBStructs.h"
+#include "FBWorkerPool.h"
+
+class FBConfig;
+class FBEvents;
+class FBTriggers;
+struct Snapshot;
+
+class FBUpdate {
+public:
+    FBUpdate(FBConfig& config, FBEvents& events, FBTriggers& triggers);
+    ~FBUpdate();
+
+    // Game thread. Each call:
+    //   1) applies the command buffer produced by the previous evaluation pass,
+    //   2) drains events and external triggers and starts/closes timelines (binding their actors),
+    //   3) launches the next evaluation pass on the worker pool and returns.
+    // The pass evaluates timelines and tweens for the next frame (now + dtSeconds), so its
+    // buffer lands on time when it is applied by the next Tick.
+    void Tick(float dtSeconds);
+
+    // Earliest update time (same clock as NowSeconds) at which Tick() has work to do:
+    // NowSeconds() while events, tweens, due commands or an evaluation pass are pending, the
+    // next keyframe or scheduled reset otherwise, +inf when fully idle. Used by FBUpdatePump to park.
+    double NextWorkAtSeconds() const;
+    float NowSeconds() const { return _timeSeconds; }
+
+    // Events dropped as repeats of the same (tag, actor) inside Snapshot::EventCoalesceWindow.
+    std::uint64_t CoalescedEventCount() const { return _coalescedEvents; }
+
+    // Morph tween samples written to their channel vs. held back by adaptive sampling.
+    std::uint64_t MorphTweenSamplesSent() const { return _morphSamplesSent.load(std::memory_order_relaxed); }
+    std::uint64_t MorphTweenSamplesHeld() const { return _morphSamplesHeld.load(std::memory_order_relaxed); }
+
+    // Events, channel writes and commands waiting for their actor's 3D (retries / successes / give-ups).
+    const FBRetryQueue& Retries() const { return _retryQueue; }
+
+    // Game thread. Starts (or resets) `scriptKey` for e.actor without resolving any engine actor:
+    // its Caster commands address e.actor.formID directly and Target commands are dropped, so
+    // nothing reaches the engine unless that form is a loaded actor. FBBench uses it to drive the
+    // scheduler with stand-in actors.
+    void StartTimelineUnbound(const FBEvent& e, const std::string& scriptKey);
+
+    // Game thread. Logs FB::Metrics and every module's counters; Tick also calls it every
+    // Snapshot::StatsLogInterval seconds.
+    void LogStats(std::string_view reason);
+
+    // Active timelines and tweens as of the last Tick, once its previous pass was merged. Safe on
+    // the game thread while a pass is in flight (the containers themselves are not).
+    std::size_t ActiveTimelineCount() const { return _timelineCount; }
+    std::size_t ActiveTweenCount() const { return _tweenCount; }
+    void ApplyPostAnimSustainForActor(RE::Actor* actor, std::uint8_t phase);
+
+
+    std::vector<ActiveTimeline> _activeTimelines;
+    Generation _lastSeenGeneration = 0;
+    std::uint64_t _postAnimEpoch = 0;
+
+    // Tracks last epoch+phase applied for an actor:
+    // key = formID, value = (epoch<<1) | phaseBit (0 or 1)
+    std::unordered_map<std::uint32_t, std::uint64_t> _postAnimLastEpochPhaseByActor;
+
+    // Called from NiAVObject::UpdateWorldData hook.
+    // If this object is in our move registry, apply offset additively to local.translate.
+    void ApplyWorldDataSustainForObject(RE::NiAVObject* obj);
+
+    // Called from post-anim sustain phase 0 to (re)register any moved nodes for this actor.
+    void RefreshMoveRegistryForActor(RE::Actor* actor, std::uint8_t phase);
+
+    struct ActiveTween {
+        FBEvent event{};
+        ActorRole role{ActorRole::Self};
+        std::uint64_t source{0};  // owning timeline id (channel layer source)
+        LayerSpec layer{};
+
+        std::string channelKey;
+        std::string target;
+
+        float startTimeSeconds{0.0f};
+        float durationSeconds{0.0f};
+        float startValue{0.0f};
+        float endValue{0.0f};
+
+        Easing easing{Easing::Linear};
+        Generation generation{0};
+        FBCommandType type{FBCommandType::Transform};
+        std::uint32_t formID{0};    // actor bound from the owning timeline's role
+        bool startCaptured = false;
+        bool needsCapture = false;  // start depends on an engine value; captured by the next Tick
+        bool finished = false;      // erased when the evaluation pass is merged
+
+        // Adaptive sampling (morph tweens): when a value was last written to the channel.
+        bool hasEmitted = false;
+        float lastEmittedAtSeconds{0.0f};
+    };
+
+    std::unordered_map<std::string, ActiveTween> _activeTweens;
+
+private:
+    static constexpr std::size_t kShardCount = 8;
+    using ChannelShards = std::array<FBChannelTable, kShardCount>;
+
+    // Layer change produced by an evaluation shard; applied to the owning channel shard.
+    struct LayerOp {
+        std::uint32_t formID = 0;
+        ChannelKind kind = ChannelKind::Scale;
+        bool remove = false;  // RemoveLayer(restore=false) instead of SetLayer
+        std::string name;
+        std::uint64_t source = 0;
+        LayerSpec layer{};
+        float value = 0.0f;
+    };
+
+    struct SourceRelease {
+        std::uint64_t source = 0;
+        bool restore = false;
+    };
+
+    // A Scale / Morph.Set command with a numeric value, resolved to its channel.
+    struct ChannelCommand {
+        ChannelKind kind = ChannelKind::Scale;
+        std::string channelName;
+        float value = 0.0f;
+        float tweenDuration = 0.0f;  // after defaults; 0 = instant
+    };
+
+    // Seek bookkeeping for one (role, channel) while several commands are due at once.
+    struct SeekEntry {
+        ActorRole role = ActorRole::Self;
+        ChannelKind kind = ChannelKind::Scale;
+        std::string channelName;
+        std::size_t lastIndex = 0;  // the command that decides the channel
+        float lastValue = 0.0f;
+        bool lastIsTween = false;
+        bool hasInstant = false;  // an instant command right before it (seeds a tween start)
+        float instantValue = 0.0f;
+    };
+
+    // Per-pass scratch for the timelines and tweens of one group of event actors.
+    // Everything a shard writes lives here or in the timelines/tweens it owns.
+    struct EvalShard {
+        std::vector<std::size_t> timelines;  // indices into _activeTimelines
+        std::vector<ActiveTween*> tweens;
+        std::vector<std::pair<std::string, ActiveTween>> newTweens;
+        std::vector<LayerOp> ops;
+        std::vector<FBExecEntry> execs;
+        std::vector<SourceRelease> releases;
+        std::vector<SeekEntry> seek;
+        double nextDueAtSeconds = 0.0;
+        std::size_t awaitingCapture = 0;
+        std::uint64_t samplesSent = 0;
+        std::uint64_t samplesHeld = 0;
+
+        void Clear();
+    };
+
+    FBConfig& _config;
+    FBEvents& _events;
+    FBTriggers& _triggers;
+    std::vector<FBEvent> _drainedEvents;      // reused each tick
+    std::vector<FBTrigger> _drainedTriggers;  // reused each tick
+
+    // Last accepted time per (tag << 32 | formID), for event coalescing.
+    std::unordered_map<std::uint64_t, float> _lastEventAtSeconds;
+    std::uint64_t _coalescedEvents = 0;
+    std::size_t _timelineCount = 0;  // recorded by Tick between passes
+    std::size_t _tweenCount = 0;
+    float _timeSeconds{0.0f};
+    float _lastStatsLogAtSeconds{0.0f};
+
+    // Work deferred until its actor has 3D. Channel retries are keyed ("S|0x%08X|node") so a
+    // channel written every pass waits in the queue once.
+    FBRetryQueue _retryQueue;
+    std::vector<FBRetryItem> _dueRetries;  // reused each tick
+    std::unordered_set<std::string> _pendingChannelRetries;
+
+    // Layered per-actor channels, split by actor so each shard resolves independently.
+    // Written only by the evaluation pass, or by Tick while no pass is in flight.
+    ChannelShards _channelShards;
+    std::array<std::vector<ChannelWrite>, kShardCount> _shardWrites;  // reused each pass
+    std::array<EvalShard, kShardCount> _evalShards;
+    std::uint64_t _nextTimelineId = 1;
+
+    // Engine scale captured before our first write to a node channel: key = "0x%08X|node".
+    // Written on the game thread only; read by the evaluation pass.
+    std::unordered_map<std::string, float> _scaleBase;
+
+    // Double-buffered evaluation output: the pass fills _buffers[_evalIndex], Tick applies it
+    // next frame and swaps.
+    FBCommandBuffer _buffers[2];
+    std::size_t _evalIndex = 0;
+    std::future<void> _evalDone;
+    bool _channelsDirty = false;                // Tick released/touched channels outside a pass
+    double _nextDueAtSeconds = 0.0;             // published by the last pass
+    std::size_t _tweensAwaitingCapture = 0;     // published by the last pass
+    std::atomic<std::uint64_t> _morphSamplesSent{0};
+    std::atomic<std::uint64_t> _morphSamplesHeld{0};
+
+    static std::size_t ShardOf(std::uint32_t formID) noexcept;
+    FBChannelTable& ChannelsFor(std::uint32_t formID) { return _channelShards[ShardOf(formID)]; }
+    const FBChannelTable& ChannelsFor(std::uint32_t formID) const { return _channelShards[ShardOf(formID)]; }
+    void ReleaseSource(std::uint64_t source, bool restore);
+
+    // Game thread.
+    void FinishEvaluation();
+    void CommitBuffer(const FBCommandBuffer& buffer);
+    void BindTimelineActors(ActiveTimeline& tl, RE::Actor* caster, RE::Actor* pinnedTarget = nullptr);
+    void StartOrResetTimeline(const FBEvent& e, const std::string& scriptKey, std::size_t commandCount,
+                              float eventTime, RE::Actor* caster, RE::Actor* pinnedTarget, Generation generation);
+    void StartTimelinesFromTriggers(const Snapshot& snap, std::chrono::steady_clock::time_point wallNow);
+    void RevalidateTimelineActors();
+    void CaptureAwaitingTweens();
+    void ProcessRetries();
+    void ScheduleChannelRetry(std::uint32_t formID, ChannelKind kind, const std::string& name);
+    float CaptureScaleBase(RE::Actor* actor, std::string_view nodeName);
+
+    // Evaluation pass (worker pool; no engine access).
+    void Evaluate(std::shared_ptr<const Snapshot> snap, float evalTime);
+    void EvaluateShard(EvalShard& shard, const Snapshot& snap, float evalTime);
+    void EvaluateTimeline(EvalShard& shard, ActiveTimeline& tl, const Snapshot& snap, float evalTime);
+    void FireChannelCommand(EvalShard& shard, const ActiveTimeline& tl, const FBCommand& cmd, const ChannelCommand& cc,
+                            float keyTimeSeconds, const float* seededStart);
+    void EvaluateTween(EvalShard& shard, ActiveTween& tw, const Snapshot& snap, float evalTime);
+    static bool ParseChannelCommand(const FBCommand& cmd, const Snapshot& snap, ChannelCommand& out);
+    void ResolveChannelShard(std::size_t index);
+    bool TryGetTweenStart(const ActiveTween& tw, const float* scaleBase, float& out) const;
+
+    // Registry: exact NiAVObject* -> sustained offset.
+    // This is what the UpdateWorldData hook consults.
+    std::unordered_map<RE::NiAVObject*, std::array<float, 3>> _moveRegistry;
+
+    // Optional: throttled proof-of-life counter
+    std::uint32_t _moveRegistryStompCounter = 0;
+
+    // Declared last: destroyed (and joined) first, while everything a pass touches still exists.
+    FBWorkerPool _pool;
+};
+
+
+
@@ -1,16 +1,74 @@
-#pragma once
-#include "FBUpdate.h"
-
-class FBUpdate;
-
-class FBUpdatePump {
-public:
-    explicit FBUpdatePump(FBUpdate& update);
-
-    void Start();
-    void Stop();
-
-private:
-    FBUpdate& _update;
-    std::atomic<bool> _running{false};
-};
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "FBUpdate.h"
+
+class FBUpdate;
+
+// Drives FBUpdate::Tick on the game thread.
+//
+// Primary driver is OnFrame(), called from the PlayerCharacter::UpdateAnimation hook right after
+// the vanilla animation update, so our writes land on the pose of the frame being built.
+// Until the first frame arrives (main menu, hook not installed) a worker thread keeps ticking
+// through the SKSE task queue, with at most one tick pending at any time.
+//
+// After every tick the pump asks FBUpdate when it next has work. With nothing to do it parks:
+// frames return after one atomic check and the worker sleeps on its condition variable. Wake()
+// (event push, config reload) or the next keyframe / reset deadline un-parks it.
+class FBUpdatePump {
+public:
+    explicit FBUpdatePump(FBUpdate& update);
+    ~FBUpdatePump();
+
+    void Start();
+    void Stop();
+
+    // Any thread. Cheap: one atomic store (plus a notify while the fallback worker is driving).
+    void Wake();
+
+    // Game thread only.
+    void OnFrame();
+
+    // Game thread only. One tick now, parked or not (FullBodiedQuestScript.TickOnce).
+    void TickNow();
+
+    std::uint64_t TicksRun() const { return _ticksRun.load(std::memory_order_relaxed); }
+    // Times the fallback worker returned from its wait, for measuring idle overhead.
+    std::uint64_t WorkerWakeups() const { return _workerWakeups.load(std::memory_order_relaxed); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::int64_t kNotParked = 0;
+    static constexpr std::int64_t kParkedForever = INT64_MAX;
+
+    bool ShouldTick(clock::time_point now);  // consumes a pending Wake()
+    void RunTick(clock::time_point now);     // game thread only
+    void WorkerLoop();
+
+    FBUpdate& _update;
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _tickPending{false};
+    std::atomic<bool> _frameDriven{false};
+    std::atomic<bool> _wakeRequested{true};
+
+    // steady_clock ticks until which the pump stays parked (kNotParked / kParkedForever).
+    std::atomic<std::int64_t> _parkUntil{kNotParked};
+    std::atomic<std::uint64_t> _ticksRun{0};
+    std::atomic<std::uint64_t> _workerWakeups{0};
+
+    // Game thread only: dt is measured where the tick actually runs.
+    clock::time_point _lastTick{};
+    bool _hasLastTick = false;
+    bool _parked = false;
+    float _parkedSeconds = 0.0f;  // planned length of the current park; 0 when parked forever
+
+    std::thread _worker;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+};
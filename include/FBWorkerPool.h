@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size thread pool for engine-free work (timeline evaluation).
+// Nothing submitted here may touch RE:: objects; results go back to the game thread as data.
+class FBWorkerPool {
+public:
+    explicit FBWorkerPool(std::size_t threadCount);
+    ~FBWorkerPool();
+
+    FBWorkerPool(const FBWorkerPool&) = delete;
+    FBWorkerPool& operator=(const FBWorkerPool&) = delete;
+
+    // Run `task` on a pool thread.
+    std::future<void> Submit(std::function<void()> task);
+
+    // Blocking: runs fn(i) for every i in [0, count). The calling thread takes part, so this is
+    // safe to call from inside a pool task even when every other worker is busy.
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+    std::size_t ThreadCount() const { return _threads.size(); }
+
+    // Default sizing: leave the game most of the machine.
+    static std::size_t DefaultThreadCount();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _queue;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stopping = false;
+};
@@ -1,69 +1,105 @@
-#include "FBActors.h"
-#include "FBTransform.h"
-
-
-namespace {
-
-    static RE::Actor* ResolveNearestOtherActor(RE::Actor* caster, float maxDist) {
-        if (!caster) {
-            return nullptr;
-        }
-
-        const auto casterPos = caster->GetPosition();
-        RE::Actor* best = nullptr;
-        float bestDist2 = maxDist * maxDist;
-
-        auto* lists = RE::ProcessLists::GetSingleton();
-        if (!lists) {
-            return nullptr;
-        }
-
-        // highActorHandles is the usual way to iterate loaded actors
-        for (auto& h : lists->highActorHandles) {
-            auto aPtr = h.get();        // NiPointer<Actor>
-            RE::Actor* a = aPtr.get();  // raw Actor*
-            if (!a || a == caster) {
-                continue;
-            }
-            if (!a->Is3DLoaded()) {
-                continue;
-            }
-
-            const auto p = a->GetPosition();
-            const float dx = p.x - casterPos.x;
-            const float dy = p.y - casterPos.y;
-            const float dz = p.z - casterPos.z;
-            const float d2 = dx * dx + dy * dy + dz * dz;
-
-            if (d2 < bestDist2) {
-                bestDist2 = d2;
-                best = a;
-            }
-        }
-
-        return best;
-    }
-}
-
-namespace FB::Actors {
-    RE::Actor* ResolveActorForEvent(const FBEvent& e, ActorRole role) {
-        if (!e.actor.IsValid()) {
-            return nullptr;
-        }
-
-        auto* caster = RE::TESForm::LookupByID(e.actor.formID)->As<RE::Actor>();
-        if (!caster) {
-            return nullptr;
-        }
-
-        if (role == ActorRole::Caster) {
-            return caster;
-        }
-
-        constexpr float kMaxTargetDist = 250.0f;
-        return ResolveNearestOtherActor(caster, kMaxTargetDist);
-    }
-
-}
-
-
+#include "FBActors.h"
+#include "FBTransform.h"
+
+
+namespace {
+
+    constexpr float kMaxTargetDist = 250.0f;
+
+    // Loaded high-process actors and their positions, resolved from the handle list at most once
+    // per update frame, on the first partner query of that frame. A frame has a handful of
+    // queries against at most a few hundred actors, so a flat scan of this array beats any
+    // spatial index (which costs more to keep current than it saves). Game thread only.
+    struct LoadedActor {
+        RE::Actor* actor = nullptr;
+        RE::NiPoint3 position;
+    };
+
+    std::vector<LoadedActor> g_loadedActors;
+    std::uint64_t g_frame = 1;
+    std::uint64_t g_loadedFrame = 0;
+
+    void RefreshLoadedActors() {
+        g_loadedFrame = g_frame;
+        g_loadedActors.clear();
+
+        auto* lists = RE::ProcessLists::GetSingleton();
+        if (!lists) {
+            return;
+        }
+
+        // highActorHandles is the usual way to iterate loaded actors
+        for (auto& h : lists->highActorHandles) {
+            auto aPtr = h.get();        // NiPointer<Actor>
+            RE::Actor* a = aPtr.get();  // raw Actor*
+            if (!a || !a->Is3DLoaded()) {
+                continue;
+            }
+
+            g_loadedActors.push_back({a, a->GetPosition()});
+        }
+    }
+
+    static RE::Actor* ResolveNearestOtherActor(RE::Actor* caster, float maxDist) {
+        if (!caster) {
+            return nullptr;
+        }
+
+        if (g_loadedFrame != g_frame) {
+            RefreshLoadedActors();
+        }
+
+        const auto casterPos = caster->GetPosition();
+        RE::Actor* best = nullptr;
+        float bestDist2 = maxDist * maxDist;
+
+        for (const auto& loaded : g_loadedActors) {
+            if (loaded.actor == caster) {
+                continue;
+            }
+
+            const float dx = loaded.position.x - casterPos.x;
+            const float dy = loaded.position.y - casterPos.y;
+            const float dz = loaded.position.z - casterPos.z;
+            const float d2 = dx * dx + dy * dy + dz * dz;
+
+            if (d2 < bestDist2) {
+                bestDist2 = d2;
+                best = loaded.actor;
+            }
+        }
+
+        return best;
+    }
+}
+
+namespace FB::Actors {
+    RE::Actor* ResolveActorForEvent(const FBEvent& e, ActorRole role) {
+        if (!e.actor.IsValid()) {
+            return nullptr;
+        }
+
+        auto* form = RE::TESForm::LookupByID(e.actor.formID);
+        auto* caster = form ? form->As<RE::Actor>() : nullptr;
+        if (!caster) {
+            return nullptr;
+        }
+
+        if (role == ActorRole::Caster) {
+            return caster;
+        }
+
+        return ResolveNearestOtherActor(caster, kMaxTargetDist);
+    }
+
+    void BeginFrame() { ++g_frame; }
+
+    RE::Actor* ResolveHandle(const RE::ActorHandle& handle) {
+        // A handle lookup is an index into the engine's handle table; no form map or actor scan.
+        auto ptr = handle.get();
+        return ptr.get();
+    }
+
+}
+
+
@@ -0,0 +1,523 @@
+#include "FBBench.h"
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+
+#include "FBConfig.h"
+#include "FBEvents.h"
+#include "FBMaps.h"
+#include "FBMetrics.h"
+#include "FBMorph.h"
+#include "FBTags.h"
+#include "FBTransform.h"
+#include "FBTriggers.h"
+#include "FBUpdate.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kFrameSeconds = 1.0f / 60.0f;
+    constexpr std::string_view kTickAlias = "FBBenchTick";
+    constexpr std::array<std::string_view, 4> kNodeKeys{"Head", "Spine1", "LHand", "RHand"};
+    constexpr std::array<std::string_view, 4> kMorphKeys{"FBBench0", "FBBench1", "FBBench2", "FBBench3"};
+
+    // One case of the report. Cases with iterations keep one sample per iteration.
+    struct Result {
+        std::string name;
+        std::uint64_t ops = 0;
+        double totalMs = 0.0;
+        std::vector<double> samplesUs;
+        std::vector<std::pair<std::string_view, double>> values;  // case-specific fields
+        std::string skipped;                                      // why the case did not run
+    };
+
+    double MillisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double Percentile(std::span<const double> sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const auto rank = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+        return sorted[rank];
+    }
+
+    //
+    // Generated Data tree
+    //
+
+    std::string AnimAlias(std::uint32_t index) { return fmt::format("FBBench{}", index); }
+
+    bool WriteFile(const std::filesystem::path& path, std::string_view text) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return out.good();
+    }
+
+    bool WriteAnimIni(const std::filesystem::path& oarRoot, std::string_view alias, std::string_view body) {
+        const auto folder = oarRoot / "FBBench" / fmt::format("_variants_{}", alias);
+        return WriteFile(folder / fmt::format("FB_{}.ini", alias), body);
+    }
+
+    // `anims` clips of `commands` Caster and as many Target commands each, mixing instant and
+    // tweened scales and morphs, plus the FBBenchTick clip: one scale or morph tween per channel
+    // per second for `tickSeconds`, so every channel always has a tween running.
+    bool WriteTree(const std::filesystem::path& dataRoot, std::uint32_t anims, std::uint32_t commands,
+                   std::uint32_t tickSeconds) {
+        const auto oarRoot =
+            dataRoot / "meshes" / "actors" / "character" / "animations" / "OpenAnimationReplacer";
+
+        // HkxAnnotations off: a build without the clips' annotations would evict the real
+        // entries from the annotation cache.
+        fmt::memory_buffer general;
+        fmt::format_to(std::back_inserter(general), "[General]\nHkxAnnotations=false\n\n[FBFiles]\n");
+        for (std::uint32_t a = 0; a < anims; ++a) {
+            fmt::format_to(std::back_inserter(general), "{0}={0}.hkx\n", AnimAlias(a));
+        }
+        fmt::format_to(std::back_inserter(general), "{0}={0}.hkx\n\n[EventMap]\n", kTickAlias);
+        for (std::uint32_t a = 0; a < anims; ++a) {
+            fmt::format_to(std::back_inserter(general), "{0}={0}.hkx\n", AnimAlias(a));
+        }
+        if (!WriteFile(dataRoot / "FullBodiedIni.ini", fmt::to_string(general))) {
+            return false;
+        }
+
+        for (std::uint32_t a = 0; a < anims; ++a) {
+            const auto alias = AnimAlias(a);
+            fmt::memory_buffer ini;
+            for (const char* role : {"Caster", "Target"}) {
+                fmt::format_to(std::back_inserter(ini), "[FB:{}.hkx|{}]\n", alias, role);
+                for (std::uint32_t i = 0; i < commands; ++i) {
+                    const float time = static_cast<float>(i) * 0.05f;
+                    const auto node = kNodeKeys[i % kNodeKeys.size()];
+                    const auto morph = kMorphKeys[i % kMorphKeys.size()];
+                    const float value = 1.0f + static_cast<float>(i % 5) * 0.1f;
+                    switch (i % 4) {
+                        case 0:
+                            fmt::format_to(std::back_inserter(ini), "{:.2f} FBScale_{}({:.1f}, tween=0.25)\n", time,
+                                           node, value);
+                            break;
+                        case 1:
+                            fmt::format_to(std::back_inserter(ini), "{:.2f} FBScale_{}({:.1f}, tween=0.5, blend=mul)\n",
+                                           time, node, value);
+                            break;
+                        case 2:
+                            fmt::format_to(std::back_inserter(ini), "{:.2f} FBMorph_{}({:.1f}, tween=0.25)\n", time,
+                                           morph, value - 1.0f);
+                            break;
+                        default:
+                            fmt::format_to(std::back_inserter(ini), "{:.2f} FBMorph_{}({:.1f})  ; instant\n", time,
+                                           morph, value - 1.0f);
+                            break;
+                    }
+                }
+            }
+            if (!WriteAnimIni(oarRoot, alias, fmt::to_string(ini))) {
+                return false;
+            }
+        }
+
+        // Scale tweens blend (mul) so they start from identity instead of waiting for an engine read.
+        fmt::memory_buffer tick;
+        fmt::format_to(std::back_inserter(tick), "[FB:{}.hkx|Caster]\n", kTickAlias);
+        const auto channels = static_cast<std::uint32_t>(kNodeKeys.size() + kMorphKeys.size());
+        for (std::uint32_t s = 0; s < tickSeconds; ++s) {
+            for (std::uint32_t c = 0; c < channels; ++c) {
+                const float time = static_cast<float>(s) + static_cast<float>(c) / static_cast<float>(channels);
+                if (c < kNodeKeys.size()) {
+                    fmt::format_to(std::back_inserter(tick), "{:.3f} FBScale_{}({}, tween=1, blend=mul)\n", time,
+                                   kNodeKeys[c], s % 2 ? "1.0" : "1.2");
+                } else {
+                    fmt::format_to(std::back_inserter(tick), "{:.3f} FBMorph_{}({}, tween=1)\n", time,
+                                   kMorphKeys[c - kNodeKeys.size()], s % 2 ? "0.0" : "1.0");
+                }
+            }
+        }
+        return WriteAnimIni(oarRoot, kTickAlias, fmt::to_string(tick));
+    }
+
+    // Form IDs no form uses, from the top of the runtime reference range down.
+    std::vector<std::uint32_t> UnusedFormIDs(std::size_t count) {
+        std::vector<std::uint32_t> ids;
+        for (std::uint32_t id = 0xFFFFFFFE; ids.size() < count && id > 0xFF000000; --id) {
+            if (!RE::TESForm::LookupByID(id)) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    // The bench FBUpdate hands its snapshot's settings to the shared modules (FB::Morph,
+    // FB::Dispatch, FB::Fx) on its first Tick; give it the live ones so the game keeps them.
+    void CopyRuntimeSettings(const Snapshot& from, Snapshot& to) {
+        to.MorphEpsilon = from.MorphEpsilon;
+        to.MorphTweenStep = from.MorphTweenStep;
+        to.MorphTweenMaxInterval = from.MorphTweenMaxInterval;
+        to.PapyrusCallsPerFrame = from.PapyrusCallsPerFrame;
+        to.NativeExpressions = from.NativeExpressions;
+        to.FxVoicesPerActor = from.FxVoicesPerActor;
+    }
+
+    //
+    // Cases
+    //
+
+    Result BenchConfigBuild(const std::filesystem::path& dataRoot, std::uint32_t builds,
+                            std::shared_ptr<Snapshot>& built) {
+        Result r{"config.build"};
+        std::size_t commands = 0;
+
+        for (std::uint32_t b = 0; b < builds; ++b) {
+            auto snap = std::make_shared<Snapshot>();
+            snap->generation = 1;
+
+            const auto start = Clock::now();
+            const bool ok = FBConfig::BuildSnapshot(dataRoot, *snap);
+            r.samplesUs.push_back(MillisecondsSince(start) * 1000.0);
+            if (!ok) {
+                r.skipped = "generated tree did not parse";
+                return r;
+            }
+
+            commands = 0;
+            for (const auto& [key, list] : snap->scripts) {
+                commands += list.size();
+            }
+            built = std::move(snap);
+        }
+
+        r.ops = builds;
+        r.values = {{"scripts", static_cast<double>(built->scripts.size())},
+                    {"commands", static_cast<double>(commands)}};
+        return r;
+    }
+
+    Result BenchMaps(std::uint32_t iterations) {
+        // Friendly keys, a full node name (pass-through) and misses, as INIs mix them.
+        static constexpr std::array<std::string_view, 6> kNodes{"Head",          "Spine1",          "LeftHand",
+                                                                 "RThg",          "NPC Head [Head]", "NotANode"};
+        static constexpr std::array<std::string_view, 4> kMorphs{"PreyBelly", "Swallow1", "Aah", "NotAMorph"};
+
+        Result r{"maps.resolve"};
+        std::size_t checksum = 0;
+
+        const auto start = Clock::now();
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            checksum += FB::Maps::ResolveNode(kNodes[i % kNodes.size()]).size();
+            const auto morph = FB::Maps::ResolveMorph(kMorphs[i % kMorphs.size()]);
+            checksum += morph.size() + FB::Maps::TryGetPhonemeIndex(morph).value_or(0);
+        }
+        r.totalMs = MillisecondsSince(start);
+
+        r.ops = static_cast<std::uint64_t>(iterations) * 2;
+        r.values = {{"checksum", static_cast<double>(checksum)}};
+        return r;
+    }
+
+    Result BenchTick(std::shared_ptr<const Snapshot> snap, std::uint32_t timelines, std::uint32_t frames) {
+        Result r{"update.tick"};
+
+        const auto formIDs = UnusedFormIDs(timelines);
+        if (formIDs.size() < timelines) {
+            r.skipped = "not enough unused form IDs";
+            return r;
+        }
+
+        FBConfig config(std::move(snap));
+        FBEvents events;
+        FBTriggers triggers;
+        auto update = std::make_unique<FBUpdate>(config, events, triggers);
+        update->Tick(kFrameSeconds);  // takes the snapshot's generation
+
+        FBEvent e{};
+        e.tag = FB::Tags::Intern("FBBench");
+        const std::string scriptKey = fmt::format("{}.hkx", kTickAlias);
+        for (const auto formID : formIDs) {
+            e.actor.formID = formID;
+            update->StartTimelineUnbound(e, scriptKey);
+        }
+
+        const auto tweensBefore = FB::Metrics::Get(FB::Metrics::Counter::TweensEvaluated);
+        std::size_t peakTweens = 0;
+        for (std::uint32_t f = 0; f < frames; ++f) {
+            const auto start = Clock::now();
+            update->Tick(kFrameSeconds);
+            r.samplesUs.push_back(MillisecondsSince(start) * 1000.0);
+            peakTweens = std::max(peakTweens, update->ActiveTweenCount());
+        }
+        const auto tweens = FB::Metrics::Get(FB::Metrics::Counter::TweensEvaluated) - tweensBefore;
+        update.reset();  // joins the last pass
+
+        r.ops = frames;
+        r.values = {{"timelines", static_cast<double>(timelines)},
+                    {"peakTweens", static_cast<double>(peakTweens)},
+                    {"tweensPerFrame", static_cast<double>(tweens) / frames}};
+        return r;
+    }
+
+    Result BenchEvents(std::uint32_t producers, std::uint32_t perProducer) {
+        Result r{"events.contend"};
+
+        FBEvents events;
+        std::atomic<std::uint32_t> running{producers};
+        std::atomic<bool> go{false};
+
+        std::vector<std::thread> threads;
+        for (std::uint32_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                FBEvent e{};
+                e.tag = FB::Tags::kPairEnd;
+                for (std::uint32_t i = 0; i < perProducer; ++i) {
+                    e.actor.formID = 0x14 + p;
+                    e.timestamp = i;
+                    events.Push(e);
+                }
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        std::vector<FBEvent> drained;
+        std::uint64_t received = 0;
+        std::uint64_t drains = 0;
+
+        const auto start = Clock::now();
+        go.store(true, std::memory_order_release);
+        while (running.load(std::memory_order_acquire) > 0) {
+            if (events.Drain(drained) > 0) {
+                received += drained.size();
+                ++drains;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        received += events.Drain(drained);
+        r.totalMs = MillisecondsSince(start);
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        r.ops = static_cast<std::uint64_t>(producers) * perProducer;
+        r.values = {{"producers", static_cast<double>(producers)},
+                    {"received", static_cast<double>(received)},
+                    {"dropped", static_cast<double>(events.DroppedCount())},
+                    {"drains", static_cast<double>(drains)}};
+        return r;
+    }
+
+    Result BenchTransform(std::uint32_t iterations) {
+        Result r{"transform.apply"};
+
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        const auto node = FB::Maps::ResolveNode("Head");
+        float scale = 1.0f;
+        if (!player || !FBTransform::TryGetScale(player, node, scale)) {
+            r.skipped = "player head node not loaded";
+            return r;
+        }
+
+        // Lookup + write of the value already there: the full path, with nothing visible.
+        const auto start = Clock::now();
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            FBTransform::ApplyScale_MainThread(player, node, scale);
+        }
+        r.totalMs = MillisecondsSince(start);
+
+        r.ops = iterations;
+        return r;
+    }
+
+    class CountingMorphSink final : public FB::Morph::IBodyMorphSink {
+    public:
+        const char* Name() const override { return "Bench"; }
+
+        void Submit(RE::Actor*, std::span<const RE::BSFixedString> setNames, std::span<const float>,
+                    std::span<const RE::BSFixedString> clearNames) override {
+            ++submits;
+            morphs += setNames.size() + clearNames.size();
+        }
+
+        std::uint64_t submits = 0;
+        std::uint64_t morphs = 0;
+    };
+
+    Result BenchMorph(std::uint32_t frames, std::uint32_t morphsPerFrame) {
+        Result r{"morph.flush"};
+
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        if (!player) {
+            r.skipped = "no player";
+            return r;
+        }
+
+        std::vector<std::string> names;
+        for (std::uint32_t m = 0; m < morphsPerFrame; ++m) {
+            names.push_back(fmt::format("FBBenchMorph{}", m));
+        }
+
+        // Whatever is batched already goes to the real backend first.
+        FB::Morph::Flush_MainThread();
+
+        CountingMorphSink sink;
+        FB::Morph::SetSink(&sink);
+
+        for (std::uint32_t f = 0; f < frames; ++f) {
+            const auto start = Clock::now();
+            for (std::uint32_t m = 0; m < morphsPerFrame; ++m) {
+                FB::Morph::Set(player, names[m], (f % 2 ? 0.5f : 1.0f) + static_cast<float>(m) * 0.001f);
+            }
+            FB::Morph::Flush_MainThread();
+            r.samplesUs.push_back(MillisecondsSince(start) * 1000.0);
+        }
+
+        for (const auto& name : names) {
+            FB::Morph::Clear_MainThread(player, name);
+        }
+        FB::Morph::Flush_MainThread();
+        FB::Morph::SetSink(nullptr);
+
+        r.ops = static_cast<std::uint64_t>(frames) * morphsPerFrame;
+        r.values = {{"submits", static_cast<double>(sink.submits)}, {"morphs", static_cast<double>(sink.morphs)}};
+        return r;
+    }
+
+    //
+    // Report
+    //
+
+    void Summarize(Result& r) {
+        if (r.samplesUs.empty()) {
+            return;
+        }
+        std::sort(r.samplesUs.begin(), r.samplesUs.end());
+
+        double total = 0.0;
+        for (const double us : r.samplesUs) {
+            total += us;
+        }
+        r.totalMs = total / 1000.0;
+    }
+
+    std::string ToJson(std::span<const Result> results, std::uint32_t scale) {
+        fmt::memory_buffer out;
+        auto it = std::back_inserter(out);
+
+        fmt::format_to(it, "{{\n  \"plugin\": \"FullBodiedAnimations\",\n  \"scale\": {},\n", scale);
+        fmt::format_to(it, "  \"hardwareThreads\": {},\n  \"morphBackend\": \"{}\",\n  \"cases\": [",
+                       std::thread::hardware_concurrency(), FB::Morph::BackendName());
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            fmt::format_to(it, "{}\n    {{\"name\": \"{}\"", i ? "," : "", r.name);
+
+            if (!r.skipped.empty()) {
+                fmt::format_to(it, ", \"skipped\": \"{}\"}}", r.skipped);
+                continue;
+            }
+
+            fmt::format_to(it, ", \"ops\": {}, \"totalMs\": {:.3f}, \"nsPerOp\": {:.1f}", r.ops, r.totalMs,
+                           r.ops ? r.totalMs * 1e6 / static_cast<double>(r.ops) : 0.0);
+            if (!r.samplesUs.empty()) {
+                fmt::format_to(it, ", \"samples\": {}, \"p50Us\": {:.2f}, \"p99Us\": {:.2f}, \"maxUs\": {:.2f}",
+                               r.samplesUs.size(), Percentile(r.samplesUs, 0.50), Percentile(r.samplesUs, 0.99),
+                               r.samplesUs.back());
+            }
+            for (const auto& [key, value] : r.values) {
+                fmt::format_to(it, ", \"{}\": {:.6g}", key, value);
+            }
+            fmt::format_to(it, "}}");
+        }
+
+        fmt::format_to(it, "\n  ]\n}}\n");
+        return fmt::to_string(out);
+    }
+}
+
+namespace FB::Bench {
+    std::filesystem::path Run(std::uint32_t scale) {
+        scale = std::clamp<std::uint32_t>(scale, 1, 16);
+
+        const auto logDir = SKSE::log::log_directory();
+        if (!logDir) {
+            spdlog::error("[FB] Bench: no log directory");
+            return {};
+        }
+        const auto dataRoot = *logDir / "FullBodiedBench";
+        const auto reportPath = *logDir / "FullBodiedBench.json";
+
+        const auto live = FBConfig{}.GetSnapshot();  // the published one
+        if (!live) {
+            spdlog::error("[FB] Bench: no config snapshot");
+            return {};
+        }
+
+        constexpr std::uint32_t kTickFrames = 600;
+        std::error_code ec;
+        std::filesystem::remove_all(dataRoot, ec);
+        if (!WriteTree(dataRoot, 16 * scale, 64, kTickFrames / 60 + 2)) {
+            spdlog::error("[FB] Bench: could not write the generated tree under '{}'", dataRoot.string());
+            return {};
+        }
+
+        spdlog::info("[FB] Bench: start scale={}", scale);
+        const auto level = spdlog::default_logger()->level();
+        spdlog::set_level(spdlog::level::warn);
+
+        std::vector<Result> results;
+        std::shared_ptr<Snapshot> built;
+        results.push_back(BenchConfigBuild(dataRoot, 5, built));
+        results.push_back(BenchMaps(200000 * scale));
+        if (built) {
+            CopyRuntimeSettings(*live, *built);
+            built->StatsLogInterval = 0.0f;
+            results.push_back(BenchTick(std::move(built), 32 * scale, kTickFrames));
+        }
+        const auto producers = std::clamp<std::uint32_t>(std::thread::hardware_concurrency() - 1, 2, 8);
+        results.push_back(BenchEvents(producers, 100000 * scale));
+        results.push_back(BenchTransform(10000 * scale));
+        results.push_back(BenchMorph(kTickFrames, 32));
+
+        spdlog::set_level(level);
+        std::filesystem::remove_all(dataRoot, ec);
+
+        for (auto& r : results) {
+            Summarize(r);
+            if (r.skipped.empty()) {
+                spdlog::info("[FB] Bench: {} ops={} total={:.3f}ms ({:.1f}ns/op)", r.name, r.ops, r.totalMs,
+                             r.ops ? r.totalMs * 1e6 / static_cast<double>(r.ops) : 0.0);
+            } else {
+                spdlog::info("[FB] Bench: {} skipped ({})", r.name, r.skipped);
+            }
+        }
+
+        if (!WriteFile(reportPath, ToJson(results, scale))) {
+            spdlog::error("[FB] Bench: could not write '{}'", reportPath.string());
+            return {};
+        }
+        spdlog::info("[FB] Bench: report written to '{}'", reportPath.string());
+        return reportPath;
+    }
+}
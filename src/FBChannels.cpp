@@ -0,0 +1,273 @@
+#include "FBChannels.h"
+
+#include <algorithm>
+
+std::string FBChannelTable::MakeKey(ChannelKind kind, std::string_view name) {
+    std::string key;
+    key.reserve(2 + name.size());
+    key.push_back(kind == ChannelKind::Scale ? 'S' : 'M');
+    key.push_back('|');
+    key.append(name.data(), name.size());
+    return key;
+}
+
+void FBChannelTable::Fold(const Channel& ch, float& a, float& b) {
+    a = 1.0f;
+    b = 0.0f;
+
+    // Layers are kept sorted by priority, so folding in order applies higher priorities on top.
+    for (const auto& layer : ch.layers) {
+        switch (layer.spec.mode) {
+            case BlendMode::Override:
+                a = 0.0f;
+                b = layer.value;
+                break;
+            case BlendMode::Additive:
+                b += layer.value;
+                break;
+            case BlendMode::Multiply:
+                a *= layer.value;
+                b *= layer.value;
+                break;
+        }
+    }
+}
+
+const FBChannelTable::Channel* FBChannelTable::Find(std::uint32_t formID, ChannelKind kind,
+                                                    std::string_view name) const {
+    const auto actorIt = _actors.find(formID);
+    if (actorIt == _actors.end()) {
+        return nullptr;
+    }
+
+    const auto chIt = actorIt->second.find(MakeKey(kind, name));
+    if (chIt == actorIt->second.end()) {
+        return nullptr;
+    }
+
+    return &chIt->second;
+}
+
+void FBChannelTable::SetLayer(std::uint32_t formID, ChannelKind kind, std::string_view name, std::uint64_t source,
+                              const LayerSpec& spec, float value) {
+    auto& ch = _actors[formID][MakeKey(kind, name)];
+    if (ch.name.empty()) {
+        ch.kind = kind;
+        ch.name = std::string(name);
+    }
+
+    ch.pendingRelease = false;
+    ch.flushOnRelease = false;
+
+    auto it = std::find_if(ch.layers.begin(), ch.layers.end(), [&](const Layer& l) { return l.source == source; });
+    if (it != ch.layers.end()) {
+        if (it->spec.mode == spec.mode && it->spec.priority == spec.priority) {
+            if (it->value != value) {
+                it->value = value;
+                ch.dirty = true;
+            }
+            return;
+        }
+        ch.layers.erase(it);
+    }
+
+    Layer layer{};
+    layer.source = source;
+    layer.spec = spec;
+    layer.value = value;
+
+    // Insert after every layer of equal or lower priority (later sources win ties).
+    auto pos = std::upper_bound(ch.layers.begin(), ch.layers.end(), spec.priority,
+                                [](std::int32_t p, const Layer& l) { return p < l.spec.priority; });
+    ch.layers.insert(pos, layer);
+    ch.dirty = true;
+}
+
+std::optional<float> FBChannelTable::GetLayerValue(std::uint32_t formID, ChannelKind kind, std::string_view name,
+                                                   std::uint64_t source) const {
+    const auto* ch = Find(formID, kind, name);
+    if (!ch) {
+        return std::nullopt;
+    }
+
+    for (const auto& layer : ch->layers) {
+        if (layer.source == source) {
+            return layer.value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<float> FBChannelTable::GetResolvedValue(std::uint32_t formID, ChannelKind kind, std::string_view name,
+                                                      float base) const {
+    const auto* ch = Find(formID, kind, name);
+    if (!ch || ch->layers.empty()) {
+        return std::nullopt;
+    }
+
+    float a = 1.0f;
+    float b = 0.0f;
+    Fold(*ch, a, b);
+    return a * base + b;
+}
+
+bool FBChannelTable::HasChannel(std::uint32_t formID, ChannelKind kind, std::string_view name) const {
+    return Find(formID, kind, name) != nullptr;
+}
+
+bool FBChannelTable::EraseSource(Channel& ch, std::uint64_t source, bool restore) {
+    // A change made this tick that was never resolved must still reach the engine when the
+    // channel is forgotten (e.g. a tween finishing after its timeline closed without reset).
+    const bool unwritten = ch.dirty && !ch.pendingRelease;
+    float a = 1.0f;
+    float b = 0.0f;
+    if (unwritten) {
+        Fold(ch, a, b);
+    }
+
+    const auto oldSize = ch.layers.size();
+    ch.layers.erase(
+        std::remove_if(ch.layers.begin(), ch.layers.end(), [&](const Layer& l) { return l.source == source; }),
+        ch.layers.end());
+
+    if (ch.layers.size() == oldSize) {
+        return false;
+    }
+
+    ch.dirty = true;
+    if (ch.layers.empty()) {
+        ch.pendingRelease = true;
+        ch.restoreOnRelease = restore;
+        ch.flushOnRelease = !restore && unwritten;
+        ch.flushA = a;
+        ch.flushB = b;
+    }
+    return true;
+}
+
+void FBChannelTable::RemoveSource(std::uint64_t source, bool restore) {
+    for (auto& [formID, channels] : _actors) {
+        for (auto& [key, ch] : channels) {
+            EraseSource(ch, source, restore);
+        }
+    }
+}
+
+void FBChannelTable::RemoveLayer(std::uint32_t formID, ChannelKind kind, std::string_view name, std::uint64_t source,
+                                 bool restore) {
+    const auto actorIt = _actors.find(formID);
+    if (actorIt == _actors.end()) {
+        return;
+    }
+
+    const auto chIt = actorIt->second.find(MakeKey(kind, name));
+    if (chIt == actorIt->second.end()) {
+        return;
+    }
+
+    EraseSource(chIt->second, source, restore);
+}
+
+void FBChannelTable::MarkSourceDirty(std::uint64_t source, ChannelKind kind) {
+    for (auto& [formID, channels] : _actors) {
+        for (auto& [key, ch] : channels) {
+            if (ch.kind != kind) {
+                continue;
+            }
+
+            const bool owns = std::any_of(ch.layers.begin(), ch.layers.end(),
+                                          [&](const Layer& l) { return l.source == source; });
+            if (owns) {
+                ch.dirty = true;
+                ch.force = true;
+            }
+        }
+    }
+}
+
+bool FBChannelTable::MarkChannelDirty(std::uint32_t formID, ChannelKind kind, std::string_view name) {
+    const auto actorIt = _actors.find(formID);
+    if (actorIt == _actors.end()) {
+        return false;
+    }
+
+    const auto chIt = actorIt->second.find(MakeKey(kind, name));
+    if (chIt == actorIt->second.end() || chIt->second.pendingRelease) {
+        return false;
+    }
+
+    chIt->second.dirty = true;
+    chIt->second.force = true;
+    return true;
+}
+
+void FBChannelTable::Resolve(std::vector<ChannelWrite>& out) {
+    for (auto actorIt = _actors.begin(); actorIt != _actors.end();) {
+        auto& channels = actorIt->second;
+
+        for (auto chIt = channels.begin(); chIt != channels.end();) {
+            auto& ch = chIt->second;
+
+            if (!ch.dirty) {
+                ++chIt;
+                continue;
+            }
+
+            if (ch.pendingRelease) {
+                ChannelWrite w{};
+                w.formID = actorIt->first;
+                w.kind = ch.kind;
+                w.op = ch.restoreOnRelease ? ChannelOp::Restore : ChannelOp::Forget;
+                w.name = ch.name;
+                w.flush = ch.flushOnRelease;
+                w.a = ch.flushA;
+                w.b = ch.flushB;
+                out.push_back(std::move(w));
+
+                chIt = channels.erase(chIt);
+                continue;
+            }
+
+            float a = 1.0f;
+            float b = 0.0f;
+            Fold(ch, a, b);
+
+            const bool changed = !ch.hasLast || ch.lastA != a || ch.lastB != b;
+            if (changed || ch.force) {
+                ChannelWrite w{};
+                w.formID = actorIt->first;
+                w.kind = ch.kind;
+                w.op = ChannelOp::Set;
+                w.name = ch.name;
+                w.a = a;
+                w.b = b;
+                w.force = !changed;
+                out.push_back(std::move(w));
+
+                ch.hasLast = true;
+                ch.lastA = a;
+                ch.lastB = b;
+            }
+
+            ch.dirty = false;
+            ch.force = false;
+            ++chIt;
+        }
+
+        if (channels.empty()) {
+            actorIt = _actors.erase(actorIt);
+        } else {
+            ++actorIt;
+        }
+    }
+}
+
+void FBChannelTable::Clear() { _actors.clear(); }
+
+std::size_t FBChannelTable::ChannelCount() const {
+    std::size_t n = 0;
+    for (const auto& [formID, channels] : _actors) {
+        n += channels.size();
+    }
+    return n;
+}
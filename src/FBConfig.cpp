@@ -1,7 +1,12 @@
 #include "FBConfig.h"
+#include "FBHkx.h"
 #include "FBMaps.h"
+#include "FBMetrics.h"
+#include "FBTags.h"
 
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <fstream>
 #include <sstream>
@@ -12,7 +17,8 @@
 #include <cstring>
 
 namespace {
-    std::shared_ptr<const Snapshot> g_snapshot;
+    // Published whole on (re)load; readers on any thread get a consistent snapshot.
+    std::atomic<std::shared_ptr<const Snapshot>> g_snapshot;
 
     static inline void FBTrimInPlace(std::string& s) {
         auto notSpace = [](unsigned char c) { return !std::isspace(c); };
@@ -36,14 +42,12 @@ namespace {
         return true;
     }
 
-    static std::vector<std::filesystem::path> GetGeneralIniCandidates() { 
-    return {std::filesystem::path("Data") / "FullBodiedIni.ini",
-                std::filesystem::path("Data") / "SKSE" / "Plugins" / "FullBodiedIni.ini"};
+    static std::vector<std::filesystem::path> GetGeneralIniCandidates(const std::filesystem::path& dataRoot) {
+        return {dataRoot / "FullBodiedIni.ini", dataRoot / "SKSE" / "Plugins" / "FullBodiedIni.ini"};
     }
 
-    static std::filesystem::path GetOARRoot() {
-        return std::filesystem::path("Data") / "meshes" / "actors" / "character" / "animations" /
-               "OpenAnimationReplacer";
+    static std::filesystem::path GetOARRoot(const std::filesystem::path& dataRoot) {
+        return dataRoot / "meshes" / "actors" / "character" / "animations" / "OpenAnimationReplacer";
     }
 
     static std::optional<std::filesystem::path> FindDirRecursive(const std::filesystem::path& root,
@@ -83,10 +87,29 @@ namespace {
         return s;
     }
 
-    // Parses:  "0.5,tween=2.0,delay=0.25,easing=Linear"
-    static bool ParseArgsAndTweenSpec(const std::string& inArgs, std::string& outPrimary, TweenSpec& outTween) {
+    static bool TryParseBlendMode(std::string val, BlendMode& out) {
+        val = ToLowerCopy(std::move(val));
+        if (val == "override" || val == "set") {
+            out = BlendMode::Override;
+            return true;
+        }
+        if (val == "add" || val == "additive") {
+            out = BlendMode::Additive;
+            return true;
+        }
+        if (val == "mul" || val == "multiply" || val == "multiplicative") {
+            out = BlendMode::Multiply;
+            return true;
+        }
+        return false;
+    }
+
+    // Parses:  "0.5,tween=2.0,delay=0.25,easing=Linear,blend=add,priority=10"
+    static bool ParseArgsAndTweenSpec(const std::string& inArgs, std::string& outPrimary, TweenSpec& outTween,
+                                      LayerSpec& outLayer) {
         outPrimary.clear();
         outTween = TweenSpec{};
+        outLayer = LayerSpec{};
 
         std::string work = inArgs;
         FBTrimInPlace(work);
@@ -125,6 +148,16 @@ namespace {
                 outTween.hasTween = true;  // important: user explicitly set tween=
                 float f;
                 if (TryParseFloatStrict(val, f) && f >= 0.0f) outTween.duration = f;
+            } else if (key == "blend") {
+                if (!TryParseBlendMode(val, outLayer.mode)) {
+                    spdlog::warn("[FB] INI: unknown blend='{}' (expected override|add|mul); using override", val);
+                }
+            } else if (key == "priority") {
+                try {
+                    outLayer.priority = std::stoi(val);
+                } catch (...) {
+                    spdlog::warn("[FB] INI: invalid priority='{}'; using 0", val);
+                }
             }
         }
 
@@ -138,10 +171,294 @@ namespace {
     }
 
 }
-static bool BuildSnapshotFromIni(Snapshot& out) {
+static std::atomic<bool> g_formsLoaded{false};
+
+void FBConfig::SetFormsLoaded() { g_formsLoaded.store(true, std::memory_order_release); }
+
+// "Plugin.esp|0x000D62" (form ID local to that plugin), "0x0001A2B3" (full form ID), or an editor ID.
+// Stock SSE drops the editor IDs of sound descriptors, effect shaders and art objects after loading,
+// so editor-ID specs only resolve with a plugin that keeps them (powerofthree's Tweaks); prefer
+// plugin-local IDs.
+static RE::TESForm* ResolveFormSpec(const std::string& spec) {
+    try {
+        if (const auto bar = spec.find('|'); bar != std::string::npos) {
+            std::string plugin = spec.substr(0, bar);
+            std::string localID = spec.substr(bar + 1);
+            FBTrimInPlace(plugin);
+            FBTrimInPlace(localID);
+
+            auto* dataHandler = RE::TESDataHandler::GetSingleton();
+            const auto id = static_cast<RE::FormID>(std::stoul(localID, nullptr, 16));
+            return dataHandler ? dataHandler->LookupForm(id, plugin) : nullptr;
+        }
+        if (spec.rfind("0x", 0) == 0 || spec.rfind("0X", 0) == 0) {
+            return RE::TESForm::LookupByID(static_cast<RE::FormID>(std::stoul(spec, nullptr, 16)));
+        }
+    } catch (...) {
+        return nullptr;
+    }
+    return RE::TESForm::LookupByEditorID(spec);
+}
+
+static bool IsEditorIdSpec(const std::string& spec) {
+    return spec.find('|') == std::string::npos && spec.rfind("0x", 0) != 0 && spec.rfind("0X", 0) != 0;
+}
+
+static bool IsExpectedFxForm(const FBCommand& cmd, RE::TESForm* form) {
+    if (cmd.opcode == "Play") return form->As<RE::BGSSoundDescriptorForm>() != nullptr;
+    if (cmd.opcode == "Shader") return form->As<RE::TESEffectShader>() != nullptr;
+    if (cmd.opcode == "ArtObject") return form->As<RE::BGSArtObject>() != nullptr;
+    return false;
+}
+
+// Resolve every Fx command's key to its form once, so firing one never looks anything up.
+// Sounds are looked up in [SoundMap], shaders and art objects in [EffectMap]; keys missing from
+// the map are tried as form specs themselves.
+static void ResolveFxForms(Snapshot& out, const std::unordered_map<std::string, std::string>& soundMap,
+                           const std::unordered_map<std::string, std::string>& effectMap) {
+    std::unordered_map<std::string, RE::TESForm*> resolved;  // by "opcode|key"
+    std::size_t unresolved = 0;
+
+    for (auto& [scriptKey, list] : out.scripts) {
+        for (auto& tc : list) {
+            auto& cmd = tc.command;
+            if (cmd.type != FBCommandType::Fx) {
+                continue;
+            }
+
+            auto [it, inserted] = resolved.try_emplace(cmd.opcode + "|" + cmd.target, nullptr);
+            if (inserted) {
+                const auto& map = (cmd.opcode == "Play") ? soundMap : effectMap;
+                const auto mapIt = map.find(cmd.target);
+                const std::string& spec = (mapIt != map.end()) ? mapIt->second : cmd.target;
+
+                RE::TESForm* form = ResolveFormSpec(spec);
+                if (form && !IsExpectedFxForm(cmd, form)) {
+                    spdlog::warn("[FB] INI: fx key '{}' ({}) is the wrong form type for {}", cmd.target, spec,
+                                 cmd.opcode);
+                    form = nullptr;
+                } else if (!form && IsEditorIdSpec(spec)) {
+                    spdlog::warn("[FB] INI: fx key '{}' ({}) not found; editor IDs of sounds and effects need "
+                                 "powerofthree's Tweaks, use Plugin.esp|0xID instead",
+                                 cmd.target, spec);
+                } else if (!form) {
+                    spdlog::warn("[FB] INI: fx key '{}' ({}) not found", cmd.target, spec);
+                }
+                it->second = form;
+            }
+
+            cmd.form = it->second;
+            unresolved += cmd.form ? 0 : 1;
+        }
+    }
+
+    if (!resolved.empty()) {
+        spdlog::info("[FB] INI: resolved {} fx keys ({} commands unresolved)", resolved.size(), unresolved);
+    }
+}
+
+// One timeline command in the shared grammar of per-anim INI lines and HKX annotations, e.g.
+// "FBScale_Head(1.2, tween=0.5)". A "2_" prefix moves a Caster command to the Target.
+static bool ParseTimelineCommand(std::string cmdStr, ActorRole sectionRole, Generation generation, FBCommand& cmd) {
+    ActorRole role = sectionRole;
+
+    bool targetOverride = false;
+    if (cmdStr.rfind("2_", 0) == 0) {
+        targetOverride = true;
+        cmdStr = cmdStr.substr(2);
+        FBTrimInPlace(cmdStr);
+    }
+
+    if (sectionRole == ActorRole::Caster && targetOverride) {
+        role = ActorRole::Target;
+    }
+
+    auto open = cmdStr.find('(');
+    auto close = cmdStr.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close <= open) {
+        return false;
+    }
+
+    std::string opAndNode = cmdStr.substr(0, open);
+    FBTrimInPlace(opAndNode);
+
+    std::string argStr = cmdStr.substr(open + 1, close - open - 1);
+    FBTrimInPlace(argStr);
+
+    cmd = FBCommand{};
+    cmd.role = role;
+    cmd.generation = generation;
+
+    if (opAndNode.rfind("FBScale_", 0) == 0) {
+        std::string nodeKey = opAndNode.substr(std::string("FBScale_").size());
+        FBTrimInPlace(nodeKey);
+
+        const std::string_view resolved = FB::Maps::ResolveNode(nodeKey);
+
+        cmd.type = FBCommandType::Transform;
+        cmd.opcode = "Scale";
+        cmd.target = std::string(resolved);  // store owning copy
+        // cmd.target = niNode;  // may be friendly key or full node; Exec will ResolveNode anyway
+        {
+            std::string primary;
+            TweenSpec tween{};
+            LayerSpec layer{};
+
+            if (ParseArgsAndTweenSpec(argStr, primary, tween, layer)) {
+                cmd.args = primary;
+                cmd.tween = tween;
+                cmd.layer = layer;
+            } else {
+                cmd.args = argStr;  // fallback legacy behavior
+            }
+        }
+    } else if (opAndNode.rfind("FBMove_", 0) == 0) {
+        std::string nodeKey = opAndNode.substr(std::string("FBMove_").size());
+        FBTrimInPlace(nodeKey);
+        const std::string_view resolved = FB::Maps::ResolveNode(nodeKey);
+        cmd.type = FBCommandType::Transform;
+        cmd.opcode = "Move";
+        cmd.target = std::string(resolved);  // store owning copy
+        {
+            std::string primary;
+            TweenSpec tween{};
+            LayerSpec layer{};
+
+            if (ParseArgsAndTweenSpec(argStr, primary, tween, layer)) {
+                cmd.args = primary;
+                cmd.tween = tween;
+                cmd.layer = layer;
+            } else {
+                cmd.args = argStr;  // fallback legacy behavior
+            }
+        }
+        
+    } else if (opAndNode.rfind("FBMorph_", 0) == 0) {
+        std::string morphKey = opAndNode.substr(std::string("FBMorph_").size());
+        FBTrimInPlace(morphKey);
+
+        cmd.type = FBCommandType::Morph;
+        cmd.opcode = "Set";
+        cmd.target = morphKey;  // KEEP FRIENDLY KEY; Exec will ResolveMorph (pass-through for now)
+        {
+            std::string primary;
+            TweenSpec tween{};
+            LayerSpec layer{};
+
+            if (ParseArgsAndTweenSpec(argStr, primary, tween, layer)) {
+                cmd.args = primary;
+                cmd.tween = tween;
+                cmd.layer = layer;
+            } else {
+                cmd.args = argStr;  // fallback legacy behavior
+            }
+        }
+
+    } else if (opAndNode == "FBFx_Play") {
+        cmd.type = FBCommandType::Fx;
+        cmd.opcode = "Play";
+        cmd.target = argStr;  // sound key; resolved below with the rest of the scripts
+
+    } else if (opAndNode == "FBState_Restrain" || opAndNode == "FBState_AI") {
+        // FBState_Restrain(1|0) / FBState_AI(1|0); reverted when the timeline ends
+        cmd.type = FBCommandType::State;
+        cmd.opcode = (opAndNode == "FBState_AI") ? "AI" : "Restrain";
+        cmd.args = argStr;
+
+    } else if (opAndNode == "FBState_AV") {
+        // FBState_AV(ActorValueName, value): base value, reverted when the timeline ends
+        const auto comma = argStr.find(',');
+        if (comma == std::string::npos) {
+            spdlog::warn("[FB] INI: FBState_AV needs (Name, value); got '{}'", argStr);
+            return false;
+        }
+
+        cmd.type = FBCommandType::State;
+        cmd.opcode = "AV";
+        cmd.target = argStr.substr(0, comma);
+        cmd.args = argStr.substr(comma + 1);
+        FBTrimInPlace(cmd.target);
+        FBTrimInPlace(cmd.args);
+
+    } else if (opAndNode == "FBFx_Shader" || opAndNode == "FBFx_ArtObject") {
+        // FBFx_Shader(Key[, duration]) / FBFx_ArtObject(Node, Key[, duration]); no duration = until reset
+        std::vector<std::string> parts;
+        std::stringstream ss(argStr);
+        for (std::string part; std::getline(ss, part, ',');) {
+            FBTrimInPlace(part);
+            parts.push_back(std::move(part));
+        }
+
+        const bool isArt = (opAndNode == "FBFx_ArtObject");
+        const std::size_t keyIndex = isArt ? 1 : 0;
+        if (parts.size() <= keyIndex || parts[keyIndex].empty()) {
+            spdlog::warn("[FB] INI: {} needs {}; got '{}'", opAndNode, isArt ? "(Node, Key)" : "(Key)", argStr);
+            return false;
+        }
+
+        cmd.type = FBCommandType::Fx;
+        cmd.opcode = isArt ? "ArtObject" : "Shader";
+        cmd.target = parts[keyIndex];
+        // args: "[duration]" for shaders, "Node[,duration]" for art objects
+        const std::string duration = parts.size() > keyIndex + 1 ? parts[keyIndex + 1] : std::string();
+        cmd.args = isArt ? std::string(FB::Maps::ResolveNode(parts[0])) + "," + duration : duration;
+
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+// FB annotations of the clip's .hkx files, as commands of `scriptKey`. Variants of one clip carry
+// the same timeline, so the first file (by name) with FB annotations is used.
+static void AddHkxAnnotations(const std::filesystem::path& folder, const std::string& scriptKey, Snapshot& out) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(folder, ec), end; it != end && !ec; it.increment(ec)) {
+        if (it->is_regular_file(ec) && IEquals(it->path().extension().string(), ".hkx")) {
+            files.push_back(it->path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<FB::Hkx::Annotation> annotations;
+    for (const auto& file : files) {
+        annotations.clear();
+        if (!FB::Hkx::GetAnnotations(file, annotations) || annotations.empty()) {
+            continue;
+        }
+
+        auto& list = out.scripts[scriptKey];
+        std::size_t added = 0;
+        for (const auto& annotation : annotations) {
+            FBCommand cmd{};
+            if (!ParseTimelineCommand(annotation.text, ActorRole::Caster, out.generation, cmd)) {
+                spdlog::warn("[FB] INI: {}: unrecognised annotation '{}' at t={}", file.filename().string(),
+                             annotation.text, annotation.time);
+                continue;
+            }
+
+            TimedCommand tc{};
+            tc.time = annotation.time;
+            tc.command = std::move(cmd);
+            list.push_back(std::move(tc));
+            ++added;
+        }
+
+        std::stable_sort(list.begin(), list.end(),
+                         [](const TimedCommand& a, const TimedCommand& b) { return a.time < b.time; });
+
+        spdlog::info("[FB] INI: {} annotation cmds from '{}' for script {}", added, file.filename().string(),
+                     scriptKey);
+        return;
+    }
+}
+
+static bool BuildSnapshotFromIni(Snapshot& out, const std::filesystem::path& dataRoot) {
     // 1) Find global ini
     std::filesystem::path generalIni;
-    for (auto& p : GetGeneralIniCandidates()) {
+    for (auto& p : GetGeneralIniCandidates(dataRoot)) {
         std::ifstream t(p);
         if (t.good()) {
             generalIni = p;
@@ -157,6 +474,8 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
     // 2) Parse global ini (only [General] and [FBFiles] for Phase 2)
     bool enableTimelines = true;
     std::unordered_map<std::string, std::string> fbFiles;  // alias -> clip.hkx
+    std::unordered_map<std::string, std::string> soundMap;  // sound key -> form
+    std::unordered_map<std::string, std::string> effectMap;  // shader / art object key -> form
 
     std::ifstream in(generalIni);
     std::string currentSection;
@@ -188,6 +507,12 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
             if (IEquals(key, "ResetOnPairEnd")) {
                 out.ResetOnPairEnd = (val == "true" || val == "1" || IEquals(val, "true"));
             }
+            if (IEquals(key, "HkxAnnotations")) {
+                out.HkxAnnotations = (val == "true" || val == "1" || IEquals(val, "true"));
+            }
+            if (IEquals(key, "NativeExpressions")) {
+                out.NativeExpressions = (val == "true" || val == "1" || IEquals(val, "true"));
+            }
             if (IEquals(key, "ResetDelay")) {
                 try {
                     out.ResetDelay = std::stof(val);
@@ -218,11 +543,94 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
                     out.DefaultTweenMorph = 0.0f;
                 }
             }
+
+            if (IEquals(key, "EventCoalesceWindow")) {
+                try {
+                    out.EventCoalesceWindow = std::stof(val);
+                    if (out.EventCoalesceWindow < 0.0f) out.EventCoalesceWindow = 0.0f;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid EventCoalesceWindow='{}'; using 0.05", val);
+                    out.EventCoalesceWindow = 0.05f;
+                }
+            }
+
+            if (IEquals(key, "MorphEpsilon")) {
+                try {
+                    out.MorphEpsilon = std::stof(val);
+                    if (out.MorphEpsilon < 0.0f) out.MorphEpsilon = 0.0f;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid MorphEpsilon='{}'; using 0.001", val);
+                    out.MorphEpsilon = 0.001f;
+                }
+            }
+
+            if (IEquals(key, "MorphTweenStep")) {
+                try {
+                    out.MorphTweenStep = std::stof(val);
+                    if (out.MorphTweenStep < 0.0f) out.MorphTweenStep = 0.0f;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid MorphTweenStep='{}'; using 0.02", val);
+                    out.MorphTweenStep = 0.02f;
+                }
+            }
+
+            if (IEquals(key, "MorphTweenMaxInterval")) {
+                try {
+                    out.MorphTweenMaxInterval = std::stof(val);
+                    if (out.MorphTweenMaxInterval < 0.0f) out.MorphTweenMaxInterval = 0.0f;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid MorphTweenMaxInterval='{}'; using 0.1", val);
+                    out.MorphTweenMaxInterval = 0.1f;
+                }
+            }
+
+            if (IEquals(key, "FxVoicesPerActor")) {
+                try {
+                    const int n = std::stoi(val);
+                    out.FxVoicesPerActor = n > 0 ? static_cast<std::uint32_t>(n) : 1u;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid FxVoicesPerActor='{}'; using 4", val);
+                    out.FxVoicesPerActor = 4;
+                }
+            }
+
+            if (IEquals(key, "StatsLogInterval")) {
+                try {
+                    out.StatsLogInterval = std::max(std::stof(val), 0.0f);
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid StatsLogInterval='{}'; using 300", val);
+                    out.StatsLogInterval = 300.0f;
+                }
+            }
+
+            if (IEquals(key, "PapyrusCallsPerFrame")) {
+                try {
+                    const int n = std::stoi(val);
+                    out.PapyrusCallsPerFrame = n > 0 ? static_cast<std::uint32_t>(n) : 1u;
+                } catch (...) {
+                    spdlog::warn("[FB] Config: invalid PapyrusCallsPerFrame='{}'; using 8", val);
+                    out.PapyrusCallsPerFrame = 8;
+                }
+            }
         
         } else if (IEquals(currentSection, "FBFiles")) {
             if (!key.empty() && !val.empty()) {
                 fbFiles[key] = val;
             }
+        } else if (IEquals(currentSection, "SoundMap")) {
+            // SoundKey = Plugin.esp|0x000D62, a full form ID, or an editor ID
+            if (!key.empty() && !val.empty()) {
+                soundMap[key] = val;
+            }
+        } else if (IEquals(currentSection, "EffectMap")) {
+            if (!key.empty() && !val.empty()) {
+                effectMap[key] = val;
+            }
+        } else if (IEquals(currentSection, "DevourmentEventMap")) {
+            // SwallowSuccess_Stomach = scriptKey (keys as normalized by FBIntegrationDevourment)
+            if (!key.empty() && !val.empty()) {
+                out.devourmentEventMap[key] = val;
+            }
         } else if (IEquals(currentSection, "EventMap") || IEquals(currentSection, "EventToTimeline")) {
             // Optional support if you add it later
             if (!key.empty() && !val.empty()) {
@@ -256,7 +664,7 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
     //}
 
     // 3) For each FBFiles entry, find _variants_<clipBase> folder and load FB_<alias>.ini
-    const auto oarRoot = GetOARRoot();
+    const auto oarRoot = GetOARRoot(dataRoot);
     for (auto& [alias, clip] : fbFiles) {
         const std::string scriptKey = clip;
         out.scripts[scriptKey].clear();
@@ -277,10 +685,18 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
         }
 
         const auto folder = *folderOpt;
+        if (out.HkxAnnotations) {
+            AddHkxAnnotations(folder, scriptKey, out);
+        }
+
         const auto animIni = folder / ("FB_" + alias + ".ini");
         std::ifstream ain(animIni);
         if (!ain.good()) {
-            spdlog::warn("[FB] INI: missing per-anim ini: {}", animIni.string());
+            if (out.scripts[scriptKey].empty()) {
+                spdlog::warn("[FB] INI: missing per-anim ini: {}", animIni.string());
+            } else {
+                spdlog::info("[FB] INI: no per-anim ini at {}; using annotations only", animIni.string());
+            }
             continue;
         }
         
@@ -331,99 +747,9 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
 
             if (!t) continue;
 
-            ActorRole role = (sec == Sec::Caster) ? ActorRole::Caster : ActorRole::Target;
-
-            bool targetOverride = false;
-            if (cmdStr.rfind("2_", 0) == 0) {
-                targetOverride = true;
-                cmdStr = cmdStr.substr(2);
-                FBTrimInPlace(cmdStr);
-            }
-
-            if (sec == Sec::Caster && targetOverride) {
-                role = ActorRole::Target;
-            }
-
-            auto open = cmdStr.find('(');
-            auto close = cmdStr.rfind(')');
-            if (open == std::string::npos || close == std::string::npos || close <= open) {
-                continue;
-            }
-
-            std::string opAndNode = cmdStr.substr(0, open);
-            FBTrimInPlace(opAndNode);
-
-            std::string argStr = cmdStr.substr(open + 1, close - open - 1);
-            FBTrimInPlace(argStr);
-
-
-
-
-
             FBCommand cmd{};
-            cmd.role = role;
-            cmd.generation = out.generation;
-
-            if (opAndNode.rfind("FBScale_", 0) == 0) {
-                std::string nodeKey = opAndNode.substr(std::string("FBScale_").size());
-                FBTrimInPlace(nodeKey);
-
-                const std::string_view resolved = FB::Maps::ResolveNode(nodeKey);
-
-                cmd.type = FBCommandType::Transform;
-                cmd.opcode = "Scale";
-                cmd.target = std::string(resolved);  // store owning copy
-                // cmd.target = niNode;  // may be friendly key or full node; Exec will ResolveNode anyway
-                {
-                    std::string primary;
-                    TweenSpec tween{};
-
-                    if (ParseArgsAndTweenSpec(argStr, primary, tween)) {
-                        cmd.args = primary;
-                        cmd.tween = tween;
-                    } else {
-                        cmd.args = argStr;  // fallback legacy behavior
-                    }
-                }
-            } else if (opAndNode.rfind("FBMove_", 0) == 0) {
-                std::string nodeKey = opAndNode.substr(std::string("FBMove_").size());
-                FBTrimInPlace(nodeKey);
-                const std::string_view resolved = FB::Maps::ResolveNode(nodeKey);
-                cmd.type = FBCommandType::Transform;
-                cmd.opcode = "Move";
-                cmd.target = std::string(resolved);  // store owning copy
-                {
-                    std::string primary;
-                    TweenSpec tween{};
-
-                    if (ParseArgsAndTweenSpec(argStr, primary, tween)) {
-                        cmd.args = primary;
-                        cmd.tween = tween;
-                    } else {
-                        cmd.args = argStr;  // fallback legacy behavior
-                    }
-                }
-                
-            } else if (opAndNode.rfind("FBMorph_", 0) == 0) {
-                std::string morphKey = opAndNode.substr(std::string("FBMorph_").size());
-                FBTrimInPlace(morphKey);
-
-                cmd.type = FBCommandType::Morph;
-                cmd.opcode = "Set";
-                cmd.target = morphKey;  // KEEP FRIENDLY KEY; Exec will ResolveMorph (pass-through for now)
-                {
-                    std::string primary;
-                    TweenSpec tween{};
-
-                    if (ParseArgsAndTweenSpec(argStr, primary, tween)) {
-                        cmd.args = primary;
-                        cmd.tween = tween;
-                    } else {
-                        cmd.args = argStr;  // fallback legacy behavior
-                    }
-                }
-
-            } else {
+            if (!ParseTimelineCommand(std::move(cmdStr), sec == Sec::Caster ? ActorRole::Caster : ActorRole::Target,
+                                      out.generation, cmd)) {
                 continue;
             }
 
@@ -448,8 +774,8 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
 
         // Sort script by time
         auto& list = out.scripts[scriptKey];
-        std::sort(list.begin(), list.end(),
-                  [](const TimedCommand& a, const TimedCommand& b) { return a.time < b.time; });
+        std::stable_sort(list.begin(), list.end(),
+                         [](const TimedCommand& a, const TimedCommand& b) { return a.time < b.time; });
 
 
         spdlog::info("[FB] INI: parsed {} cmds for script {}", out.scripts[scriptKey].size(), scriptKey);
@@ -459,6 +785,14 @@ static bool BuildSnapshotFromIni(Snapshot& out) {
         spdlog::info("[FB] INI: scriptKey='{}' cmds={}", k, v.size());
     }
 
+    if (g_formsLoaded.load(std::memory_order_acquire)) {
+        ResolveFxForms(out, soundMap, effectMap);
+    } else {
+        spdlog::info("[FB] INI: fx keys resolve once game data has loaded");
+    }
+    if (out.HkxAnnotations) {
+        FB::Hkx::SaveCache();
+    }
 
     return true;
 }
@@ -478,19 +812,62 @@ static bool TryParseFloat(std::string_view s, float& out) {
 }
 
 
+static void IndexBindings(const Snapshot& snap, const std::unordered_map<std::string, std::string>& map,
+                          std::vector<EventBinding>& out) {
+    out.clear();
+
+    for (const auto& [tag, scriptKey] : map) {
+        const TagId id = FB::Tags::Intern(tag);
+        if (id == FB::Tags::kNone) {
+            continue;
+        }
+
+        if (id >= out.size()) {
+            out.resize(static_cast<std::size_t>(id) + 1);
+        }
+
+        auto& binding = out[id];
+        binding.scriptKey = scriptKey;
+
+        const auto scriptIt = snap.scripts.find(scriptKey);
+        binding.script = (scriptIt != snap.scripts.end()) ? &scriptIt->second : nullptr;
+    }
+}
+
+// Intern every [EventMap] tag and [DevourmentEventMap] key and index the bindings by id. Runs
+// once the scripts are loaded.
+static void BuildEventIndex(Snapshot& snap) {
+    IndexBindings(snap, snap.eventMap, snap.eventsByTag);
+    IndexBindings(snap, snap.devourmentEventMap, snap.devourmentByKey);
+
+    spdlog::info("[FB] Config: indexed {} event tags, {} Devourment triggers", snap.eventMap.size(),
+                 snap.devourmentEventMap.size());
+}
+
+bool FBConfig::BuildSnapshot(const std::filesystem::path& dataRoot, Snapshot& out) {
+    if (!BuildSnapshotFromIni(out, dataRoot)) {
+        return false;
+    }
+    BuildEventIndex(out);
+    return true;
+}
+
 bool FBConfig::LoadInitial() {
+    const auto buildStart = std::chrono::steady_clock::now();
     auto snapshot = std::make_shared<Snapshot>();
     snapshot->generation = 1;
 
     snapshot->eventMap.clear();
     snapshot->scripts.clear();
 
-    if (!BuildSnapshotFromIni(*snapshot)) {
+    if (!BuildSnapshotFromIni(*snapshot, kDataRoot)) {
         spdlog::error("[FB] Config: INI parse failed; no fallback will run");
 
     }
+    BuildEventIndex(*snapshot);
+    FB::Metrics::RecordSnapshotBuild(std::chrono::steady_clock::now() - buildStart);
 
-    g_snapshot = std::move(snapshot);
+    g_snapshot.store(std::move(snapshot));
     return true;
 }
 
@@ -498,18 +875,21 @@ bool FBConfig::LoadInitial() {
 
 
 bool FBConfig::Reload() {
+    const auto buildStart = std::chrono::steady_clock::now();
     auto next = std::make_shared<Snapshot>();
     next->generation = GetGeneration() + 1;
 
     next->eventMap.clear();
     next->scripts.clear();
 
-    if (!BuildSnapshotFromIni(*next)) {
+    if (!BuildSnapshotFromIni(*next, kDataRoot)) {
         spdlog::error("[FB] Config: Reload failed; keeping gen={}", GetGeneration());
         return false;
     }
+    BuildEventIndex(*next);
+    FB::Metrics::RecordSnapshotBuild(std::chrono::steady_clock::now() - buildStart);
 
-    g_snapshot = std::move(next);
+    g_snapshot.store(std::move(next));
     spdlog::info("[FB] Config: Reload success; gen={}", GetGeneration());
     return true;
 }
@@ -519,4 +899,4 @@ bool FBConfig::Reload() {
 
 //Generation FBConfig::GetGeneration() const { return g_snapshot ? g_snapshot->generation : 0; }
 
-std::shared_ptr<const Snapshot> FBConfig::GetSnapshot() const { return g_snapshot; }
\ No newline at end of file
+std::shared_ptr<const Snapshot> FBConfig::GetSnapshot() const { return _fixed ? _fixed : g_snapshot.load(); }
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include "FBDispatch.h"
+
+#include <RE/F/FunctionArguments.h>
+#include <RE/S/SkyrimVM.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "FBMetrics.h"
+#include "FBMorph.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // A call whose functor never reports back (VM error, save/load) frees its slot after this.
+    constexpr auto kInFlightTimeout = std::chrono::seconds(2);
+
+    // Actors without 3D go after every visible one.
+    constexpr float kHiddenPenalty = 1.0e12f;
+
+    constexpr const char* kBodyMorphsKey = "BodyMorphs";
+
+    struct Entry {
+        RE::ActorHandle actor;
+        std::uint32_t formID = 0;
+        std::string key;
+        std::uint64_t seq = 0;  // first-queued order, ties in priority
+
+        // Actor method call
+        const char* functionName = nullptr;
+        std::function<RE::BSScript::IFunctionArguments*()> makeArgs;
+
+        // Body-morph batch (FBMorphBridge.FBApplyMorphs)
+        bool bodyMorphs = false;
+        std::vector<RE::BSFixedString> setNames;
+        std::vector<float> setValues;
+        std::vector<RE::BSFixedString> clearNames;
+    };
+
+    struct InFlight {
+        std::uint64_t ticket = 0;
+        Clock::time_point sentAt{};
+    };
+
+    struct Ready {
+        float priority = 0.0f;
+        std::uint64_t seq = 0;
+        const std::string* slot = nullptr;
+        RE::Actor* actor = nullptr;
+    };
+
+    RE::BSScript::IVirtualMachine* GetVM() {
+        if (auto* skyrimVM = RE::SkyrimVM::GetSingleton(); skyrimVM) {
+            return skyrimVM->impl ? skyrimVM->impl.get() : nullptr;
+        }
+        return nullptr;
+    }
+
+    class GameVirtualMachine final : public FB::Dispatch::IVirtualMachineBackend {
+    public:
+        bool Dispatch(const FB::Dispatch::VmCall& call,
+                      RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>& callback) override {
+            auto* vm = GetVM();
+            if (!vm) {
+                return false;
+            }
+
+            if (!call.isMethod) {
+                return vm->DispatchStaticCall(RE::BSFixedString(call.className), RE::BSFixedString(call.functionName),
+                                              call.args, callback);
+            }
+
+            auto* policy = vm->GetObjectHandlePolicy();
+            if (!policy || !call.actor) {
+                return false;
+            }
+
+            const auto handle = policy->GetHandleForObject(call.actor->GetFormType(), call.actor);
+            if (!handle || handle == policy->EmptyHandle()) {
+                return false;
+            }
+
+            return vm->DispatchMethodCall(handle, RE::BSFixedString("Actor"), RE::BSFixedString(call.functionName),
+                                          call.args, callback);
+        }
+    };
+
+    GameVirtualMachine g_gameVm;
+    FB::Dispatch::IVirtualMachineBackend* g_backend = &g_gameVm;
+
+    // Game thread.
+    std::unordered_map<std::string, Entry> g_pending;      // by slot ("%08X|key")
+    std::unordered_map<std::string, InFlight> g_inFlight;  // by slot
+    std::unordered_map<std::uint64_t, std::string> g_ticketSlots;
+    std::vector<Ready> g_ready;  // reused each pump
+    std::uint64_t g_nextTicket = 1;
+    std::uint64_t g_nextSeq = 1;
+    std::uint32_t g_budget = 8;
+    FB::Dispatch::Stats g_stats;
+
+    // Tickets reported by the VM's threads.
+    std::mutex g_completedMutex;
+    std::vector<std::uint64_t> g_completed;
+    std::vector<std::uint64_t> g_completedScratch;
+
+    // Runs on a VM thread once the call has returned; the game thread retires the ticket.
+    class CompletionFunctor final : public RE::BSScript::IStackCallbackFunctor {
+    public:
+        explicit CompletionFunctor(std::uint64_t ticket) : _ticket(ticket) {}
+
+        void operator()(RE::BSScript::Variable) override {
+            std::lock_guard<std::mutex> lock(g_completedMutex);
+            g_completed.push_back(_ticket);
+        }
+
+        void SetObject(const RE::BSTSmartPointer<RE::BSScript::Object>&) override {}
+
+    private:
+        std::uint64_t _ticket;
+    };
+
+    std::string SlotKey(std::uint32_t formID, std::string_view key) {
+        char buf[12];
+        std::snprintf(buf, sizeof(buf), "%08X|", formID);
+        return std::string(buf) + std::string(key);
+    }
+
+    Entry& PendingFor(RE::Actor* actor, std::string key) {
+        auto [it, inserted] = g_pending.try_emplace(SlotKey(actor->formID, key));
+        Entry& entry = it->second;
+
+        if (inserted) {
+            entry.actor = actor->GetHandle();
+            entry.formID = actor->formID;
+            entry.key = std::move(key);
+            entry.seq = g_nextSeq++;
+        } else {
+            ++g_stats.replaced;
+            FB::Metrics::Add(FB::Metrics::Counter::PapyrusSuppressed);
+        }
+        return entry;
+    }
+
+    void RetireCompleted() {
+        {
+            std::lock_guard<std::mutex> lock(g_completedMutex);
+            g_completedScratch.swap(g_completed);
+        }
+
+        for (const auto ticket : g_completedScratch) {
+            if (auto it = g_ticketSlots.find(ticket); it != g_ticketSlots.end()) {
+                g_inFlight.erase(it->second);
+                g_ticketSlots.erase(it);
+                ++g_stats.completed;
+            }
+        }
+        g_completedScratch.clear();
+
+        const auto now = Clock::now();
+        for (auto it = g_inFlight.begin(); it != g_inFlight.end();) {
+            if (now - it->second.sentAt > kInFlightTimeout) {
+                ++g_stats.timedOut;
+                spdlog::debug("[FB] Dispatch: call timed out slot='{}'", it->first);
+                g_ticketSlots.erase(it->second.ticket);
+                it = g_inFlight.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    float PriorityOf(RE::Actor* actor, const RE::PlayerCharacter* player) {
+        if (!player) {
+            return 0.0f;
+        }
+        if (actor == player) {
+            return -1.0f;
+        }
+
+        const auto p = actor->GetPosition();
+        const auto q = player->GetPosition();
+        const float dx = p.x - q.x;
+        const float dy = p.y - q.y;
+        const float dz = p.z - q.z;
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        return actor->Get3D1(false) ? d2 : kHiddenPenalty + d2;
+    }
+
+    // The entry is dropped without reaching the engine: FB::Morph must not keep suppressing
+    // writes against values it only recorded.
+    void ForgetShadow(const Entry& entry) {
+        if (!entry.bodyMorphs) {
+            FB::Morph::ForgetApplied(entry.formID, entry.key);
+            return;
+        }
+        for (const auto& name : entry.setNames) {
+            FB::Morph::ForgetApplied(entry.formID, name.c_str());
+        }
+        for (const auto& name : entry.clearNames) {
+            FB::Morph::ForgetApplied(entry.formID, name.c_str());
+        }
+    }
+
+    bool Send(const std::string& slot, Entry& entry, RE::Actor* actor) {
+        FB::Dispatch::VmCall call{};
+        call.actor = actor;
+
+        if (entry.bodyMorphs) {
+            // FBMorphBridge.FBApplyMorphs(Actor akActor, String[] setNames, Float[] setValues, String[] clearNames)
+            call.className = FB::Morph::kBridgeClass;
+            call.functionName = FB::Morph::kFnApplyMorphs;
+            // Copied, not moved: a refused call still needs the names to roll the shadow back.
+            call.args = RE::MakeFunctionArguments(static_cast<RE::Actor*>(actor), entry.setNames, entry.setValues,
+                                                  entry.clearNames);
+        } else {
+            call.isMethod = true;
+            call.className = "Actor";
+            call.functionName = entry.functionName;
+            call.args = entry.makeArgs();
+        }
+
+        const std::uint64_t ticket = g_nextTicket++;
+        RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> callback =
+            RE::make_smart<CompletionFunctor>(ticket);
+
+        if (!g_backend->Dispatch(call, callback)) {
+            ++g_stats.rejected;
+            ForgetShadow(entry);
+            spdlog::warn("[FB] Dispatch: VM refused {}.{} actor=0x{:08X}", call.className, call.functionName,
+                         entry.formID);
+            return false;
+        }
+
+        ++g_stats.sent;
+        FB::Metrics::Add(FB::Metrics::Counter::PapyrusSent);
+        g_inFlight[slot] = InFlight{ticket, Clock::now()};
+        g_ticketSlots.emplace(ticket, slot);
+        return true;
+    }
+}
+
+namespace FB::Dispatch {
+    void SetBackend(IVirtualMachineBackend* backend) { g_backend = backend ? backend : &g_gameVm; }
+
+    void EnqueueActorMethod(RE::Actor* actor, std::string key, const char* functionName,
+                            std::function<RE::BSScript::IFunctionArguments*()> makeArgs) {
+        if (!actor || !functionName) {
+            return;
+        }
+
+        Entry& entry = PendingFor(actor, std::move(key));
+        entry.functionName = functionName;
+        entry.makeArgs = std::move(makeArgs);
+    }
+
+    void EnqueueBodyMorphs(RE::Actor* actor, std::span<const RE::BSFixedString> setNames,
+                           std::span<const float> setValues, std::span<const RE::BSFixedString> clearNames) {
+        if (!actor) {
+            return;
+        }
+
+        Entry& entry = PendingFor(actor, kBodyMorphsKey);
+        entry.bodyMorphs = true;
+
+        // Merge into what is still queued: the newest change per morph wins.
+        const auto eraseSet = [&](const RE::BSFixedString& name) {
+            for (std::size_t i = 0; i < entry.setNames.size(); ++i) {
+                if (entry.setNames[i] == name) {
+                    entry.setNames.erase(entry.setNames.begin() + static_cast<std::ptrdiff_t>(i));
+                    entry.setValues.erase(entry.setValues.begin() + static_cast<std::ptrdiff_t>(i));
+                    return;
+                }
+            }
+        };
+
+        for (const auto& name : clearNames) {
+            eraseSet(name);
+            if (std::find(entry.clearNames.begin(), entry.clearNames.end(), name) == entry.clearNames.end()) {
+                entry.clearNames.push_back(name);
+            }
+        }
+
+        for (std::size_t i = 0; i < setNames.size(); ++i) {
+            std::erase(entry.clearNames, setNames[i]);
+            eraseSet(setNames[i]);
+            entry.setNames.push_back(setNames[i]);
+            entry.setValues.push_back(setValues[i]);
+        }
+    }
+
+    void Pump() {
+        RetireCompleted();
+        if (g_pending.empty()) {
+            return;
+        }
+
+        const auto* player = RE::PlayerCharacter::GetSingleton();
+
+        g_ready.clear();
+        for (auto it = g_pending.begin(); it != g_pending.end();) {
+            auto aPtr = it->second.actor.get();
+            RE::Actor* actor = aPtr.get();
+            if (!actor) {
+                ForgetShadow(it->second);
+                it = g_pending.erase(it);  // actor gone; nothing left to apply it to
+                continue;
+            }
+
+            if (!g_inFlight.contains(it->first)) {
+                g_ready.push_back(Ready{PriorityOf(actor, player), it->second.seq, &it->first, actor});
+            }
+            ++it;
+        }
+
+        const std::size_t count = std::min<std::size_t>(g_budget, g_ready.size());
+        std::partial_sort(g_ready.begin(), g_ready.begin() + static_cast<std::ptrdiff_t>(count), g_ready.end(),
+                          [](const Ready& a, const Ready& b) {
+                              return a.priority != b.priority ? a.priority < b.priority : a.seq < b.seq;
+                          });
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto it = g_pending.find(*g_ready[i].slot);
+            Send(it->first, it->second, g_ready[i].actor);
+            g_pending.erase(it);
+        }
+
+        if (g_ready.size() > count) {
+            g_stats.deferred += g_ready.size() - count;
+            spdlog::debug("[FB] Dispatch: budget {} reached, {} calls wait", g_budget, g_ready.size() - count);
+        }
+    }
+
+    bool HasPending() { return !g_pending.empty(); }
+
+    void SetBudget(std::uint32_t callsPerFrame) { g_budget = std::max<std::uint32_t>(callsPerFrame, 1); }
+
+    Stats GetStats() {
+        Stats stats = g_stats;
+        stats.pending = g_pending.size();
+        stats.inFlight = g_inFlight.size();
+        return stats;
+    }
+}
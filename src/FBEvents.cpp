@@ -1,145 +1,409 @@
-#include "FBEvents.h"
-
-#include <spdlog/spdlog.h>
-
-#include "RE/B/BSAnimationGraphEvent.h"
-#include "RE/P/PlayerCharacter.h"
-#include "SKSE/SKSE.h"
-#include "RE/B/BSAnimationGraphManager.h"
-
-
-namespace {
-    class FBAnimEventSink final : public RE::BSTEventSink<RE::BSAnimationGraphEvent> {
-    public:
-        explicit FBAnimEventSink(FBEvents* owner) : _owner(owner) {}
-
-        RE::BSEventNotifyControl ProcessEvent(const RE::BSAnimationGraphEvent* evn,
-                                              RE::BSTEventSource<RE::BSAnimationGraphEvent>*) override {
-            if (evn && _owner) {
-                _owner->HandleAnimEvent(*evn);
-            }
-            return RE::BSEventNotifyControl::kContinue;
-        }
-
-        void SetOwner(FBEvents* owner) { _owner = owner; }
-
-    private:
-        FBEvents* _owner = nullptr;
-    };
-
-    static FBAnimEventSink g_animSink{nullptr};
-}
-
-
-
-
-void FBEvents::OnDataLoaded() {
-    // First safe point where PlayerCharacter may exist
-    TryRegisterToPlayer();
-}
-
-void FBEvents::OnPostLoadOrNewGame() {
-    // Graph is guaranteed to exist here
-    TryRegisterToPlayer();
-}
-
-void FBEvents::TryRegisterToPlayer() {
-    auto* pc = RE::PlayerCharacter::GetSingleton();
-    if (!pc) {
-        return;
-    }
-
-    RE::BSTSmartPointer<RE::BSAnimationGraphManager> manager;
-    if (!pc->GetAnimationGraphManager(manager) || !manager) {
-        spdlog::warn("[FB] AnimEvt: no animation graph manager (yet)");
-        return;
-    }
-
-    g_animSink.SetOwner(this);
-
-    bool attached = false;
-    for (auto& graph : manager->graphs) {
-        if (!graph) {
-            continue;
-        }
-        graph->AddEventSink(&g_animSink);
-        attached = true;
-    }
-
-    if (attached) {
-        if (!_registered.exchange(true)) {
-            spdlog::info("[FB] AnimEvt: registered sinks to player graphs");
-            spdlog::info("[FB] AnimEvt: ready (logAllTags={})", _logAllAnimTags.load());
-
-        }
-    } else {
-        spdlog::warn("[FB] AnimEvt: no graphs on player manager");
-    }
-}
-
-
-void FBEvents::HandleAnimEvent(const RE::BSAnimationGraphEvent& evn) {
-    _sawAnyEvent.store(true);
-
-    const RE::Actor* actor = nullptr;
-    if (auto* holder = evn.holder) {
-        actor = holder->As<RE::Actor>();
-    }
-
-    if (!actor) {
-        if (_logAllAnimTags.load()) {
-            spdlog::info("[FB] AnimEvt: tag='{}' actor=<null>", evn.tag.c_str());
-        }
-        return;
-    }
-
-    if (_logAllAnimTags.load()) {
-        spdlog::info("[FB] AnimEvt: tag='{}' actor=0x{:08X}", evn.tag.c_str(), actor->formID);
-    }
-
-    if (evn.tag == "FBEvent") {
-        FBEvent e{};
-        e.tag = "FBEvent";
-        e.actor.formID = actor->formID;
-        Push(e);
-        spdlog::info("[FB] AnimEvt: queued FBEvent for actor=0x{:08X}", e.actor.formID);
-    } else if (evn.tag == "PairEnd") {
-        FBEvent e{};
-        e.tag = "PairEnd";
-        e.actor.formID = actor->formID;
-        Push(e);
-        spdlog::info("[FB] AnimEvt: queued PairEnd for actor=0x{:08X}", e.actor.formID);
-    }
-}
-
-
-
-void FBEvents::Push(const FBEvent& event) 
-{
-    std::lock_guard<std::mutex> lock(_mutex);
-    _queue.push_back(event);
-}
-
-std::vector<FBEvent> FBEvents::Drain()
-{
-    std::vector<FBEvent> out;
-
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        out.swap(_queue);
-    }
-
-    return out;
-}
-
-void FBEvents::Clear()
-{ 
-    std::lock_guard<std::mutex> lock(_mutex);
-    _queue.clear();
-}
-
-std::size_t FBEvents::Size() const 
-{ 
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _queue.size();
-}
\ No newline at end of file
+#include "FBEvents.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+
+#include "RE/B/BSAnimationGraphEvent.h"
+#include "RE/P/PlayerCharacter.h"
+#include "SKSE/SKSE.h"
+#include "RE/B/BSAnimationGraphManager.h"
+#include "FBConfig.h"
+#include "FBFx.h"
+#include "FBMorph.h"
+#include "FBTags.h"
+
+
+// Animation tags are pooled BSFixedStrings, so a configured tag is recognised by the address of
+// its pooled data: one hash probe per graph event, no string compare.
+struct FBEvents::TagFilter {
+    std::vector<RE::BSFixedString> strings;      // holds the pool entries (and their addresses) alive
+    std::unordered_map<const char*, TagId> ids;  // pooled data -> interned tag id
+};
+
+namespace {
+    class FBAnimEventSink final : public RE::BSTEventSink<RE::BSAnimationGraphEvent> {
+    public:
+        explicit FBAnimEventSink(FBEvents* owner) : _owner(owner) {}
+
+        RE::BSEventNotifyControl ProcessEvent(const RE::BSAnimationGraphEvent* evn,
+                                              RE::BSTEventSource<RE::BSAnimationGraphEvent>*) override {
+            if (evn && _owner) {
+                _owner->HandleAnimEvent(*evn);
+            }
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        void SetOwner(FBEvents* owner) { _owner = owner; }
+
+    private:
+        FBEvents* _owner = nullptr;
+    };
+
+    // 3D load/unload of any reference; drives the per-actor sink registry.
+    class FBObjectLoadedSink final : public RE::BSTEventSink<RE::TESObjectLoadedEvent> {
+    public:
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESObjectLoadedEvent* evn,
+                                              RE::BSTEventSource<RE::TESObjectLoadedEvent>*) override {
+            if (evn && _owner) {
+                _owner->OnObjectLoaded(evn->formID, evn->loaded);
+            }
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        void SetOwner(FBEvents* owner) { _owner = owner; }
+
+    private:
+        FBEvents* _owner = nullptr;
+    };
+
+    static FBAnimEventSink g_animSink{nullptr};
+    static FBObjectLoadedSink g_loadedSink;
+}
+
+
+
+
+void FBEvents::OnDataLoaded() {
+    g_animSink.SetOwner(this);
+    g_loadedSink.SetOwner(this);
+
+    if (auto* holder = RE::ScriptEventSourceHolder::GetSingleton(); holder) {
+        holder->AddEventSink<RE::TESObjectLoadedEvent>(&g_loadedSink);
+        spdlog::info("[FB] AnimEvt: watching actor 3D load/unload");
+    } else {
+        spdlog::warn("[FB] AnimEvt: no script event source; only actors loaded at game load get sinks");
+    }
+
+    // First safe point where PlayerCharacter may exist
+    RegisterLoadedActors();
+}
+
+void FBEvents::OnPostLoadOrNewGame() {
+    // Every graph was rebuilt by the load; start the registry over.
+    _registeredActors.clear();
+    RegisterLoadedActors();
+}
+
+FBEvents::RegisteredActor& FBEvents::FindOrAddRegistration(std::uint32_t formID) {
+    const auto pos = std::lower_bound(_registeredActors.begin(), _registeredActors.end(), formID,
+                                      [](const RegisteredActor& r, std::uint32_t id) { return r.formID < id; });
+    if (pos != _registeredActors.end() && pos->formID == formID) {
+        return *pos;
+    }
+
+    RegisteredActor entry{};
+    entry.formID = formID;
+    return *_registeredActors.insert(pos, std::move(entry));
+}
+
+void FBEvents::EraseRegistration(std::uint32_t formID) {
+    const auto pos = std::lower_bound(_registeredActors.begin(), _registeredActors.end(), formID,
+                                      [](const RegisteredActor& r, std::uint32_t id) { return r.formID < id; });
+    if (pos != _registeredActors.end() && pos->formID == formID) {
+        _registeredActors.erase(pos);
+    }
+}
+
+bool FBEvents::AttachToActor(RE::Actor* actor, RegisteredActor& entry) {
+    RE::BSTSmartPointer<RE::BSAnimationGraphManager> manager;
+    if (!actor->GetAnimationGraphManager(manager) || !manager) {
+        return false;
+    }
+
+    std::vector<const void*> current;
+    current.reserve(manager->graphs.size());
+
+    for (auto& graph : manager->graphs) {
+        if (!graph) {
+            continue;
+        }
+
+        const void* key = graph.get();
+        current.push_back(key);
+
+        // Already ours: adding again would deliver every tag twice.
+        if (std::find(entry.graphs.begin(), entry.graphs.end(), key) != entry.graphs.end()) {
+            ++_duplicateRegistrationsSkipped;
+            continue;
+        }
+
+        // Not tracked (first sight, or tracking was reset by a load): make sure the sink is on
+        // this graph exactly once.
+        graph->RemoveEventSink(&g_animSink);
+        graph->AddEventSink(&g_animSink);
+    }
+
+    entry.graphs = std::move(current);  // drops graphs that were rebuilt away
+    return !entry.graphs.empty();
+}
+
+void FBEvents::DetachFromActor(RE::Actor* actor) {
+    RE::BSTSmartPointer<RE::BSAnimationGraphManager> manager;
+    if (!actor->GetAnimationGraphManager(manager) || !manager) {
+        return;  // graphs already gone with the 3D
+    }
+
+    for (auto& graph : manager->graphs) {
+        if (graph) {
+            graph->RemoveEventSink(&g_animSink);
+        }
+    }
+}
+
+void FBEvents::RegisterLoadedActors() {
+    // The player is attached right away; everyone else goes through the budgeted queue.
+    if (auto* pc = RE::PlayerCharacter::GetSingleton(); pc) {
+        if (AttachToActor(pc, FindOrAddRegistration(pc->formID))) {
+            if (!_registered.exchange(true)) {
+                spdlog::info("[FB] AnimEvt: registered sinks to player graphs");
+                spdlog::info("[FB] AnimEvt: ready (logAllTags={})", _logAllAnimTags.load());
+            }
+        } else {
+            EraseRegistration(pc->formID);
+            spdlog::warn("[FB] AnimEvt: no graphs on player manager (yet)");
+        }
+    }
+
+    auto* lists = RE::ProcessLists::GetSingleton();
+    if (!lists) {
+        return;
+    }
+
+    std::size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(_registrationMutex);
+        for (auto& h : lists->highActorHandles) {
+            auto aPtr = h.get();
+            RE::Actor* a = aPtr.get();
+            if (a && a->Is3DLoaded()) {
+                _pendingRegistrations[a->formID] = true;
+                ++queued;
+            }
+        }
+        _pendingRegistrationCount.store(_pendingRegistrations.size(), std::memory_order_relaxed);
+    }
+
+    spdlog::info("[FB] AnimEvt: queued {} loaded actors for sink registration", queued);
+    if (queued > 0 && _wake) {
+        _wake();
+    }
+}
+
+void FBEvents::OnObjectLoaded(std::uint32_t formID, bool loaded) {
+    auto* form = RE::TESForm::LookupByID(formID);
+    if (!form || !form->As<RE::Actor>()) {
+        return;
+    }
+
+    {
+        // Only the latest state per actor is kept, so a cell transition that loads and unloads
+        // the same actors costs at most one attach or detach each.
+        std::lock_guard<std::mutex> lock(_registrationMutex);
+        _pendingRegistrations[formID] = loaded;
+        _pendingRegistrationCount.store(_pendingRegistrations.size(), std::memory_order_relaxed);
+    }
+
+    if (_wake) {
+        _wake();
+    }
+}
+
+std::size_t FBEvents::ProcessRegistrations() {
+    if (!HasPendingRegistrations()) {
+        return 0;
+    }
+
+    _registrationBatch.clear();
+    {
+        std::lock_guard<std::mutex> lock(_registrationMutex);
+        for (auto it = _pendingRegistrations.begin();
+             it != _pendingRegistrations.end() && _registrationBatch.size() < kMaxRegistrationsPerTick;) {
+            _registrationBatch.emplace_back(it->first, it->second);
+            it = _pendingRegistrations.erase(it);
+        }
+        _pendingRegistrationCount.store(_pendingRegistrations.size(), std::memory_order_relaxed);
+    }
+
+    for (const auto& [formID, wantAttached] : _registrationBatch) {
+        auto* form = RE::TESForm::LookupByID(formID);
+        RE::Actor* actor = form ? form->As<RE::Actor>() : nullptr;
+
+        if (wantAttached && actor && AttachToActor(actor, FindOrAddRegistration(formID))) {
+            continue;
+        }
+
+        if (!wantAttached) {
+            if (actor) {
+                DetachFromActor(actor);
+            }
+            FB::Morph::ForgetExpressions(formID);
+            FB::Fx::ForgetActor(formID);
+        }
+        EraseRegistration(formID);
+    }
+
+    spdlog::debug("[FB] AnimEvt: registrations processed={} registered={} pending={} duplicatesSkipped={}",
+                  _registrationBatch.size(), _registeredActors.size(),
+                  _pendingRegistrationCount.load(std::memory_order_relaxed), _duplicateRegistrationsSkipped);
+    return _registrationBatch.size();
+}
+
+
+void FBEvents::HandleAnimEvent(const RE::BSAnimationGraphEvent& evn) {
+    if (!_sawAnyEvent.load(std::memory_order_relaxed)) {
+        _sawAnyEvent.store(true);
+    }
+
+    const bool logAll = _logAllAnimTags.load(std::memory_order_relaxed);
+
+    // Every loaded actor's graph feeds this sink; reject unconfigured tags before anything else.
+    TagId tag = FB::Tags::kNone;
+    if (const auto filter = _tagFilter.load(std::memory_order_acquire); filter) {
+        if (const auto it = filter->ids.find(evn.tag.data()); it != filter->ids.end()) {
+            tag = it->second;
+        }
+    }
+    if (tag == FB::Tags::kNone && !logAll) {
+        return;
+    }
+
+    const RE::Actor* actor = nullptr;
+    if (auto* holder = evn.holder) {
+        actor = holder->As<RE::Actor>();
+    }
+
+    if (!actor) {
+        if (logAll) {
+            spdlog::info("[FB] AnimEvt: tag='{}' actor=<null>", evn.tag.c_str());
+        }
+        return;
+    }
+
+    if (logAll) {
+        spdlog::info("[FB] AnimEvt: tag='{}' actor=0x{:08X}", evn.tag.c_str(), actor->formID);
+    }
+
+    if (tag == FB::Tags::kNone) {
+        return;
+    }
+
+    FBEvent e{};
+    e.tag = tag;
+    e.actor.formID = actor->formID;
+    e.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    if (Push(e)) {
+        spdlog::info("[FB] AnimEvt: queued {} for actor=0x{:08X}", FB::Tags::Name(tag), e.actor.formID);
+    }
+}
+
+
+
+void FBEvents::RebuildTagFilter(const Snapshot& snap) {
+    auto filter = std::make_shared<TagFilter>();
+    filter->strings.reserve(snap.eventMap.size());
+
+    for (const auto& [name, scriptKey] : snap.eventMap) {
+        const TagId id = FB::Tags::Intern(name);
+        if (id == FB::Tags::kNone) {
+            continue;
+        }
+
+        RE::BSFixedString pooled(name.c_str());
+        filter->ids.emplace(pooled.data(), id);
+        filter->strings.push_back(std::move(pooled));
+    }
+
+    spdlog::info("[FB] AnimEvt: tag filter gen={} tags={}", snap.generation, filter->ids.size());
+    _tagFilter.store(std::move(filter), std::memory_order_release);
+}
+
+FBEvents::FBEvents() {
+    for (std::size_t i = 0; i < kCapacity; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+void FBEvents::SetWakeHandler(WakeFn wake) { _wake = std::move(wake); }
+
+bool FBEvents::Push(const FBEvent& event) 
+{
+    auto pos = _enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        auto& cell = _cells[pos & kMask];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            // Claim the slot; on failure `pos` is reloaded and we retry.
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.event = event;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring full: the consumer has not freed this slot yet.
+            const auto dropped = _dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (dropped == 1 || (dropped % 256) == 0) {
+                spdlog::warn("[FB] Events: queue full ({}), dropped tag='{}' actor=0x{:08X} (dropped total={})",
+                             kCapacity, FB::Tags::Name(event.tag), event.actor.formID, dropped);
+            }
+            return false;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (_wake) {
+        _wake();
+    }
+    return true;
+}
+
+std::size_t FBEvents::Drain(std::vector<FBEvent>& out)
+{
+    out.clear();
+
+    // Papyrus DrainEvents can race the update tick; keep the ring single-consumer.
+    if (_draining.test_and_set(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    auto pos = _dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        auto& cell = _cells[pos & kMask];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+
+        // Empty, or the producer that claimed this slot has not finished writing it yet.
+        if (static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1) < 0) {
+            break;
+        }
+
+        out.push_back(cell.event);
+        cell.sequence.store(pos + kCapacity, std::memory_order_release);
+        ++pos;
+    }
+
+    _dequeuePos.store(pos, std::memory_order_release);
+    _draining.clear(std::memory_order_release);
+
+    return out.size();
+}
+
+void FBEvents::Clear()
+{ 
+    std::vector<FBEvent> discarded;
+    Drain(discarded);
+}
+
+std::size_t FBEvents::Size() const 
+{ 
+    const auto tail = _dequeuePos.load(std::memory_order_acquire);
+    const auto head = _enqueuePos.load(std::memory_order_acquire);
+    return head > tail ? head - tail : 0;
+}
@@ -1 +1,296 @@
-#include "FBFx.h"
\ No newline at end of file
+#include "FBFx.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FBMetrics.h"
+
+namespace {
+    class GameAudioBackend final : public FB::Fx::IAudioBackend {
+    public:
+        const char* Name() const override { return "Game"; }
+
+        std::uint64_t Start(RE::Actor* actor, RE::BGSSoundDescriptorForm* sound) override {
+            auto* audio = RE::BSAudioManager::GetSingleton();
+            if (!audio) {
+                return 0;
+            }
+
+            RE::BSSoundHandle handle;
+            if (!audio->BuildSoundDataFromDescriptor(handle, sound) || !handle.IsValid()) {
+                return 0;
+            }
+
+            // Follow the actor so the descriptor's 3D attenuation tracks them.
+            handle.SetPosition(actor->GetPosition());
+            handle.SetObjectToFollow(actor->Get3D());
+            if (!handle.Play()) {
+                return 0;
+            }
+
+            const std::uint64_t voice = _nextVoice++;
+            _handles.emplace(voice, handle);
+            return voice;
+        }
+
+        void Stop(std::uint64_t voice) override {
+            if (auto it = _handles.find(voice); it != _handles.end()) {
+                it->second.Stop();
+                _handles.erase(it);
+            }
+        }
+
+        bool IsPlaying(std::uint64_t voice) override {
+            auto it = _handles.find(voice);
+            if (it == _handles.end()) {
+                return false;
+            }
+            if (!it->second.IsPlaying()) {
+                _handles.erase(it);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::unordered_map<std::uint64_t, RE::BSSoundHandle> _handles;
+        std::uint64_t _nextVoice = 1;
+    };
+
+    class GameVisualBackend final : public FB::Fx::IVisualBackend {
+    public:
+        const char* Name() const override { return "Game"; }
+
+        std::uint64_t Attach(RE::Actor* actor, RE::TESForm* effect, std::string_view node, float duration) override {
+            RE::NiAVObject* attachNode = nullptr;
+            if (!node.empty()) {
+                auto* root = actor->Get3D();
+                FB::Metrics::Add(FB::Metrics::Counter::NodeLookups);
+                attachNode = root ? root->GetObjectByName(RE::BSFixedString(node)) : nullptr;
+                if (!attachNode) {
+                    spdlog::debug("[FB] Fx: node '{}' not found actor=0x{:08X}", node, actor->formID);
+                    return 0;
+                }
+            }
+
+            RE::ReferenceEffect* instance = nullptr;
+            if (auto* shader = effect->As<RE::TESEffectShader>(); shader) {
+                instance = actor->ApplyEffectShader(shader, duration, nullptr, false, false, attachNode);
+            } else if (auto* art = effect->As<RE::BGSArtObject>(); art) {
+                instance = actor->ApplyArtObject(art, duration, nullptr, false, false, attachNode);
+            }
+            if (!instance) {
+                return 0;
+            }
+
+            const std::uint64_t id = _nextInstance++;
+            _instances.emplace(id, RE::NiPointer<RE::ReferenceEffect>(instance));
+            return id;
+        }
+
+        bool Refresh(std::uint64_t instance, float duration) override {
+            auto it = _instances.find(instance);
+            if (it == _instances.end()) {
+                return false;
+            }
+            if (it->second->finished) {
+                _instances.erase(it);
+                return false;
+            }
+
+            it->second->lifetime = duration;
+            it->second->age = 0.0f;
+            return true;
+        }
+
+        void Detach(std::uint64_t instance) override {
+            if (auto it = _instances.find(instance); it != _instances.end()) {
+                // The engine removes finished effects on its next update.
+                it->second->finished = true;
+                _instances.erase(it);
+            }
+        }
+
+    private:
+        // Held by reference so a finished effect cannot be freed under us.
+        std::unordered_map<std::uint64_t, RE::NiPointer<RE::ReferenceEffect>> _instances;
+        std::uint64_t _nextInstance = 1;
+    };
+
+    struct Voice {
+        std::uint64_t id = 0;
+        std::uint64_t startedSeq = 0;  // play order; the lowest is stolen first
+    };
+
+    struct Visual {
+        RE::TESForm* effect = nullptr;
+        std::string node;
+        std::uint64_t instance = 0;
+        std::uint64_t source = 0;  // timeline that attached or last refreshed it
+    };
+
+    GameAudioBackend g_gameAudio;
+    FB::Fx::IAudioBackend* g_audio = &g_gameAudio;
+    GameVisualBackend g_gameVisuals;
+    FB::Fx::IVisualBackend* g_visualBackend = &g_gameVisuals;
+
+    // Game thread.
+    std::unordered_map<std::uint32_t, std::vector<Voice>> g_voices;  // by actor form ID
+    std::uint32_t g_voicesPerActor = 4;
+    std::uint64_t g_playSeq = 0;
+    FB::Fx::AudioStats g_audioStats;
+
+    std::unordered_map<std::uint32_t, std::vector<Visual>> g_visuals;  // by actor form ID
+    FB::Fx::VisualStats g_visualStats;
+}
+
+namespace FB::Fx {
+    void SetAudioBackend(IAudioBackend* backend) {
+        g_voices.clear();  // voice ids belong to the previous backend
+        g_audio = backend ? backend : &g_gameAudio;
+    }
+
+    void SetVoicesPerActor(std::uint32_t voices) { g_voicesPerActor = std::max<std::uint32_t>(voices, 1); }
+
+    bool Play_MainThread(RE::Actor* actor, RE::BGSSoundDescriptorForm* sound) {
+        if (!actor || !sound) {
+            return false;
+        }
+
+        auto& pool = g_voices[actor->formID];
+        std::erase_if(pool, [](const Voice& v) { return !g_audio->IsPlaying(v.id); });
+
+        if (pool.size() >= g_voicesPerActor) {
+            const auto oldest = std::min_element(pool.begin(), pool.end(), [](const Voice& a, const Voice& b) {
+                return a.startedSeq < b.startedSeq;
+            });
+            g_audio->Stop(oldest->id);
+            pool.erase(oldest);
+            ++g_audioStats.stops;
+            ++g_audioStats.steals;
+
+            spdlog::debug("[FB] Fx: voice limit {} reached actor=0x{:08X}; stole oldest", g_voicesPerActor,
+                          actor->formID);
+        }
+
+        const std::uint64_t id = g_audio->Start(actor, sound);
+        if (id == 0) {
+            ++g_audioStats.failed;
+            spdlog::warn("[FB] Fx: sound 0x{:08X} did not start actor=0x{:08X}", sound->GetFormID(), actor->formID);
+            return false;
+        }
+
+        pool.push_back(Voice{id, ++g_playSeq});
+        ++g_audioStats.starts;
+
+        spdlog::info("[FB] Fx: play sound 0x{:08X} actor=0x{:08X} voices={}", sound->GetFormID(), actor->formID,
+                     pool.size());
+        return true;
+    }
+
+    void SetVisualBackend(IVisualBackend* backend) {
+        g_visuals.clear();  // instance ids belong to the previous backend
+        g_visualBackend = backend ? backend : &g_gameVisuals;
+    }
+
+    bool Show_MainThread(RE::Actor* actor, RE::TESForm* effect, std::string_view node, float duration,
+                         std::uint64_t source) {
+        if (!actor || !effect) {
+            return false;
+        }
+
+        auto& visuals = g_visuals[actor->formID];
+        const auto it = std::find_if(visuals.begin(), visuals.end(),
+                                     [&](const Visual& v) { return v.effect == effect && v.node == node; });
+
+        if (it != visuals.end()) {
+            if (g_visualBackend->Refresh(it->instance, duration)) {
+                it->source = source;
+                ++g_visualStats.refreshes;
+                spdlog::debug("[FB] Fx: refresh effect 0x{:08X} actor=0x{:08X} node='{}'", effect->GetFormID(),
+                              actor->formID, node);
+                return true;
+            }
+            visuals.erase(it);  // finished on its own; attach a new one
+        }
+
+        const std::uint64_t instance = g_visualBackend->Attach(actor, effect, node, duration);
+        if (instance == 0) {
+            ++g_visualStats.failed;
+            spdlog::warn("[FB] Fx: effect 0x{:08X} did not attach actor=0x{:08X} node='{}'", effect->GetFormID(),
+                         actor->formID, node);
+            return false;
+        }
+
+        visuals.push_back(Visual{effect, std::string(node), instance, source});
+        ++g_visualStats.attaches;
+
+        spdlog::info("[FB] Fx: attach effect 0x{:08X} actor=0x{:08X} node='{}' duration={}", effect->GetFormID(),
+                     actor->formID, node, duration);
+        return true;
+    }
+
+    void DetachSource(std::uint64_t source) {
+        std::size_t detached = 0;
+
+        for (auto it = g_visuals.begin(); it != g_visuals.end();) {
+            auto& visuals = it->second;
+            const auto owned = std::stable_partition(visuals.begin(), visuals.end(),
+                                                     [&](const Visual& v) { return v.source != source; });
+            for (auto v = owned; v != visuals.end(); ++v) {
+                g_visualBackend->Detach(v->instance);
+                ++detached;
+            }
+            visuals.erase(owned, visuals.end());
+
+            it = visuals.empty() ? g_visuals.erase(it) : std::next(it);
+        }
+
+        if (detached > 0) {
+            g_visualStats.detaches += detached;
+            spdlog::info("[FB] Fx: detached {} effects of timeline {}", detached, source);
+        }
+    }
+
+    void ForgetActor(std::uint32_t formID) {
+        if (const auto it = g_voices.find(formID); it != g_voices.end()) {
+            for (const auto& voice : it->second) {
+                if (g_audio->IsPlaying(voice.id)) {
+                    g_audio->Stop(voice.id);
+                    ++g_audioStats.stops;
+                }
+            }
+            g_voices.erase(it);
+        }
+
+        if (const auto it = g_visuals.find(formID); it != g_visuals.end()) {
+            for (const auto& visual : it->second) {
+                g_visualBackend->Detach(visual.instance);
+            }
+            g_visualStats.detaches += it->second.size();
+            g_visuals.erase(it);
+        }
+    }
+
+    AudioStats GetAudioStats() {
+        AudioStats stats = g_audioStats;
+        stats.voices = 0;
+        for (const auto& [formID, pool] : g_voices) {
+            stats.voices += pool.size();
+        }
+        return stats;
+    }
+
+    VisualStats GetVisualStats() {
+        VisualStats stats = g_visualStats;
+        stats.attached = 0;
+        for (const auto& [formID, visuals] : g_visuals) {
+            stats.attached += visuals.size();
+        }
+        return stats;
+    }
+}
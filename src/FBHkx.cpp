@@ -0,0 +1,586 @@
+#include "FBHkx.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    constexpr std::uint32_t kPackfileMagic0 = 0x57E0E057;
+    constexpr std::uint32_t kPackfileMagic1 = 0x10C0C010;
+    constexpr std::uint32_t kTagfileMagic0 = 0xCAB00D1E;
+    constexpr std::uint32_t kTagfileMagic1 = 0xD011FACE;
+
+    constexpr std::size_t kFileHeaderSize = 64;
+    constexpr std::uint32_t kNoFixup = 0xFFFFFFFF;
+
+    // Corrupt counts must not turn into huge loops.
+    constexpr std::uint32_t kMaxTracks = 1024;
+    constexpr std::uint32_t kMaxAnnotationsPerTrack = 65536;
+    constexpr std::uint32_t kMaxCachedAnnotations = kMaxTracks * kMaxAnnotationsPerTrack;
+
+    constexpr std::uint32_t kCacheMagic = 0x43414246;  // "FBAC"
+    constexpr std::uint32_t kCacheVersion = 1;
+
+    // Read-only view of a whole file.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        bool Open(const std::filesystem::path& path) {
+#ifdef _WIN32
+            _file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (_file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER size{};
+            if (!::GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+                return false;
+            }
+
+            _mapping = ::CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!_mapping) {
+                return false;
+            }
+
+            _data = static_cast<const std::byte*>(::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+            _size = static_cast<std::size_t>(size.QuadPart);
+#else
+            _fd = ::open(path.c_str(), O_RDONLY);
+            if (_fd < 0) {
+                return false;
+            }
+
+            struct stat st{};
+            if (::fstat(_fd, &st) != 0 || st.st_size == 0) {
+                return false;
+            }
+
+            void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (view == MAP_FAILED) {
+                return false;
+            }
+
+            _data = static_cast<const std::byte*>(view);
+            _size = static_cast<std::size_t>(st.st_size);
+#endif
+            return _data != nullptr;
+        }
+
+        std::span<const std::byte> Bytes() const { return {_data, _data ? _size : 0}; }
+
+    private:
+        void Close() {
+#ifdef _WIN32
+            if (_data) {
+                ::UnmapViewOfFile(_data);
+            }
+            if (_mapping) {
+                ::CloseHandle(_mapping);
+            }
+            if (_file != INVALID_HANDLE_VALUE) {
+                ::CloseHandle(_file);
+            }
+#else
+            if (_data) {
+                ::munmap(const_cast<std::byte*>(_data), _size);
+            }
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+#endif
+            _data = nullptr;
+        }
+
+#ifdef _WIN32
+        HANDLE _file = INVALID_HANDLE_VALUE;
+        HANDLE _mapping = nullptr;
+#else
+        int _fd = -1;
+#endif
+        const std::byte* _data = nullptr;
+        std::size_t _size = 0;
+    };
+
+    // Bounds-checked little-endian reads.
+    class ByteView {
+    public:
+        ByteView() = default;
+        explicit ByteView(std::span<const std::byte> bytes) : _bytes(bytes) {}
+
+        std::size_t Size() const { return _bytes.size(); }
+        ByteView Sub(std::size_t offset, std::size_t size) const {
+            if (offset > _bytes.size() || size > _bytes.size() - offset) {
+                return ByteView{};
+            }
+            return ByteView(_bytes.subspan(offset, size));
+        }
+
+        std::optional<std::uint32_t> U32(std::size_t offset) const {
+            if (offset > _bytes.size() || _bytes.size() - offset < 4) {
+                return std::nullopt;
+            }
+            const auto* p = reinterpret_cast<const std::uint8_t*>(_bytes.data() + offset);
+            return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+                   (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+        }
+
+        std::optional<float> F32(std::size_t offset) const {
+            const auto bits = U32(offset);
+            if (!bits) {
+                return std::nullopt;
+            }
+            float value;
+            std::memcpy(&value, &*bits, sizeof(value));
+            return value;
+        }
+
+        std::uint8_t U8(std::size_t offset) const {
+            return offset < _bytes.size() ? static_cast<std::uint8_t>(_bytes[offset]) : 0;
+        }
+
+        // NUL-terminated string starting at `offset`; empty if it runs off the end.
+        std::string_view CString(std::size_t offset) const {
+            if (offset >= _bytes.size()) {
+                return {};
+            }
+            const auto* begin = reinterpret_cast<const char*>(_bytes.data() + offset);
+            const auto* end = static_cast<const char*>(std::memchr(begin, 0, _bytes.size() - offset));
+            return end ? std::string_view(begin, static_cast<std::size_t>(end - begin)) : std::string_view{};
+        }
+
+    private:
+        std::span<const std::byte> _bytes;
+    };
+
+    struct Section {
+        std::string_view tag;
+        ByteView data;  // object data
+        ByteView localFixups;
+        ByteView virtualFixups;
+    };
+
+    // Object layout of hkaAnimation and its annotation records (hk_2010), by pointer size.
+    struct Layout {
+        std::size_t ptr = 8;
+        std::size_t annotationTracks = 40;  // hkaAnimation::m_annotationTracks
+        std::size_t trackSize = 24;         // hkaAnnotationTrack { hkStringPtr name; hkArray annotations; }
+        std::size_t annotationSize = 16;    // hkaAnnotationTrack::Annotation { hkReal time; hkStringPtr text; }
+        std::size_t annotationText = 8;
+
+        static Layout ForPointerSize(std::size_t ptr) {
+            if (ptr == 4) {
+                return Layout{4, 28, 16, 8, 4};
+            }
+            return Layout{};
+        }
+    };
+
+    bool IsFBAnnotation(std::string_view text) {
+        if (text.rfind("2_", 0) == 0) {
+            text.remove_prefix(2);
+        }
+        return text.rfind("FB", 0) == 0;
+    }
+
+    bool IsAnimationClass(std::string_view name) {
+        // hkaSplineCompressedAnimation, hkaInterleavedUncompressedAnimation, ...
+        return name.rfind("hka", 0) == 0 && name.size() > 9 && name.substr(name.size() - 9) == "Animation";
+    }
+
+    // Pointer fields inside the data section are resolved through its local fixups.
+    class Fixups {
+    public:
+        explicit Fixups(const ByteView& table) {
+            for (std::size_t off = 0; off + 8 <= table.Size(); off += 8) {
+                const auto src = *table.U32(off);
+                if (src != kNoFixup) {
+                    _pairs.emplace_back(src, *table.U32(off + 4));
+                }
+            }
+            std::sort(_pairs.begin(), _pairs.end());
+        }
+
+        std::optional<std::uint32_t> Target(std::size_t field) const {
+            const auto it = std::lower_bound(_pairs.begin(), _pairs.end(),
+                                             std::make_pair(static_cast<std::uint32_t>(field), std::uint32_t{0}));
+            if (it == _pairs.end() || it->first != field) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+    private:
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> _pairs;
+    };
+
+    void ReadAnimation(const ByteView& data, const Fixups& fixups, const Layout& layout, std::size_t object,
+                       std::vector<FB::Hkx::Annotation>& out) {
+        const std::size_t tracksField = object + layout.annotationTracks;
+        const auto tracks = fixups.Target(tracksField);
+        const auto trackCount = data.U32(tracksField + layout.ptr);
+        if (!tracks || !trackCount || *trackCount > kMaxTracks) {
+            return;
+        }
+
+        for (std::uint32_t t = 0; t < *trackCount; ++t) {
+            const std::size_t annotationsField = *tracks + t * layout.trackSize + layout.ptr;
+            const auto annotations = fixups.Target(annotationsField);
+            const auto count = data.U32(annotationsField + layout.ptr);
+            if (!annotations || !count || *count > kMaxAnnotationsPerTrack) {
+                continue;
+            }
+
+            for (std::uint32_t a = 0; a < *count; ++a) {
+                const std::size_t record = *annotations + a * layout.annotationSize;
+                const auto time = data.F32(record);
+                const auto text = fixups.Target(record + layout.annotationText);
+                if (!time || !text) {
+                    continue;
+                }
+
+                const auto view = data.CString(*text);
+                if (IsFBAnnotation(view)) {
+                    out.push_back(FB::Hkx::Annotation{*time, std::string(view)});
+                }
+            }
+        }
+    }
+
+    std::uint64_t HashBytes(std::span<const std::byte> bytes) {
+        std::uint64_t hash = 14695981039346656037ull;  // FNV-1a
+        for (const auto b : bytes) {
+            hash = (hash ^ static_cast<std::uint8_t>(b)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    struct CacheEntry {
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+        std::uint64_t hash = 0;
+        bool valid = false;  // parsed as a packfile
+        bool used = false;   // read since the cache was loaded; only these are saved
+        std::vector<FB::Hkx::Annotation> annotations;
+    };
+
+    struct Cache {
+        std::mutex mutex;
+        std::filesystem::path path = std::filesystem::path("Data") / "SKSE" / "Plugins" /
+                                     "FullBodiedAnnotations.cache";
+        bool loaded = false;
+        bool dirty = false;
+        std::unordered_map<std::string, CacheEntry> entries;  // by generic path
+        FB::Hkx::Stats stats;
+    };
+
+    Cache& GetCache() {
+        static Cache cache;
+        return cache;
+    }
+
+    template <class T>
+    bool ReadPod(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <class T>
+    void WritePod(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    bool ReadString(std::istream& in, std::string& s) {
+        std::uint32_t size = 0;
+        if (!ReadPod(in, size) || size > (1u << 20)) {
+            return false;
+        }
+        s.resize(size);
+        return static_cast<bool>(in.read(s.data(), size));
+    }
+
+    void WriteString(std::ostream& out, std::string_view s) {
+        WritePod(out, static_cast<std::uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    // Per entry: path, size, mtime, hash, valid flag and annotations. Published only if every
+    // entry reads back.
+    void LoadEntriesLocked(Cache& cache, std::istream& in, std::uint32_t count) {
+        std::unordered_map<std::string, CacheEntry> entries;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::string key;
+            CacheEntry entry{};
+            std::uint8_t valid = 0;
+            std::uint32_t annotations = 0;
+            if (!ReadString(in, key) || !ReadPod(in, entry.size) || !ReadPod(in, entry.mtime) ||
+                !ReadPod(in, entry.hash) || !ReadPod(in, valid) || !ReadPod(in, annotations)) {
+                spdlog::warn("[FB] Hkx: cache '{}' is truncated; rebuilding", cache.path.string());
+                return;
+            }
+            if (annotations > kMaxCachedAnnotations) {
+                spdlog::warn("[FB] Hkx: cache '{}' is corrupt; rebuilding", cache.path.string());
+                return;
+            }
+
+            // Grown as records are read, so a count past the end of the file fails on the read.
+            entry.valid = valid != 0;
+            entry.annotations.reserve(std::min<std::uint32_t>(annotations, 256));
+            for (std::uint32_t a = 0; a < annotations; ++a) {
+                auto& annotation = entry.annotations.emplace_back();
+                if (!ReadPod(in, annotation.time) || !ReadString(in, annotation.text)) {
+                    spdlog::warn("[FB] Hkx: cache '{}' is truncated; rebuilding", cache.path.string());
+                    return;
+                }
+            }
+            entries.emplace(std::move(key), std::move(entry));
+        }
+
+        cache.entries = std::move(entries);
+        spdlog::info("[FB] Hkx: loaded cache '{}' ({} files)", cache.path.string(), cache.entries.size());
+    }
+
+    // Cache file: magic, version, entry count, then the entries. Anything unexpected discards the
+    // whole file; the files are parsed again and the cache rewritten on the next save.
+    void LoadLocked(Cache& cache) {
+        cache.loaded = true;
+
+        std::ifstream in(cache.path, std::ios::binary);
+        if (!in.good()) {
+            return;
+        }
+
+        std::uint32_t magic = 0, version = 0, count = 0;
+        if (!ReadPod(in, magic) || !ReadPod(in, version) || !ReadPod(in, count) || magic != kCacheMagic ||
+            version != kCacheVersion) {
+            spdlog::info("[FB] Hkx: cache '{}' is from another version; rebuilding", cache.path.string());
+            return;
+        }
+
+        try {
+            LoadEntriesLocked(cache, in, count);
+        } catch (const std::exception& ex) {
+            cache.entries.clear();
+            spdlog::warn("[FB] Hkx: cache '{}' is unreadable ({}); rebuilding", cache.path.string(), ex.what());
+        }
+    }
+
+    std::int64_t MTimeOf(const std::filesystem::path& file, std::error_code& ec) {
+        return static_cast<std::int64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+    }
+}
+
+namespace FB::Hkx {
+    bool ParseAnnotations(std::span<const std::byte> image, std::vector<Annotation>& out) {
+        const ByteView file(image);
+        const auto magic0 = file.U32(0);
+        const auto magic1 = file.U32(4);
+        if (!magic0 || !magic1) {
+            return false;
+        }
+        if (*magic0 == kTagfileMagic0 && *magic1 == kTagfileMagic1) {
+            spdlog::warn("[FB] Hkx: binary tagfiles are not supported; convert the clip to a packfile");
+            return false;
+        }
+        if (*magic0 != kPackfileMagic0 || *magic1 != kPackfileMagic1 || file.Size() < kFileHeaderSize) {
+            return false;
+        }
+
+        const std::uint32_t fileVersion = *file.U32(12);
+        const std::size_t pointerSize = file.U8(16);
+        const bool littleEndian = file.U8(17) != 0;
+        const std::uint32_t numSections = *file.U32(20);
+        if (!littleEndian || (pointerSize != 4 && pointerSize != 8) || numSections > 16) {
+            return false;
+        }
+
+        // hk_2012+ (version 11) appends a predicate array and pads its section headers.
+        std::size_t sectionsAt = kFileHeaderSize;
+        std::size_t sectionHeaderSize = 48;
+        if (fileVersion >= 11) {
+            sectionsAt += (file.U8(62) | (file.U8(63) << 8));
+            sectionHeaderSize = 64;
+        }
+
+        std::vector<Section> sections;
+        for (std::uint32_t i = 0; i < numSections; ++i) {
+            const std::size_t header = sectionsAt + i * sectionHeaderSize;
+            const auto start = file.U32(header + 20);
+            const auto localFixups = file.U32(header + 24);
+            const auto globalFixups = file.U32(header + 28);
+            const auto virtualFixups = file.U32(header + 32);
+            const auto exports = file.U32(header + 36);
+            if (!start || !localFixups || !globalFixups || !virtualFixups || !exports ||
+                *localFixups > *globalFixups || *virtualFixups > *exports) {
+                return false;
+            }
+
+            Section section;
+            section.tag = file.CString(header);
+            section.data = file.Sub(*start, *localFixups);
+            section.localFixups = file.Sub(*start + *localFixups, *globalFixups - *localFixups);
+            section.virtualFixups = file.Sub(*start + *virtualFixups, *exports - *virtualFixups);
+            sections.push_back(section);
+        }
+
+        const auto data = std::find_if(sections.begin(), sections.end(),
+                                       [](const Section& s) { return s.tag == "__data__"; });
+        if (data == sections.end()) {
+            return false;
+        }
+
+        const Fixups fixups(data->localFixups);
+        const Layout layout = Layout::ForPointerSize(pointerSize);
+
+        // Virtual fixups name the class of every object in the section.
+        const auto& objects = data->virtualFixups;
+        for (std::size_t off = 0; off + 12 <= objects.Size(); off += 12) {
+            const auto object = *objects.U32(off);
+            const auto classSection = *objects.U32(off + 4);
+            const auto className = *objects.U32(off + 8);
+            if (object == kNoFixup || classSection >= sections.size()) {
+                continue;
+            }
+
+            if (IsAnimationClass(sections[classSection].data.CString(className))) {
+                ReadAnimation(data->data, fixups, layout, object, out);
+            }
+        }
+        return true;
+    }
+
+    bool GetAnnotations(const std::filesystem::path& file, std::vector<Annotation>& out) {
+        auto& cache = GetCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.loaded) {
+            LoadLocked(cache);
+        }
+
+        std::error_code ec;
+        const auto size = static_cast<std::uint64_t>(std::filesystem::file_size(file, ec));
+        const auto mtime = ec ? 0 : MTimeOf(file, ec);
+        if (ec) {
+            ++cache.stats.failed;
+            return false;
+        }
+
+        auto [it, inserted] = cache.entries.try_emplace(file.generic_string());
+        auto& entry = it->second;
+
+        const auto use = [&]() {
+            entry.used = true;
+            out.insert(out.end(), entry.annotations.begin(), entry.annotations.end());
+            cache.stats.annotations += entry.annotations.size();
+            return entry.valid;
+        };
+
+        if (!inserted && entry.size == size && entry.mtime == mtime) {
+            ++cache.stats.hits;
+            return use();
+        }
+
+        MappedFile mapped;
+        if (!mapped.Open(file)) {
+            ++cache.stats.failed;
+            spdlog::warn("[FB] Hkx: cannot map '{}'", file.string());
+            cache.entries.erase(it);
+            return false;
+        }
+
+        const auto hash = HashBytes(mapped.Bytes());
+        cache.dirty = true;
+        if (!inserted && entry.size == size && entry.hash == hash) {
+            entry.mtime = mtime;
+            ++cache.stats.hashHits;
+            return use();
+        }
+
+        entry.size = size;
+        entry.mtime = mtime;
+        entry.hash = hash;
+        entry.annotations.clear();
+        entry.valid = ParseAnnotations(mapped.Bytes(), entry.annotations);
+        if (entry.valid) {
+            ++cache.stats.parsed;
+        } else {
+            ++cache.stats.failed;
+        }
+
+        spdlog::info("[FB] Hkx: parsed '{}' valid={} annotations={}", file.string(), entry.valid,
+                     entry.annotations.size());
+        return use();
+    }
+
+    void SetCachePath(std::filesystem::path path) {
+        auto& cache = GetCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.path = std::move(path);
+        cache.entries.clear();
+        cache.loaded = false;
+        cache.dirty = false;
+    }
+
+    void SaveCache() {
+        auto& cache = GetCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+
+        const bool dropped = std::any_of(cache.entries.begin(), cache.entries.end(),
+                                         [](const auto& kv) { return !kv.second.used; });
+        if (!cache.dirty && !dropped) {
+            return;
+        }
+        std::erase_if(cache.entries, [](const auto& kv) { return !kv.second.used; });
+
+        std::ofstream out(cache.path, std::ios::binary | std::ios::trunc);
+        if (!out.good()) {
+            spdlog::warn("[FB] Hkx: cannot write cache '{}'", cache.path.string());
+            return;
+        }
+
+        WritePod(out, kCacheMagic);
+        WritePod(out, kCacheVersion);
+        WritePod(out, static_cast<std::uint32_t>(cache.entries.size()));
+        for (const auto& [key, entry] : cache.entries) {
+            WriteString(out, key);
+            WritePod(out, entry.size);
+            WritePod(out, entry.mtime);
+            WritePod(out, entry.hash);
+            WritePod(out, static_cast<std::uint8_t>(entry.valid ? 1 : 0));
+            WritePod(out, static_cast<std::uint32_t>(entry.annotations.size()));
+            for (const auto& annotation : entry.annotations) {
+                WritePod(out, annotation.time);
+                WriteString(out, annotation.text);
+            }
+        }
+
+        cache.dirty = false;
+        spdlog::info("[FB] Hkx: saved cache '{}' ({} files)", cache.path.string(), cache.entries.size());
+    }
+
+    Stats GetStats() {
+        auto& cache = GetCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        return cache.stats;
+    }
+}
@@ -0,0 +1,70 @@
+#include "FBIntegrationDevourment.h"
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "FBTags.h"
+#include "FBTriggers.h"
+
+namespace {
+    constexpr std::int32_t kLocusStomach = 0;
+
+    std::atomic<FBTriggers*> g_triggers{nullptr};
+    TagId g_keySwallowSuccessStomach = FB::Tags::kNone;  // written once by Initialize
+}
+
+namespace FB::Devourment {
+    void Initialize(FBTriggers& triggers) {
+        g_keySwallowSuccessStomach = FB::Tags::Intern("SwallowSuccess_Stomach");
+        g_triggers.store(&triggers, std::memory_order_release);
+
+        spdlog::info("[FB][DVT] Devourment adapter initialized");
+    }
+
+    bool IsSupportedFirstPassCase(const SwallowPayload& payload) {
+        return !payload.endo && payload.locus == kLocusStomach;
+    }
+
+    bool OnSwallow(const SwallowPayload& payload) {
+        spdlog::info("[FB][DVT] onSwallow pred=0x{:08X} prey=0x{:08X} endo={} locus={}", payload.predator,
+                     payload.prey, payload.endo, payload.locus);
+
+        auto* triggers = g_triggers.load(std::memory_order_acquire);
+        if (!triggers) {
+            spdlog::warn("[FB][DVT] onSwallow before Initialize; ignored");
+            return false;
+        }
+
+        if (payload.predator == 0 || payload.prey == 0 || payload.predator == payload.prey) {
+            spdlog::warn("[FB][DVT] onSwallow ignored: need two distinct actors");
+            return false;
+        }
+
+        if (!IsSupportedFirstPassCase(payload)) {
+            spdlog::info("[FB][DVT] onSwallow ignored: unsupported case endo={} locus={}", payload.endo,
+                         payload.locus);
+            return false;
+        }
+
+        FBTrigger trigger{};
+        trigger.source = FBTriggerSource::Devourment;
+        trigger.kind = FBTriggerKind::VoreSwallowSuccess;
+        trigger.key = g_keySwallowSuccessStomach;
+        trigger.actorA.formID = payload.predator;
+        trigger.actorB.formID = payload.prey;
+        trigger.success = true;
+        trigger.endo = payload.endo;
+        trigger.locus = payload.locus;
+        trigger.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        if (!triggers->Push(trigger)) {
+            return false;
+        }
+
+        spdlog::info("[FB][DVT] trigger queued key='{}' pred=0x{:08X} prey=0x{:08X}", FB::Tags::Name(trigger.key),
+                     payload.predator, payload.prey);
+        return true;
+    }
+}
@@ -0,0 +1,123 @@
+#include "FBMetrics.h"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+    // Bucket i counts durations below 2^i microseconds; the last bucket takes everything longer.
+    constexpr std::size_t kBucketCount = 18;  // up to ~131ms
+
+    struct Histogram {
+        std::array<std::atomic<std::uint64_t>, kBucketCount> buckets{};
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> totalMicros{0};
+        std::atomic<std::uint64_t> maxMicros{0};
+
+        void Record(std::chrono::steady_clock::duration duration) noexcept {
+            const auto micros =
+                static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+            const auto bucket = std::min<std::size_t>(std::bit_width(micros), kBucketCount - 1);
+
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            totalMicros.fetch_add(micros, std::memory_order_relaxed);
+
+            auto seen = maxMicros.load(std::memory_order_relaxed);
+            while (micros > seen && !maxMicros.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Upper bound (microseconds) of the bucket holding the given fraction of samples.
+        std::uint64_t Percentile(double fraction, std::uint64_t total) const noexcept {
+            const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i + 1 < kBucketCount; ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen > rank) {
+                    return std::uint64_t{1} << i;
+                }
+            }
+            return maxMicros.load(std::memory_order_relaxed);
+        }
+
+        void Format(fmt::memory_buffer& out, const char* name) const {
+            const auto n = count.load(std::memory_order_relaxed);
+            if (n == 0) {
+                fmt::format_to(std::back_inserter(out), "{}: none\n", name);
+                return;
+            }
+
+            fmt::format_to(std::back_inserter(out), "{}: n={} avg={}us p50<={}us p99<={}us max={}us\n", name, n,
+                           totalMicros.load(std::memory_order_relaxed) / n, Percentile(0.50, n), Percentile(0.99, n),
+                           maxMicros.load(std::memory_order_relaxed));
+
+            fmt::format_to(std::back_inserter(out), "{} histogram:", name);
+            for (std::size_t i = 0; i < kBucketCount; ++i) {
+                if (const auto b = buckets[i].load(std::memory_order_relaxed); b > 0) {
+                    if (i + 1 < kBucketCount) {
+                        fmt::format_to(std::back_inserter(out), " <{}us={}", std::uint64_t{1} << i, b);
+                    } else {
+                        fmt::format_to(std::back_inserter(out), " >={}us={}", std::uint64_t{1} << (i - 1), b);
+                    }
+                }
+            }
+            fmt::format_to(std::back_inserter(out), "\n");
+        }
+    };
+
+    Histogram g_ticks;
+    Histogram g_snapshotBuilds;
+}
+
+namespace FB::Metrics {
+    std::uint64_t Get(Counter counter) noexcept {
+        return detail::g_counters[static_cast<std::size_t>(counter)].value.load(std::memory_order_relaxed);
+    }
+
+    const char* Name(Counter counter) noexcept {
+        switch (counter) {
+            case Counter::EventsDrained:
+                return "eventsDrained";
+            case Counter::TriggersDrained:
+                return "triggersDrained";
+            case Counter::CommandsFired:
+                return "commandsFired";
+            case Counter::TweensEvaluated:
+                return "tweensEvaluated";
+            case Counter::NodeLookups:
+                return "nodeLookups";
+            case Counter::TasksQueued:
+                return "tasksQueued";
+            case Counter::PapyrusSent:
+                return "papyrusSent";
+            case Counter::PapyrusSuppressed:
+                return "papyrusSuppressed";
+            case Counter::kCount:
+                break;
+        }
+        return "?";
+    }
+
+    void RecordTick(std::chrono::steady_clock::duration duration) noexcept { g_ticks.Record(duration); }
+
+    void RecordSnapshotBuild(std::chrono::steady_clock::duration duration) noexcept {
+        g_snapshotBuilds.Record(duration);
+    }
+
+    std::string Format() {
+        fmt::memory_buffer out;
+
+        fmt::format_to(std::back_inserter(out), "counters:");
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Counter::kCount); ++i) {
+            const auto counter = static_cast<Counter>(i);
+            fmt::format_to(std::back_inserter(out), " {}={}", Name(counter), Get(counter));
+        }
+        fmt::format_to(std::back_inserter(out), "\n");
+
+        g_ticks.Format(out, "tick");
+        g_snapshotBuilds.Format(out, "snapshot build");
+        return fmt::to_string(out);
+    }
+}
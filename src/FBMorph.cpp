@@ -1,235 +1,571 @@
-#include "FBMorph.h"
-#include "FBMaps.h"
-
-#include <RE/Skyrim.h>
-#include <RE/F/FunctionArguments.h>
-#include <RE/S/SkyrimVM.h>
-#include <SKSE/SKSE.h>
-
-#include <spdlog/spdlog.h>
-#include <string>
-#include <string_view>
-#include <cmath>
-
-
-namespace
-{
-    static RE::BSScript::IVirtualMachine* GetVM() {
-        if (auto* skyrimVM = RE::SkyrimVM::GetSingleton(); skyrimVM) {
-            return skyrimVM->impl ? skyrimVM->impl.get() : nullptr;
-        }
-        return nullptr;
-    }
-
-    static float Normalize01(float v) {
-        // Allow authoring 0..1 or 0..100
-        if (v > 1.0f) {
-            v /= 100.0f;
-        }
-        return std::clamp(v, 0.0f, 1.0f);
-    }
-
-    static std::int32_t NormalizeStrength100(float v) {
-        // Allow 0..1 or 0..100
-        if (v <= 1.0f) {
-            v *= 100.0f;
-        }
-        auto i = static_cast<std::int32_t>(std::lround(v));
-        return std::clamp(i, 0, 100);
-    }
-
-    static bool DispatchActorMethod2(RE::Actor* actor, const char* fnName, RE::BSScript::IFunctionArguments* args) {
-        if (!actor || !fnName) {
-            return false;
-        }
-
-        auto* vm = GetVM();
-        if (!vm) {
-            return false;
-        }
-
-        auto* policy = vm->GetObjectHandlePolicy();
-        if (!policy) {
-            return false;
-        }
-
-        const auto handle = policy->GetHandleForObject(actor->GetFormType(), actor);
-        if (!handle || handle == policy->EmptyHandle()) {
-            return false;
-        }
-
-        RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> result{};
-        return vm->DispatchMethodCall(handle, RE::BSFixedString("Actor"), RE::BSFixedString(fnName), args, result);
-    }
-
-    static bool Actor_SetExpressionPhoneme(RE::Actor* actor, std::int32_t idx, float value01) {
-        auto* args = RE::MakeFunctionArguments(static_cast<std::int32_t>(idx), static_cast<float>(value01));
-        return DispatchActorMethod2(actor, "SetExpressionPhoneme", args);
-    }
-
-    static bool Actor_SetExpressionModifier(RE::Actor* actor, std::int32_t idx, float value01) {
-        auto* args = RE::MakeFunctionArguments(static_cast<std::int32_t>(idx), static_cast<float>(value01));
-        return DispatchActorMethod2(actor, "SetExpressionModifier", args);
-    }
-
-    static bool Actor_SetExpressionOverride(RE::Actor* actor, std::int32_t moodId, std::int32_t strength) {
-        auto* args = RE::MakeFunctionArguments(static_cast<std::int32_t>(moodId), static_cast<std::int32_t>(strength));
-        return DispatchActorMethod2(actor, "SetExpressionOverride", args);
-    }
-
-
-
-     static void Papyrus_SetMorph(RE::Actor* actor, const char* morphName, float value) {
-        if (!actor || !morphName) {
-            return;
-        }
-
-        auto* vm = GetVM();
-        if (!vm) {
-            spdlog::warn("[FB] Morph: VM not available; SetMorph skipped");
-            return;
-        }
-
-        spdlog::info("[FB] Morph: dispatch {}.{} actor=0x{:08X} morph='{}' value={}", FB::Morph::kBridgeClass,
-                     FB::Morph::kFnSetMorph, actor->formID, morphName, value);
-
-        RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> result{};
-
-        // FBMorphBridge.FBSetMorph(Actor akActor, String morphName, Float value)
-        auto* args = RE::MakeFunctionArguments(static_cast<RE::Actor*>(actor), RE::BSFixedString(morphName),
-                                               static_cast<float>(value));
-
-        const bool ok = vm->DispatchStaticCall(RE::BSFixedString(FB::Morph::kBridgeClass),
-                                               RE::BSFixedString(FB::Morph::kFnSetMorph), args, result);
-
-        spdlog::debug("[FB] MorphBridgeCall: {}.{} ok={} morph='{}' value={}", FB::Morph::kBridgeClass,
-                      FB::Morph::kFnSetMorph, ok, morphName, value);
-     }
-
-    static void Papyrus_ClearMorph(RE::Actor* actor, const char* morphName) {
-        if (!actor || !morphName) {
-            return;
-        }
-
-        auto* vm = GetVM();
-        if (!vm) {
-            spdlog::warn("[FB] Morph: VM not available; ClearMorph skipped");
-            return;
-        }
-
-        RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> result{};
-
-        auto* args = RE::MakeFunctionArguments(static_cast<RE::Actor*>(actor), RE::BSFixedString(morphName));
-
-        spdlog::info("[FB] Morph: dispatch {}.{} actor=0x{:08X} morph='{}'", FB::Morph::kBridgeClass,
-                     FB::Morph::kFnClear, actor->formID, morphName);
-
-        const bool ok = vm->DispatchStaticCall(RE::BSFixedString(FB::Morph::kBridgeClass),
-                                               RE::BSFixedString(FB::Morph::kFnClear), args, result);
-
-        spdlog::info("[FB] Morph: dispatch returned ok={}", ok);
-    }
-}
-
-namespace FB::Morph {
-    void Set(RE::Actor* actor, std::string_view morphName, float value) {
-        if (!actor || morphName.empty()) {
-            return;
-        }
-
-        // 1) Resolve aliases (pass-through if not found)
-        const auto resolved = FB::Maps::ResolveMorph(morphName);
-
-        // 2) Expression routing (phoneme / modifier / mood)
-        if (auto idx = FB::Maps::TryGetPhonemeIndex(resolved); idx) {
-            const float v01 = Normalize01(value);
-            Actor_SetExpressionPhoneme(actor, *idx, v01);
-            spdlog::info("[FB] Morph: expression phoneme '{}' idx={} value01={}", resolved, *idx, v01);
-            return;
-        }
-
-        if (auto midx = FB::Maps::TryGetModifierIndex(resolved); midx) {
-            const float v01 = Normalize01(value);
-            Actor_SetExpressionModifier(actor, *midx, v01);
-            spdlog::info("[FB] Morph: expression modifier '{}' idx={} value01={}", resolved, *midx, v01);
-            return;
-        }
-
-        if (auto mood = FB::Maps::TryGetMoodId(resolved); mood) {
-            const auto strength = NormalizeStrength100(value);
-            Actor_SetExpressionOverride(actor, *mood, strength);
-            spdlog::info("[FB] Morph: expression mood '{}' id={} strength={}", resolved, *mood, strength);
-            return;
-        }
-
-        // 3) Otherwise treat as RaceMenu morph name
-        std::string nameCopy(resolved);
-        Papyrus_SetMorph(actor, nameCopy.c_str(), value);
-    }
-
-
-    void Clear_MainThread(RE::Actor* actor, std::string_view morphName) {
-        if (!actor || morphName.empty()) {
-            return;
-        }
-
-        const auto resolved = FB::Maps::ResolveMorph(morphName);
-
-        // Expressions: set back to neutral
-        if (auto idx = FB::Maps::TryGetPhonemeIndex(resolved); idx) {
-            Actor_SetExpressionPhoneme(actor, *idx, 0.0f);
-            return;
-        }
-
-        if (auto midx = FB::Maps::TryGetModifierIndex(resolved); midx) {
-            Actor_SetExpressionModifier(actor, *midx, 0.0f);
-            return;
-        }
-
-        if (auto mood = FB::Maps::TryGetMoodId(resolved); mood) {
-            // neutralize mood; safest is set strength 0 on Neutral
-            Actor_SetExpressionOverride(actor, 7, 0);
-            return;
-        }
-
-        // RaceMenu morph
-        std::string nameCopy(resolved);
-        Papyrus_ClearMorph(actor, nameCopy.c_str());
-    }
-
-
-    void Clear(RE::Actor* actor, std::string_view morphName) {
-
-            Clear_MainThread(actor, morphName);
-        }
-    //    if (!actor || morphName.empty()) {
-     //       return;
-      //  }
-
-    //    auto* task = SKSE::GetTaskInterface();
-     //   if (!task) {
-      //      spdlog::warn("[FB] Morph.Clear: task interface missing");
-    //        return;
-    //    }
-
-   //     const RE::ActorHandle handle = actor->CreateRefHandle();
-   //     const std::string nameCopy(morphName);
-
-   //     task->AddTask([handle, nameCopy]() {
-    //        auto aPtr = handle.get();
-     //       auto* a = aPtr.get();
-    //        if (!a) {
-     //           spdlog::info("[FB] Morph.Clear(task): actor handle resolved to null");
-    //            return;
-    //        }
-
-            // extra safety: actor might unload between queue and execution
-  //          if (!a->Get3D1(false)) {
-  //              spdlog::info("[FB] Morph.Clear(task): skip (3D not loaded) actor=0x{:08X}", a->formID);
-     //           return;
-   //         }
-
-  //          Clear_MainThread(a, nameCopy);
-  //      });
- //   }
-}
+#include "FBMorph.h"
+#include "FBDispatch.h"
+#include "FBMaps.h"
+#include "FBMetrics.h"
+#include "FBSkee.h"
+
+#include <RE/Skyrim.h>
+#include <RE/F/FunctionArguments.h>
+#include <SKSE/SKSE.h>
+
+#include <spdlog/spdlog.h>
+#include <string>
+#include <string_view>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace
+{
+    static float Normalize01(float v) {
+        // Allow authoring 0..1 or 0..100
+        if (v > 1.0f) {
+            v /= 100.0f;
+        }
+        return std::clamp(v, 0.0f, 1.0f);
+    }
+
+    static std::int32_t NormalizeStrength100(float v) {
+        // Allow 0..1 or 0..100
+        if (v <= 1.0f) {
+            v *= 100.0f;
+        }
+        auto i = static_cast<std::int32_t>(std::lround(v));
+        return std::clamp(i, 0, 100);
+    }
+
+    // Papyrus expression calls go through the dispatch scheduler, one slot per phoneme / modifier /
+    // mood, keyed like the shadow table.
+    static void Actor_SetExpressionPhoneme(RE::Actor* actor, std::int32_t idx, float value01) {
+        FB::Dispatch::EnqueueActorMethod(actor, "#P" + std::to_string(idx), "SetExpressionPhoneme", [idx, value01]() {
+            return RE::MakeFunctionArguments(static_cast<std::int32_t>(idx), static_cast<float>(value01));
+        });
+    }
+
+    static void Actor_SetExpressionModifier(RE::Actor* actor, std::int32_t idx, float value01) {
+        FB::Dispatch::EnqueueActorMethod(actor, "#M" + std::to_string(idx), "SetExpressionModifier", [idx, value01]() {
+            return RE::MakeFunctionArguments(static_cast<std::int32_t>(idx), static_cast<float>(value01));
+        });
+    }
+
+    static void Actor_SetExpressionOverride(RE::Actor* actor, std::int32_t moodId, std::int32_t strength) {
+        FB::Dispatch::EnqueueActorMethod(actor, "#Mood", "SetExpressionOverride", [moodId, strength]() {
+            return RE::MakeFunctionArguments(static_cast<std::int32_t>(moodId), static_cast<std::int32_t>(strength));
+        });
+    }
+
+
+
+    using ExpressionWrite = FB::Morph::ExpressionWrite;
+
+    // Pending body-morph and expression changes of one actor for this frame.
+    struct MorphBatch {
+        RE::ActorHandle actor;
+        std::uint32_t formID = 0;
+        std::vector<RE::BSFixedString> setNames;
+        std::vector<float> setValues;
+        std::vector<RE::BSFixedString> clearNames;
+        std::vector<ExpressionWrite> expressions;
+    };
+
+    // Few actors per frame; a flat list beats a map here and keeps its capacity between frames.
+    std::vector<MorphBatch> g_batches;
+    std::size_t g_batchCount = 0;
+
+    static MorphBatch& BatchFor(RE::Actor* actor) {
+        for (std::size_t i = 0; i < g_batchCount; ++i) {
+            if (g_batches[i].formID == actor->formID) {
+                return g_batches[i];
+            }
+        }
+
+        if (g_batchCount == g_batches.size()) {
+            g_batches.emplace_back();
+        }
+
+        auto& batch = g_batches[g_batchCount++];
+        batch.actor = actor->GetHandle();
+        batch.formID = actor->formID;
+        batch.setNames.clear();
+        batch.setValues.clear();
+        batch.clearNames.clear();
+        batch.expressions.clear();
+        return batch;
+    }
+
+    static void EraseName(std::vector<RE::BSFixedString>& names, const RE::BSFixedString& name,
+                          std::vector<float>* values) {
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) {
+                names.erase(names.begin() + static_cast<std::ptrdiff_t>(i));
+                if (values) {
+                    values->erase(values->begin() + static_cast<std::ptrdiff_t>(i));
+                }
+                return;
+            }
+        }
+    }
+
+    static void QueueSetMorph(RE::Actor* actor, std::string_view morphName, float value) {
+        auto& batch = BatchFor(actor);
+        const RE::BSFixedString name(morphName);
+
+        EraseName(batch.clearNames, name, nullptr);
+        for (std::size_t i = 0; i < batch.setNames.size(); ++i) {
+            if (batch.setNames[i] == name) {
+                batch.setValues[i] = value;
+                return;
+            }
+        }
+        batch.setNames.push_back(name);
+        batch.setValues.push_back(value);
+    }
+
+    static void QueueClearMorph(RE::Actor* actor, std::string_view morphName) {
+        auto& batch = BatchFor(actor);
+        const RE::BSFixedString name(morphName);
+
+        EraseName(batch.setNames, name, &batch.setValues);
+        for (const auto& n : batch.clearNames) {
+            if (n == name) {
+                return;
+            }
+        }
+        batch.clearNames.push_back(name);
+    }
+
+    // Later write to the same slot replaces the earlier one; there is a single mood slot.
+    static void QueueExpression(RE::Actor* actor, ExpressionWrite write) {
+        auto& batch = BatchFor(actor);
+
+        for (auto& queued : batch.expressions) {
+            const bool sameSlot = queued.kind == write.kind &&
+                                  (write.kind == ExpressionWrite::Kind::Mood || queued.index == write.index);
+            if (sameSlot) {
+                queued = write;
+                return;
+            }
+        }
+        batch.expressions.push_back(write);
+    }
+
+    // Actor.SetExpressionPhoneme / SetExpressionModifier / SetExpressionOverride through the
+    // dispatch scheduler.
+    class PapyrusExpressionSink final : public FB::Morph::IExpressionSink {
+    public:
+        const char* Name() const override { return "Papyrus"; }
+
+        void Submit(RE::Actor* actor, std::span<const ExpressionWrite> writes) override {
+            for (const auto& write : writes) {
+                switch (write.kind) {
+                    case ExpressionWrite::Kind::Phoneme:
+                        Actor_SetExpressionPhoneme(actor, write.index, write.value);
+                        break;
+                    case ExpressionWrite::Kind::Modifier:
+                        Actor_SetExpressionModifier(actor, write.index, write.value);
+                        break;
+                    case ExpressionWrite::Kind::Mood:
+                        Actor_SetExpressionOverride(actor, write.index,
+                                                    static_cast<std::int32_t>(std::lround(write.value * 100.0f)));
+                        break;
+                }
+            }
+        }
+    };
+
+    // Writes the keyframes the game's SetExpression* natives write, under the face data lock,
+    // on the game thread. Actors without face data (no head loaded) go to `fallback`.
+    class NativeExpressionSink final : public FB::Morph::IExpressionSink {
+    public:
+        explicit NativeExpressionSink(FB::Morph::IExpressionSink& fallback) : _fallback(fallback) {}
+
+        const char* Name() const override { return "Native"; }
+
+        void Submit(RE::Actor* actor, std::span<const ExpressionWrite> writes) override {
+            auto* face = actor->GetFaceGenAnimationData();
+            if (!face) {
+                spdlog::debug("[FB] Morph: no face data actor=0x{:08X}; {} expression writes via {}", actor->formID,
+                              writes.size(), _fallback.Name());
+                _fallback.Submit(actor, writes);
+                return;
+            }
+
+            RE::BSSpinLockGuard locker(face->lock);
+            for (const auto& write : writes) {
+                switch (write.kind) {
+                    case ExpressionWrite::Kind::Phoneme:
+                        SetKeyframe(face->phoneme2, write.index, write.value);
+                        break;
+                    case ExpressionWrite::Kind::Modifier:
+                        SetKeyframe(face->modifier2, write.index, write.value);
+                        break;
+                    case ExpressionWrite::Kind::Mood:
+                        // The override flag blocks SetExpressionOverride itself; raise it again
+                        // so the game's own expression AI leaves the mood alone.
+                        face->exprOverride = false;
+                        face->SetExpressionOverride(static_cast<std::uint32_t>(write.index), write.value);
+                        face->exprOverride = true;
+                        break;
+                }
+            }
+        }
+
+    private:
+        static void SetKeyframe(RE::BSFaceGenKeyframeMultiple& keyframe, std::int32_t index, float value) {
+            if (index < 0 || static_cast<std::uint32_t>(index) >= keyframe.count) {
+                return;
+            }
+            keyframe.values[index] = std::clamp(value, 0.0f, 1.0f);
+            keyframe.isUpdated = false;
+        }
+
+        FB::Morph::IExpressionSink& _fallback;
+    };
+
+    // FBMorphBridge.FBApplyMorphs through the Papyrus VM: always available, but pays VM
+    // scheduling and argument boxing, and runs a frame or more later. Sent by the dispatch
+    // scheduler, which merges batches queued behind one still in flight.
+    class PapyrusBodyMorphSink final : public FB::Morph::IBodyMorphSink {
+    public:
+        const char* Name() const override { return "Papyrus"; }
+
+        void Submit(RE::Actor* actor, std::span<const RE::BSFixedString> setNames, std::span<const float> setValues,
+                    std::span<const RE::BSFixedString> clearNames) override {
+            spdlog::info("[FB] Morph: queue {}.{} actor=0x{:08X} sets={} clears={}", FB::Morph::kBridgeClass,
+                         FB::Morph::kFnApplyMorphs, actor->formID, setNames.size(), clearNames.size());
+
+            FB::Dispatch::EnqueueBodyMorphs(actor, setNames, setValues, clearNames);
+        }
+    };
+
+    // RaceMenu's IBodyMorphInterface called directly on the game thread (same calls NiOverride's
+    // natives make, minus the VM round trip).
+    class SkeeBodyMorphSink final : public FB::Morph::IBodyMorphSink {
+    public:
+        explicit SkeeBodyMorphSink(SKEE::IBodyMorphInterface* morphs) : _morphs(morphs) {}
+
+        const char* Name() const override { return "SKEE"; }
+
+        void Submit(RE::Actor* actor, std::span<const RE::BSFixedString> setNames, std::span<const float> setValues,
+                    std::span<const RE::BSFixedString> clearNames) override {
+            for (const auto& name : clearNames) {
+                _morphs->ClearMorph(actor, name.c_str(), FB::Morph::kMorphKey);
+            }
+            for (std::size_t i = 0; i < setNames.size(); ++i) {
+                _morphs->SetMorph(actor, setNames[i].c_str(), FB::Morph::kMorphKey, setValues[i]);
+            }
+
+            _morphs->ApplyBodyMorphs(actor, true);
+            _morphs->UpdateModelWeight(actor, false);
+
+            spdlog::debug("[FB] Morph: SKEE apply actor=0x{:08X} sets={} clears={}", actor->formID, setNames.size(),
+                          clearNames.size());
+        }
+
+    private:
+        SKEE::IBodyMorphInterface* _morphs;
+    };
+
+    // Last value applied per morph / expression slot of an actor. Keys are the resolved body-morph
+    // name, "#P<idx>" / "#M<idx>" for phonemes and modifiers, and "#Mood" for the single mood slot
+    // (`mood` holds its id). Written on the game thread between evaluation passes only.
+    struct ShadowValue {
+        float value = 0.0f;
+        std::int32_t mood = -1;
+    };
+
+    std::unordered_map<std::uint32_t, std::unordered_map<std::string, ShadowValue>> g_shadow;
+    float g_epsilon = 0.001f;
+    std::uint64_t g_sent = 0;
+    std::uint64_t g_suppressed = 0;
+
+    std::string ExpressionKey(std::string_view resolved) {
+        if (auto idx = FB::Maps::TryGetPhonemeIndex(resolved); idx) {
+            return "#P" + std::to_string(*idx);
+        }
+        if (auto midx = FB::Maps::TryGetModifierIndex(resolved); midx) {
+            return "#M" + std::to_string(*midx);
+        }
+        if (FB::Maps::TryGetMoodId(resolved)) {
+            return "#Mood";
+        }
+        return std::string(resolved);
+    }
+
+    // Shadow key of a queued expression write (matches ExpressionKey and the dispatch keys).
+    std::string ExpressionSlotKey(const ExpressionWrite& write) {
+        switch (write.kind) {
+            case ExpressionWrite::Kind::Phoneme:
+                return "#P" + std::to_string(write.index);
+            case ExpressionWrite::Kind::Modifier:
+                return "#M" + std::to_string(write.index);
+            default:
+                return "#Mood";
+        }
+    }
+
+    // Records `value` as applied; false (and counted as suppressed) when it is already there.
+    // A write recorded here that is later dropped before the engine sees it is rolled back
+    // through FB::Morph::ForgetApplied.
+    bool ShouldSend(std::uint32_t formID, std::string key, float value, std::int32_t mood, bool force) {
+        auto [it, inserted] = g_shadow[formID].try_emplace(std::move(key));
+        auto& shadow = it->second;
+
+        if (!inserted && !force && shadow.mood == mood && std::fabs(shadow.value - value) <= g_epsilon) {
+            ++g_suppressed;
+            FB::Metrics::Add(FB::Metrics::Counter::PapyrusSuppressed);
+            return false;
+        }
+
+        shadow.value = value;
+        shadow.mood = mood;
+        ++g_sent;
+        return true;
+    }
+
+    PapyrusExpressionSink g_papyrusExpressions;
+    NativeExpressionSink g_nativeExpressions{g_papyrusExpressions};
+    FB::Morph::IExpressionSink* g_expressionBackend = &g_nativeExpressions;
+    FB::Morph::IExpressionSink* g_expressionOverride = nullptr;
+
+    PapyrusBodyMorphSink g_papyrusSink;
+    std::unique_ptr<SkeeBodyMorphSink> g_skeeSink;
+    FB::Morph::IBodyMorphSink* g_backend = &g_papyrusSink;
+    FB::Morph::IBodyMorphSink* g_sink = &g_papyrusSink;
+}
+
+namespace FB::Morph {
+    void Set(RE::Actor* actor, std::string_view morphName, float value, bool force) {
+        if (!actor || morphName.empty()) {
+            return;
+        }
+
+        // 1) Resolve aliases (pass-through if not found)
+        const auto resolved = FB::Maps::ResolveMorph(morphName);
+
+        // 2) Expression routing (phoneme / modifier / mood)
+        if (auto idx = FB::Maps::TryGetPhonemeIndex(resolved); idx) {
+            if (!ShouldSend(actor->formID, "#P" + std::to_string(*idx), value, -1, force)) {
+                return;
+            }
+            const float v01 = Normalize01(value);
+            QueueExpression(actor, {ExpressionWrite::Kind::Phoneme, *idx, v01});
+            spdlog::info("[FB] Morph: expression phoneme '{}' idx={} value01={}", resolved, *idx, v01);
+            return;
+        }
+
+        if (auto midx = FB::Maps::TryGetModifierIndex(resolved); midx) {
+            if (!ShouldSend(actor->formID, "#M" + std::to_string(*midx), value, -1, force)) {
+                return;
+            }
+            const float v01 = Normalize01(value);
+            QueueExpression(actor, {ExpressionWrite::Kind::Modifier, *midx, v01});
+            spdlog::info("[FB] Morph: expression modifier '{}' idx={} value01={}", resolved, *midx, v01);
+            return;
+        }
+
+        if (auto mood = FB::Maps::TryGetMoodId(resolved); mood) {
+            if (!ShouldSend(actor->formID, "#Mood", value, *mood, force)) {
+                return;
+            }
+            const auto strength = NormalizeStrength100(value);
+            QueueExpression(actor, {ExpressionWrite::Kind::Mood, *mood, static_cast<float>(strength) / 100.0f});
+            spdlog::info("[FB] Morph: expression mood '{}' id={} strength={}", resolved, *mood, strength);
+            return;
+        }
+
+        // 3) Otherwise treat as RaceMenu morph name (sent with the actor's batch)
+        if (ShouldSend(actor->formID, std::string(resolved), value, -1, force)) {
+            QueueSetMorph(actor, resolved, value);
+        }
+    }
+
+
+    void Clear_MainThread(RE::Actor* actor, std::string_view morphName) {
+        if (!actor || morphName.empty()) {
+            return;
+        }
+
+        const auto resolved = FB::Maps::ResolveMorph(morphName);
+
+        // Only clear what is not already neutral. A slot we never wrote has an unknown engine
+        // value, so it is cleared (ShouldSend records it as new).
+        constexpr std::int32_t kNeutralMood = 7;
+        const bool isMood = FB::Maps::TryGetMoodId(resolved).has_value();
+        if (!ShouldSend(actor->formID, ExpressionKey(resolved), 0.0f, isMood ? kNeutralMood : -1, false)) {
+            return;
+        }
+
+        // Expressions: set back to neutral
+        if (auto idx = FB::Maps::TryGetPhonemeIndex(resolved); idx) {
+            QueueExpression(actor, {ExpressionWrite::Kind::Phoneme, *idx, 0.0f});
+            return;
+        }
+
+        if (auto midx = FB::Maps::TryGetModifierIndex(resolved); midx) {
+            QueueExpression(actor, {ExpressionWrite::Kind::Modifier, *midx, 0.0f});
+            return;
+        }
+
+        if (isMood) {
+            // neutralize mood; safest is set strength 0 on Neutral
+            QueueExpression(actor, {ExpressionWrite::Kind::Mood, kNeutralMood, 0.0f});
+            return;
+        }
+
+        // RaceMenu morph
+        QueueClearMorph(actor, resolved);
+    }
+
+    void Flush_MainThread() {
+        for (std::size_t i = 0; i < g_batchCount; ++i) {
+            const auto& batch = g_batches[i];
+
+            auto aPtr = batch.actor.get();
+            RE::Actor* actor = aPtr.get();
+            if (!actor) {
+                spdlog::debug("[FB] Morph: batch dropped (actor gone) actor=0x{:08X}", batch.formID);
+                for (const auto& name : batch.setNames) {
+                    ForgetApplied(batch.formID, name.c_str());
+                }
+                for (const auto& name : batch.clearNames) {
+                    ForgetApplied(batch.formID, name.c_str());
+                }
+                for (const auto& write : batch.expressions) {
+                    ForgetApplied(batch.formID, ExpressionSlotKey(write));
+                }
+                continue;
+            }
+
+            if (!batch.setNames.empty() || !batch.clearNames.empty()) {
+                g_sink->Submit(actor, batch.setNames, batch.setValues, batch.clearNames);
+            }
+            if (!batch.expressions.empty()) {
+                (g_expressionOverride ? g_expressionOverride : g_expressionBackend)->Submit(actor, batch.expressions);
+            }
+        }
+
+        g_batchCount = 0;
+    }
+
+    void InitBackend() {
+        SKEE::InterfaceExchangeMessage message{};
+        if (auto* messaging = SKSE::GetMessagingInterface(); messaging) {
+            messaging->Dispatch(SKEE::InterfaceExchangeMessage::kExchangeInterface, &message,
+                                sizeof(SKEE::InterfaceExchangeMessage*), "SKEE");
+        }
+
+        // A sink installed through SetSink() stays; otherwise follow the backend.
+        const bool followBackend = g_sink == g_backend;
+
+        auto* found = message.interfaceMap ? message.interfaceMap->QueryInterface("BodyMorph") : nullptr;
+        if (found) {
+            g_skeeSink = std::make_unique<SkeeBodyMorphSink>(static_cast<SKEE::IBodyMorphInterface*>(found));
+            g_backend = g_skeeSink.get();
+            spdlog::info("[FB] Morph: backend SKEE (BodyMorph interface v{})", found->GetVersion());
+        } else {
+            g_backend = &g_papyrusSink;
+            spdlog::info("[FB] Morph: backend Papyrus ({} not available)",
+                         message.interfaceMap ? "BodyMorph interface" : "SKEE interface exchange");
+        }
+
+        if (followBackend) {
+            g_sink = g_backend;
+        }
+    }
+
+    void SetEpsilon(float epsilon) { g_epsilon = std::max(epsilon, 0.0f); }
+
+    std::optional<float> GetApplied(std::uint32_t formID, std::string_view morphName) {
+        const auto actorIt = g_shadow.find(formID);
+        if (actorIt == g_shadow.end()) {
+            return std::nullopt;
+        }
+
+        const auto it = actorIt->second.find(ExpressionKey(FB::Maps::ResolveMorph(morphName)));
+        if (it == actorIt->second.end()) {
+            return std::nullopt;
+        }
+        return it->second.value;
+    }
+
+    void ForgetExpressions(std::uint32_t formID) {
+        const auto actorIt = g_shadow.find(formID);
+        if (actorIt == g_shadow.end()) {
+            return;
+        }
+
+        std::erase_if(actorIt->second, [](const auto& entry) { return entry.first.starts_with('#'); });
+        if (actorIt->second.empty()) {
+            g_shadow.erase(actorIt);
+        }
+    }
+
+    void ForgetApplied(std::uint32_t formID, std::string_view slotKey) {
+        const auto actorIt = g_shadow.find(formID);
+        if (actorIt == g_shadow.end()) {
+            return;
+        }
+
+        actorIt->second.erase(std::string(slotKey));
+        if (actorIt->second.empty()) {
+            g_shadow.erase(actorIt);
+        }
+    }
+
+    std::uint64_t SentCount() { return g_sent; }
+    std::uint64_t SuppressedCount() { return g_suppressed; }
+
+    void SetSink(IBodyMorphSink* sink) { g_sink = sink ? sink : g_backend; }
+
+    const char* BackendName() { return g_sink->Name(); }
+
+    void SetNativeExpressions(bool enabled) {
+        g_expressionBackend = enabled ? static_cast<IExpressionSink*>(&g_nativeExpressions) : &g_papyrusExpressions;
+    }
+
+    void SetExpressionSink(IExpressionSink* sink) { g_expressionOverride = sink; }
+
+    const char* ExpressionBackendName() {
+        return (g_expressionOverride ? g_expressionOverride : g_expressionBackend)->Name();
+    }
+
+
+    void Clear(RE::Actor* actor, std::string_view morphName) {
+
+            Clear_MainThread(actor, morphName);
+        }
+    //    if (!actor || morphName.empty()) {
+     //       return;
+      //  }
+
+    //    auto* task = SKSE::GetTaskInterface();
+     //   if (!task) {
+      //      spdlog::warn("[FB] Morph.Clear: task interface missing");
+    //        return;
+    //    }
+
+   //     const RE::ActorHandle handle = actor->CreateRefHandle();
+   //     const std::string nameCopy(morphName);
+
+   //     task->AddTask([handle, nameCopy]() {
+    //        auto aPtr = handle.get();
+     //       auto* a = aPtr.get();
+    //        if (!a) {
+     //           spdlog::info("[FB] Morph.Clear(task): actor handle resolved to null");
+    //            return;
+    //        }
+
+            // extra safety: actor might unload between queue and execution
+  //          if (!a->Get3D1(false)) {
+  //              spdlog::info("[FB] Morph.Clear(task): skip (3D not loaded) actor=0x{:08X}", a->formID);
+     //           return;
+   //         }
+
+  //          Clear_MainThread(a, nameCopy);
+  //      });
+ //   }
+}
@@ -1,12 +1,14 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <utility>
 
 #include "FBPlugin.h"
+#include "FBBench.h"
 #include "FBConfig.h"
 #include "FBEvents.h"
 #include "FBActors.h"
@@ -15,9 +17,15 @@
 #include "RE/Skyrim.h"
 #include "SKSE/SKSE.h"
 #include "FBHotkeys.h"
+#include "FBTags.h"
+#include "FBMetrics.h"
+#include "FBMorph.h"
+#include "FBTriggers.h"
+#include "FBIntegrationDevourment.h"
 
 static FBConfig g_config;
 static FBEvents g_events;
+static FBTriggers g_triggers;
 static std::unique_ptr<FBUpdate> g_update;
 static std::unique_ptr<FBUpdatePump> g_pump;
 FBUpdate* FB::GetUpdate() { return g_update.get(); }
@@ -27,6 +35,10 @@ namespace {
     bool Papyrus_ReloadConfig(RE::StaticFunctionTag*);
     std::int32_t Papyrus_DrainEvents(RE::StaticFunctionTag*);
     std::int32_t Papyrus_TickOnce(RE::StaticFunctionTag*);
+    RE::BSFixedString Papyrus_DumpStats(RE::StaticFunctionTag*);
+    bool Papyrus_RunBenchmarks(RE::StaticFunctionTag*, std::int32_t scale);
+    bool Papyrus_OnDevourmentSwallow(RE::StaticFunctionTag*, RE::Actor* pred, RE::Actor* prey, bool endo,
+                                     std::int32_t locus);
 
     // IMPORTANT:
     // Do NOT patch all vtables. Some entries in RE::VTABLE_* arrays are not Actor-layout
@@ -53,6 +65,7 @@ namespace {
         const RE::ActorHandle handle = actor->CreateRefHandle();
 
         // One task = apply (optionally recapture) + enqueue another burst if chains remain.
+        FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
         taskInterface->AddTask([handle, phase, burstCount, chains, allowPhase0Recapture]() {
             auto aPtr = handle.get();
             RE::Actor* a = aPtr.get();
@@ -128,6 +141,7 @@ namespace {
             auto* taskInterface = SKSE::GetTaskInterface();
             if (taskInterface) {
                 const RE::ActorHandle handle = actor->CreateRefHandle();
+                FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
                 taskInterface->AddTask([handle]() {
                     auto aPtr = handle.get();
                     RE::Actor* a = aPtr.get();
@@ -146,6 +160,7 @@ namespace {
             if ((++s_lateTickCounter % 1) == 0) {  // every ~3 UpdateAnimation calls
                 if (auto* taskInterface = SKSE::GetTaskInterface()) {
                     const RE::ActorHandle handle = self ? self->CreateRefHandle() : RE::ActorHandle{};
+                    FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
                     taskInterface->AddTask([handle]() {
                         auto aPtr = handle.get();
                         RE::Actor* a = aPtr.get();
@@ -167,6 +182,23 @@ namespace {
 
 
 
+    struct PlayerCharacter_UpdateAnimation_Hook {
+        using Fn = void (*)(RE::PlayerCharacter*, float);
+        static inline Fn func = nullptr;
+
+        static void thunk(RE::PlayerCharacter* self, float delta) {
+            if (func) {
+                func(self, delta);
+            }
+
+            // The player's graph has just been updated for this frame: run our tick here so
+            // timeline writes land on this frame's pose instead of one frame late.
+            if (g_pump) {
+                g_pump->OnFrame();
+            }
+        }
+    };
+
     struct TESObjectREFR_UpdateAnimation_Hook {
         using Fn = void (*)(RE::TESObjectREFR*, float);
         static inline Fn func = nullptr;
@@ -227,6 +259,13 @@ namespace {
             spdlog::info("[FB] Hook: TESObjectREFR::UpdateAnimation vfunc installed (orig=0x{:016X})", orig);
             
         }
+        {
+            REL::Relocation<std::uintptr_t> vtbl{RE::VTABLE_PlayerCharacter[0]};
+            const std::uintptr_t orig = vtbl.write_vfunc(0x7D, &PlayerCharacter_UpdateAnimation_Hook::thunk);
+            PlayerCharacter_UpdateAnimation_Hook::func =
+                reinterpret_cast<PlayerCharacter_UpdateAnimation_Hook::Fn>(orig);
+            spdlog::info("[FB] Hook: PlayerCharacter::UpdateAnimation vfunc installed (orig=0x{:016X})", orig);
+        }
         // NEW: NiAVObject::UpdateWorldData (0x30)
         {
             REL::Relocation<std::uintptr_t> vtbl{RE::VTABLE_NiAVObject[0]};
@@ -255,10 +294,25 @@ namespace {
         spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%1] %v");
     }
 
+    // A reload bumps the generation; republish the tag filter for its [EventMap] and wake the
+    // pump in case it is parked so the change is picked up.
+    bool ReloadConfigAndWake() {
+        const bool ok = g_config.Reload();
+        if (ok) {
+            if (const auto snap = g_config.GetSnapshot(); snap) {
+                g_events.RebuildTagFilter(*snap);
+            }
+        }
+        if (g_pump) {
+            g_pump->Wake();
+        }
+        return ok;
+    }
+
     bool Papyrus_ReloadConfig(RE::StaticFunctionTag*) {
         spdlog::info("[FB] Papyrus: ReloadConfig() called");
 
-        const bool ok = g_config.Reload();
+        const bool ok = ReloadConfigAndWake();
         if (!ok) {
             spdlog::warn("[FB] Papyrus: ReloadConfig failed; keeping existing snapshot");
             return false;
@@ -281,28 +335,78 @@ namespace {
             vm->RegisterFunction("ReloadConfig", "FullBodiedQuestScript", Papyrus_ReloadConfig);
             vm->RegisterFunction("DrainEvents", "FullBodiedQuestScript", Papyrus_DrainEvents);
             vm->RegisterFunction("TickOnce", "FullBodiedQuestScript", Papyrus_TickOnce);
+            vm->RegisterFunction("DumpStats", "FullBodiedQuestScript", Papyrus_DumpStats);
+            vm->RegisterFunction("RunBenchmarks", "FullBodiedQuestScript", Papyrus_RunBenchmarks);
+            vm->RegisterFunction("OnDevourmentSwallow", "FullBodied", Papyrus_OnDevourmentSwallow);
             return true;
         });
     }
 
     std::int32_t Papyrus_DrainEvents(RE::StaticFunctionTag*) {
-        auto drained = g_events.Drain();
-        spdlog::info("[FB] DrainEvents: drained count={}", drained.size());
+        std::vector<FBEvent> drained;
+        g_events.Drain(drained);
+        spdlog::info("[FB] DrainEvents: drained count={} dropped={}", drained.size(), g_events.DroppedCount());
 
         if (!drained.empty()) {
             const auto& e = drained.front();
-            spdlog::info("[FB] DrainEvents: first tag='{}' actorFormID=0x{:08X}", e.tag, e.actor.formID);
+            spdlog::info("[FB] DrainEvents: first tag='{}' actorFormID=0x{:08X}", FB::Tags::Name(e.tag),
+                         e.actor.formID);
         }
         return static_cast<std::int32_t>(drained.size());
     }
 
+    // Returns the FB::Metrics report at once; the per-module counters are game-thread state, so
+    // the full report is logged from a task.
+    RE::BSFixedString Papyrus_DumpStats(RE::StaticFunctionTag*) {
+        if (auto* taskInterface = SKSE::GetTaskInterface(); taskInterface) {
+            FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
+            taskInterface->AddTask([]() {
+                if (g_update) {
+                    g_update->LogStats("DumpStats");
+                }
+            });
+        }
+        return RE::BSFixedString(FB::Metrics::Format());
+    }
+
+    // Queues FB::Bench on the game thread; the JSON report lands next to the log.
+    bool Papyrus_RunBenchmarks(RE::StaticFunctionTag*, std::int32_t scale) {
+        auto* taskInterface = SKSE::GetTaskInterface();
+        if (!taskInterface) {
+            return false;
+        }
+
+        spdlog::info("[FB] Papyrus: RunBenchmarks({}) queued", scale);
+        FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
+        taskInterface->AddTask([scale]() { FB::Bench::Run(static_cast<std::uint32_t>(std::max(scale, 1))); });
+        return true;
+    }
+
+    // FB_DevourmentBridge forwards Devourment_onSwallow here (VM thread).
+    bool Papyrus_OnDevourmentSwallow(RE::StaticFunctionTag*, RE::Actor* pred, RE::Actor* prey, bool endo,
+                                     std::int32_t locus) {
+        FB::Devourment::SwallowPayload payload{};
+        payload.predator = pred ? pred->formID : 0;
+        payload.prey = prey ? prey->formID : 0;
+        payload.endo = endo;
+        payload.locus = locus;
+        return FB::Devourment::OnSwallow(payload);
+    }
+
+    // VM thread: the tick runs on the game thread through the pump, like every other tick.
     std::int32_t Papyrus_TickOnce(RE::StaticFunctionTag*) {
-        if (!g_update) {
-            spdlog::error("[FB] TickOnce called but FBUpdate not initialized");
+        auto* taskInterface = SKSE::GetTaskInterface();
+        if (!g_pump || !taskInterface) {
+            spdlog::error("[FB] TickOnce called but FBUpdatePump not initialized");
             return 0;
         }
 
-        g_update->Tick(1.0f / 60.0f);
+        FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
+        taskInterface->AddTask([]() {
+            if (g_pump) {
+                g_pump->TickNow();
+            }
+        });
         return 1;
     }
 }  // namespace
@@ -322,11 +426,23 @@ SKSEPluginLoad(const SKSE::LoadInterface* skse) {
 
     spdlog::info("[FB] Config generation: {}", g_config.GetGeneration());
 
-    g_update = std::make_unique<FBUpdate>(g_config, g_events);
+    FB::Devourment::Initialize(g_triggers);
+
+    g_update = std::make_unique<FBUpdate>(g_config, g_events, g_triggers);
     spdlog::info("[FB] FBUpdate Initialized");
 
     g_pump = std::make_unique<FBUpdatePump>(*g_update);
     // Removed SetTickHz(): not part of current FBUpdatePump surface.
+    g_events.SetWakeHandler([]() {
+        if (g_pump) {
+            g_pump->Wake();
+        }
+    });
+    g_triggers.SetWakeHandler([]() {
+        if (g_pump) {
+            g_pump->Wake();
+        }
+    });
     g_pump->Start();
 
     SKSE::GetMessagingInterface()->RegisterListener([](SKSE::MessagingInterface::Message* msg) {
@@ -334,15 +450,22 @@ SKSEPluginLoad(const SKSE::LoadInterface* skse) {
             return;
         }
 
+        if (msg->type == SKSE::MessagingInterface::kPostPostLoad) {
+            // Every plugin has loaded; SKEE answers the interface exchange from here on.
+            FB::Morph::InitBackend();
+        }
+
         if (msg->type == SKSE::MessagingInterface::kDataLoaded) {
             if (!RegisterPapyrus()) {
                 spdlog::error("[FB] Papyrus Registration failed");
             } else {
                 spdlog::info("[FB] Papyrus registered: FullBodiedQuestScript.ReloadConfig()");
-                g_config.Reload();
             }
+            // Forms exist from here on: rebuild so the Fx keys resolve.
+            FBConfig::SetFormsLoaded();
+            ReloadConfigAndWake();
             FBHotkeys::Install([]() {
-                const bool ok = g_config.Reload();
+                const bool ok = ReloadConfigAndWake();
                 spdlog::info("[FB] Hotkey: Reload result={} gen={}", ok, g_config.GetGeneration());
             });
 
@@ -0,0 +1,80 @@
+#include "FBRetryQueue.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+std::uint64_t FBRetryQueue::TickOf(float seconds) {
+    return seconds > 0.0f ? static_cast<std::uint64_t>(std::floor(seconds / kSlotSeconds)) : 0;
+}
+
+bool FBRetryQueue::Schedule(FBRetryItem item, float nowSeconds) {
+    if (item.event.retries >= kMaxAttempts) {
+        ++_giveUps;
+        spdlog::warn("[FB] Retry: giving up kind={} actor=0x{:08X} after {} attempts (total giveUps={})",
+                     static_cast<std::uint32_t>(item.kind), item.formID, item.event.retries, _giveUps);
+        return false;
+    }
+
+    if (!_started) {
+        _cursor = TickOf(nowSeconds);
+        _started = true;
+    }
+
+    const float delay = kSlotSeconds * static_cast<float>(1u << item.event.retries);
+    ++item.event.retries;
+
+    // Never due in the slot already collected, never further out than one turn of the wheel.
+    std::uint64_t due = TickOf(nowSeconds + delay);
+    due = std::clamp(due, _cursor + 1, _cursor + kSlotCount);
+
+    _slots[due % kSlotCount].push_back(std::move(item));
+    ++_size;
+    ++_retries;
+    return true;
+}
+
+void FBRetryQueue::Collect(float nowSeconds, std::vector<FBRetryItem>& out) {
+    out.clear();
+    if (!_started) {
+        return;
+    }
+
+    const std::uint64_t now = TickOf(nowSeconds);
+    if (now <= _cursor) {
+        return;
+    }
+
+    // A gap longer than the wheel still only needs one turn: every item is due by then.
+    const std::uint64_t steps = std::min<std::uint64_t>(now - _cursor, kSlotCount);
+    for (std::uint64_t i = 1; i <= steps && _size > 0; ++i) {
+        auto& slot = _slots[(_cursor + i) % kSlotCount];
+        _size -= slot.size();
+        std::move(slot.begin(), slot.end(), std::back_inserter(out));
+        slot.clear();
+    }
+    _cursor = now;
+}
+
+double FBRetryQueue::NextDueSeconds() const {
+    if (_size == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    for (std::uint64_t i = 1; i <= kSlotCount; ++i) {
+        if (!_slots[(_cursor + i) % kSlotCount].empty()) {
+            return static_cast<double>(_cursor + i) * kSlotSeconds;
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+void FBRetryQueue::Clear() {
+    for (auto& slot : _slots) {
+        slot.clear();
+    }
+    _size = 0;
+}
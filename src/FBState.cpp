@@ -1 +1,214 @@
-#include "FBState.h"
\ No newline at end of file
+#include "FBState.h"
+
+#include <spdlog/spdlog.h>
+
+#include <bitset>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    enum class Kind : std::uint8_t
+    {
+        Restrained,
+        AIDisabled,
+        ActorValue
+    };
+
+    // Per-actor bits: the boolean states currently in effect because a timeline set them.
+    enum StateBit : std::size_t
+    {
+        kRestrainedBit,
+        kAIDisabledBit,
+        kStateBitCount
+    };
+    using StateBits = std::bitset<kStateBitCount>;
+
+    constexpr std::uint32_t kNoEntry = 0xFFFFFFFF;
+
+    // One undo record (16 bytes). `next` chains a timeline's entries newest first; free slots
+    // are chained through it as well.
+    struct JournalEntry {
+        std::uint32_t formID = 0;
+        std::uint32_t next = kNoEntry;
+        float previous = 0.0f;  // value replaced: life state enum, AI enabled (1/0), or base actor value
+        std::uint16_t av = 0;
+        Kind kind = Kind::Restrained;
+    };
+
+    std::vector<JournalEntry> g_arena;
+    std::uint32_t g_freeHead = kNoEntry;
+    std::unordered_map<std::uint64_t, std::uint32_t> g_journalHeads;  // by timeline: newest entry
+    std::unordered_map<std::uint32_t, StateBits> g_states;            // by actor form ID
+    std::unordered_map<std::string, RE::ActorValue> g_avByName;
+    FB::State::Stats g_stats;
+
+    std::uint32_t AllocEntry() {
+        ++g_stats.journalEntries;
+        if (g_freeHead != kNoEntry) {
+            const std::uint32_t index = g_freeHead;
+            g_freeHead = g_arena[index].next;
+            return index;
+        }
+        g_arena.emplace_back();
+        return static_cast<std::uint32_t>(g_arena.size() - 1);
+    }
+
+    void FreeEntry(std::uint32_t index) {
+        --g_stats.journalEntries;
+        g_arena[index].next = g_freeHead;
+        g_freeHead = index;
+    }
+
+    // Journal the value a state had before `source` first changed it; later changes by the same
+    // timeline keep the original.
+    void Record(std::uint64_t source, std::uint32_t formID, Kind kind, std::uint16_t av, float previous) {
+        auto [head, inserted] = g_journalHeads.try_emplace(source, kNoEntry);
+
+        for (auto i = head->second; i != kNoEntry; i = g_arena[i].next) {
+            const auto& entry = g_arena[i];
+            if (entry.formID == formID && entry.kind == kind && entry.av == av) {
+                return;
+            }
+        }
+
+        const std::uint32_t index = AllocEntry();
+        g_arena[index] = JournalEntry{formID, head->second, previous, av, kind};
+        head->second = index;
+    }
+
+    RE::ActorValue LookupActorValue(std::string_view name) {
+        auto [it, inserted] = g_avByName.try_emplace(std::string(name), RE::ActorValue::kNone);
+        if (inserted) {
+            if (auto* list = RE::ActorValueList::GetSingleton(); list) {
+                it->second = list->LookupActorValueByName(name);
+            }
+        }
+        return it->second;
+    }
+
+    void Restore(RE::Actor* actor, const JournalEntry& entry) {
+        switch (entry.kind) {
+            case Kind::Restrained:
+                // Never touch an actor that died (or was otherwise changed) while restrained.
+                if (actor->AsActorState()->GetLifeState() == RE::ACTOR_LIFE_STATE::kRestrained) {
+                    actor->SetLifeState(static_cast<RE::ACTOR_LIFE_STATE>(static_cast<std::uint32_t>(entry.previous)));
+                }
+                break;
+            case Kind::AIDisabled:
+                actor->EnableAI(entry.previous != 0.0f);
+                break;
+            case Kind::ActorValue:
+                actor->AsActorValueOwner()->SetBaseActorValue(static_cast<RE::ActorValue>(entry.av), entry.previous);
+                break;
+        }
+    }
+}
+
+namespace FB::State {
+    void SetRestrained(RE::Actor* actor, bool restrained, std::uint64_t source) {
+        if (!actor) {
+            return;
+        }
+
+        auto& bits = g_states[actor->formID];
+        if (bits.test(kRestrainedBit) == restrained) {
+            ++g_stats.skipped;
+            return;
+        }
+
+        const auto current = actor->AsActorState()->GetLifeState();
+        if (restrained && current != RE::ACTOR_LIFE_STATE::kAlive) {
+            spdlog::info("[FB] State: restrain skipped (not alive) actor=0x{:08X}", actor->formID);
+            return;
+        }
+
+        Record(source, actor->formID, Kind::Restrained, 0, static_cast<float>(static_cast<std::uint32_t>(current)));
+        actor->SetLifeState(restrained ? RE::ACTOR_LIFE_STATE::kRestrained : RE::ACTOR_LIFE_STATE::kAlive);
+        bits.set(kRestrainedBit, restrained);
+        ++g_stats.applied;
+
+        spdlog::info("[FB] State: restrained={} actor=0x{:08X} timeline={}", restrained, actor->formID, source);
+    }
+
+    void SetAIEnabled(RE::Actor* actor, bool enabled, std::uint64_t source) {
+        if (!actor) {
+            return;
+        }
+
+        auto& bits = g_states[actor->formID];
+        if (bits.test(kAIDisabledBit) == !enabled) {
+            ++g_stats.skipped;
+            return;
+        }
+
+        Record(source, actor->formID, Kind::AIDisabled, 0, actor->IsAIEnabled() ? 1.0f : 0.0f);
+        actor->EnableAI(enabled);
+        bits.set(kAIDisabledBit, !enabled);
+        ++g_stats.applied;
+
+        spdlog::info("[FB] State: AI enabled={} actor=0x{:08X} timeline={}", enabled, actor->formID, source);
+    }
+
+    void SetActorValue(RE::Actor* actor, std::string_view name, float value, std::uint64_t source) {
+        if (!actor) {
+            return;
+        }
+
+        const RE::ActorValue av = LookupActorValue(name);
+        if (av == RE::ActorValue::kNone) {
+            spdlog::warn("[FB] State: unknown actor value '{}'", name);
+            return;
+        }
+
+        auto* owner = actor->AsActorValueOwner();
+        const float current = owner->GetBaseActorValue(av);
+        if (current == value) {
+            ++g_stats.skipped;
+            return;
+        }
+
+        Record(source, actor->formID, Kind::ActorValue, static_cast<std::uint16_t>(av), current);
+        owner->SetBaseActorValue(av, value);
+        ++g_stats.applied;
+
+        spdlog::info("[FB] State: {}={} (was {}) actor=0x{:08X} timeline={}", name, value, current, actor->formID,
+                     source);
+    }
+
+    void Unwind(std::uint64_t source) {
+        const auto head = g_journalHeads.find(source);
+        if (head == g_journalHeads.end()) {
+            return;
+        }
+
+        std::size_t reverted = 0;
+        for (auto i = head->second; i != kNoEntry;) {
+            const JournalEntry entry = g_arena[i];
+            FreeEntry(i);
+            i = entry.next;
+
+            if (auto* actor = RE::TESForm::LookupByID<RE::Actor>(entry.formID); actor) {
+                Restore(actor, entry);
+                ++reverted;
+            }
+
+            if (auto it = g_states.find(entry.formID); it != g_states.end()) {
+                if (entry.kind == Kind::Restrained) {
+                    it->second.reset(kRestrainedBit);
+                } else if (entry.kind == Kind::AIDisabled) {
+                    it->second.reset(kAIDisabledBit);
+                }
+                if (it->second.none()) {
+                    g_states.erase(it);
+                }
+            }
+        }
+        g_journalHeads.erase(head);
+
+        g_stats.reverted += reverted;
+        spdlog::info("[FB] State: unwound {} changes of timeline {}", reverted, source);
+    }
+
+    Stats GetStats() { return g_stats; }
+}
@@ -0,0 +1,89 @@
+#include "FBTags.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    constexpr std::size_t kMaxTags = 4096;
+
+    // Animation tags are BSFixedStrings, which the game pools case-insensitively.
+    std::string FoldCase(std::string_view name) {
+        std::string key(name);
+        std::transform(key.begin(), key.end(), key.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return key;
+    }
+
+    // Slots are written once, under the mutex, before `count` is published; readers only
+    // touch slots below the published count.
+    struct TagTable {
+        std::mutex mutex;
+        std::unordered_map<std::string, TagId> ids;
+        std::unique_ptr<std::string[]> names = std::make_unique<std::string[]>(kMaxTags);
+        std::atomic<std::size_t> count{1};  // slot 0 is kNone
+
+        TagTable() {
+            InternLocked("FBEvent");  // FB::Tags::kFBEvent
+            InternLocked("PairEnd");  // FB::Tags::kPairEnd
+        }
+
+        TagId InternLocked(std::string_view name) {
+            std::string key = FoldCase(name);
+            if (auto it = ids.find(key); it != ids.end()) {
+                return it->second;
+            }
+
+            const auto n = count.load(std::memory_order_relaxed);
+            if (n >= kMaxTags) {
+                spdlog::error("[FB] Tags: intern table full ({}), ignoring tag '{}'", kMaxTags, name);
+                return FB::Tags::kNone;
+            }
+
+            const auto id = static_cast<TagId>(n);
+            names[n] = std::string(name);
+            ids.emplace(std::move(key), id);
+            count.store(n + 1, std::memory_order_release);
+            return id;
+        }
+    };
+
+    TagTable& GetTable() {
+        static TagTable table;
+        return table;
+    }
+}
+
+namespace FB::Tags {
+    TagId Intern(std::string_view name) {
+        if (name.empty()) {
+            return kNone;
+        }
+
+        auto& table = GetTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        return table.InternLocked(name);
+    }
+
+    TagId Find(std::string_view name) {
+        auto& table = GetTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        const auto it = table.ids.find(FoldCase(name));
+        return it != table.ids.end() ? it->second : kNone;
+    }
+
+    std::string_view Name(TagId id) {
+        const auto& table = GetTable();
+        if (id == kNone || id >= table.count.load(std::memory_order_acquire)) {
+            return {};
+        }
+        return table.names[id];
+    }
+}
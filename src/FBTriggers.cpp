@@ -0,0 +1,76 @@
+#include "FBTriggers.h"
+
+#include <spdlog/spdlog.h>
+
+#include "FBTags.h"
+
+FBTriggers::FBTriggers() {
+    for (std::size_t i = 0; i < kCapacity; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+void FBTriggers::SetWakeHandler(WakeFn wake) { _wake = std::move(wake); }
+
+bool FBTriggers::Push(const FBTrigger& trigger) {
+    auto pos = _enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        auto& cell = _cells[pos & kMask];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.trigger = trigger;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            const auto dropped = _dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+            spdlog::warn("[FB] Triggers: queue full ({}), dropped key='{}' actorA=0x{:08X} (dropped total={})",
+                         kCapacity, FB::Tags::Name(trigger.key), trigger.actorA.formID, dropped);
+            return false;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (_wake) {
+        _wake();
+    }
+    return true;
+}
+
+std::size_t FBTriggers::Drain(std::vector<FBTrigger>& out) {
+    out.clear();
+
+    if (_draining.test_and_set(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    auto pos = _dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        auto& cell = _cells[pos & kMask];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1) < 0) {
+            break;
+        }
+
+        out.push_back(cell.trigger);
+        cell.sequence.store(pos + kCapacity, std::memory_order_release);
+        ++pos;
+    }
+
+    _dequeuePos.store(pos, std::memory_order_release);
+    _draining.clear(std::memory_order_release);
+
+    return out.size();
+}
+
+std::size_t FBTriggers::Size() const {
+    const auto tail = _dequeuePos.load(std::memory_order_acquire);
+    const auto head = _enqueuePos.load(std::memory_order_acquire);
+    return head > tail ? head - tail : 0;
+}
@@ -1,619 +1,1330 @@
-#include "FBUpdate.h"
-
-#include <RE/Skyrim.h>
-#include <spdlog/spdlog.h>
-
-#include <algorithm>
-#include <cstdio>
-#include <cstdlib>
-#include <string>
-#include <string_view>
-#include <unordered_map>
-#include <unordered_set>
-
-#include "FBActors.h"
-#include "FBConfig.h"
-#include "FBEvents.h"
-#include "FBExec.h"
-#include "FBMaps.h"
-#include "FBMorph.h"
-#include "FBStructs.h"
-#include "FBTransform.h"
-
-FBUpdate::FBUpdate(FBConfig& config, FBEvents& events) : _config(config), _events(events) {}
-
-static std::string MakeRoleNodeKey(ActorRole role, std::string_view nodeName) {
-    std::string key;
-    key.reserve(2 + nodeName.size());
-    key.push_back(role == ActorRole::Target ? 'T' : 'C');
-    key.push_back('|');
-    key.append(nodeName.data(), nodeName.size());
-    return key;
-}
-
-void FBUpdate::ApplyPostAnimSustainForActor(RE::Actor* actor, std::uint8_t phase) {
-    // Baseline stub: feature intentionally inactive for now.
-}
-
-void FBUpdate::ApplyWorldDataSustainForObject(RE::NiAVObject* object) {
-    // Baseline stub: feature intentionally inactive for now.
-}
-static auto FindActiveTimelineIter(std::vector<ActiveTimeline>& timelines, const FBEvent& e,
-                                   const std::string& scriptKey) {
-    return std::find_if(timelines.begin(), timelines.end(), [&](const ActiveTimeline& tl) {
-        return tl.event.actor.formID == e.actor.formID && tl.scriptKey == scriptKey;
-    });
-}
-
-static void CaptureOriginalScaleIfNeeded(ActiveTimeline& tl, const FBCommand& cmd) {
-    // Only capture for scale transforms
-    if (cmd.type != FBCommandType::Transform || cmd.opcode != "Scale") {
-        return;
-    }
-
-    // Resolve friendly key -> actual node name (pass-through if already a real name)
-    const std::string_view resolvedNode = FB::Maps::ResolveNode(cmd.target);
-
-    // Build key (role + resolved node name)
-    auto key = MakeRoleNodeKey(cmd.role, resolvedNode);
-    if (tl.originalScale.find(key) != tl.originalScale.end()) {
-        return;  // already captured
-    }
-
-    // Resolve actor for the role
-    RE::Actor* actor = FB::Actors::ResolveActorForEvent(tl.event, cmd.role);
-    if (!actor) {
-        return;
-    }
-
-    // Read current scale from node (use resolved name)
-    float current = 1.0f;
-    if (!FBTransform::TryGetScale(actor, resolvedNode, current)) {
-        spdlog::debug("[FB] Reset: capture failed actor=0x{:08X} role={} key='{}' resolved='{}'", actor->formID,
-                      (cmd.role == ActorRole::Target ? "T" : "C"), cmd.target, resolvedNode);
-        return;
-    }
-
-    tl.originalScale.emplace(std::move(key), current);
-
-    spdlog::info("[FB] Reset: captured actor=0x{:08X} role={} key='{}' node='{}' scale={}", actor->formID,
-                 (cmd.role == ActorRole::Target ? "T" : "C"), cmd.target, resolvedNode, current);
-}
-
-static void ApplySustain(ActiveTimeline& tl, float nowSeconds) {
-    // Throttle: 10 Hz is usually plenty for win the tug-of-war without spamming Papyrus.
-    constexpr float kSustainInterval = 0.10f;
-
-    if (nowSeconds < tl.nextSustainAtSeconds) {
-        return;
-    }
-    tl.nextSustainAtSeconds = nowSeconds + kSustainInterval;
-
-    auto applyForRole = [&](ActorRole role, const char* roleLabel,
-                            const std::unordered_map<std::string, float>& morphs) {
-        if (morphs.empty()) {
-            return;
-        }
-
-        RE::Actor* actor = FB::Actors::ResolveActorForEvent(tl.event, role);
-        if (!actor) {
-            return;
-        }
-
-        // Only try if actor has 3D loaded; avoids pointless calls and reduces risk.
-        if (!actor->Get3D1(false)) {
-            return;
-        }
-
-        // Re-apply each sustained morph/expression
-        for (const auto& [name, value] : morphs) {
-            FB::Morph::Set(actor, name, value);  // queued wrapper (safer)
-        }
-    };
-
-    applyForRole(ActorRole::Caster, "C", tl.sustainMorphsCaster);
-    applyForRole(ActorRole::Target, "T", tl.sustainMorphsTarget);
-}
-
-static float Clamp01(float x) {
-    if (x < 0.0f) return 0.0f;
-    if (x > 1.0f) return 1.0f;
-    return x;
-}
-
-static float Lerp(float a, float b, float t) { return a + (b - a) * t; }
-
-static float ApplyEasing(Easing easing, float t) {
-    return t;  // Linear only for now
-}
-
-static std::string MakeTweenKey(std::uint32_t formID, ActorRole role, std::string_view channel) {
-    char buf[32];
-    std::snprintf(buf, sizeof(buf), "0x%08X|%u|", formID, static_cast<unsigned>(role));
-    return std::string(buf) + std::string(channel);
-}
-
-static std::string MakeMorphCacheKey(std::uint32_t formID, ActorRole role, std::string_view morphName) {
-    char buf[32];
-    std::snprintf(buf, sizeof(buf), "0x%08X|%u|", formID, static_cast<unsigned>(role));
-    return std::string(buf) + std::string(morphName);
-}
-
-static void CancelTweensForActor(std::unordered_map<std::string, FBUpdate::ActiveTween>& activeTweens,
-                                 std::unordered_map<std::string, float>& lastMorphValue, std::uint32_t formID) {
-    char prefixBuf[16];
-    std::snprintf(prefixBuf, sizeof(prefixBuf), "0x%08X|", formID);
-    const std::string prefix(prefixBuf);
-
-    for (auto it = activeTweens.begin(); it != activeTweens.end();) {
-        if (it->first.rfind(prefix, 0) == 0) {
-            it = activeTweens.erase(it);
-        } else {
-            ++it;
-        }
-    }
-
-    for (auto it = lastMorphValue.begin(); it != lastMorphValue.end();) {
-        if (it->first.rfind(prefix, 0) == 0) {
-            it = lastMorphValue.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-static void ApplyReset(ActiveTimeline& tl) {
-    // 1) Restore captured scales
-    for (const auto& [key, original] : tl.originalScale) {
-        if (key.size() < 3) {
-            continue;
-        }
-
-        const char roleChar = key[0];
-        const std::string_view nodeName(key.c_str() + 2);
-        const ActorRole role = (roleChar == 'T') ? ActorRole::Target : ActorRole::Caster;
-
-        RE::Actor* actor = FB::Actors::ResolveActorForEvent(tl.event, role);
-        if (!actor) {
-            continue;
-        }
-
-        FBTransform::ApplyScale_MainThread(actor, nodeName, original);
-
-        spdlog::info("[FB] Reset: applied actor=0x{:08X} role={} node='{}' scale={}", actor->formID,
-                     (roleChar == 'T' ? "T" : "C"), nodeName, original);
-    }
-
-    // 2) Clear sustained morphs (RaceMenu + expressions) once per role
-    auto ClearRoleMorphs = [&](ActorRole role, const char* roleLabel,
-                               const std::unordered_map<std::string, float>& morphs) {
-        if (morphs.empty()) {
-            return;
-        }
-
-        RE::Actor* actor = FB::Actors::ResolveActorForEvent(tl.event, role);
-        if (!actor) {
-            return;
-        }
-
-        // If actor isn't loaded, we still clear our internal sustain state below.
-        // We just skip attempting to push clears to the game.
-        if (!actor->Get3D1(false)) {
-            spdlog::info("[FB] Reset: skip morph clear (3D not loaded) actor=0x{:08X} role={}", actor->formID,
-                         roleLabel);
-            return;
-        }
-
-        for (const auto& [name, _value] : morphs) {
-            FB::Morph::Clear_MainThread(actor, name);  // queued wrapper (safe)
-        }
-
-        spdlog::info("[FB] Reset: queued morph clears actor=0x{:08X} role={} count={}", actor->formID, roleLabel,
-                     morphs.size());
-    };
-
-    ClearRoleMorphs(ActorRole::Caster, "C", tl.sustainMorphsCaster);
-    ClearRoleMorphs(ActorRole::Target, "T", tl.sustainMorphsTarget);
-
-    // 3) Clear internal state so sustain stops immediately
-    tl.sustainMorphsCaster.clear();
-    tl.sustainMorphsTarget.clear();
-    tl.touchedMorphsCaster.clear();
-    tl.touchedMorphsTarget.clear();
-
-    tl.originalScale.clear();
-    tl.nextSustainAtSeconds = 0.0f;
-}
-
-void FBUpdate::Tick(float dtSeconds) {
-    const auto snap = _config.GetSnapshot();
-    if (!snap) {
-        spdlog::warn("[FB] Tick(dt={}): no config snapshot", dtSeconds);
-        return;
-    }
-
-    if (_lastSeenGeneration != snap->generation) {
-        spdlog::info("[FB] Generation change {} -> {}; dropping {} timelines", _lastSeenGeneration, snap->generation,
-                     _activeTimelines.size());
-
-        if (snap->ResetOnPairEnd) {
-            for (auto& tl : _activeTimelines) {
-                ApplySustain(tl, _timeSeconds);
-                CancelTweensForActor(_activeTweens, _lastMorphValue, tl.event.actor.formID);
-                ApplyReset(tl);
-            }
-        }
-
-        _activeTimelines.clear();
-        _activeTweens.clear();
-        _lastMorphValue.clear();
-        _lastSeenGeneration = snap->generation;
-    }
-
-    _timeSeconds += dtSeconds;
-
-    // 1) Drain events
-    auto events = _events.Drain();
-    if (!events.empty()) {
-        spdlog::info("[FB] Tick(dt={}): gen={} drainedEvents={}", dtSeconds, snap->generation, events.size());
-    }
-
-    // 2) Create/Reset timelines from events
-    for (const auto& e : events) {
-        if (!e.IsValid()) {
-            spdlog::warn("[FB] Tick: invalid event (tag='{}' actor=0x{:08X})", e.tag, e.actor.formID);
-            continue;
-        }
-
-        const auto& eventTag = e.tag;
-
-        const auto mapIt = snap->eventMap.find(eventTag);
-        if (mapIt == snap->eventMap.end()) {
-            spdlog::info("[FB] Tick: event '{}' actor=0x{:08X} -> no mapping", eventTag, e.actor.formID);
-            continue;
-        }
-
-        const auto& scriptKey = mapIt->second;
-
-        // PairEnd is a clip-end marker: close an existing timeline, do NOT start/reset immediately.
-        if (e.tag == "PairEnd") {
-            auto it = FindActiveTimelineIter(_activeTimelines, e, scriptKey);
-            if (it != _activeTimelines.end()) {
-                if (snap->ResetOnPairEnd) {
-                    const float delay = snap->ResetDelay;
-
-                    if (delay > 0.0f) {
-                        if (!it->resetScheduled) {
-                            it->resetScheduled = true;
-                            it->resetAtSeconds = _timeSeconds + static_cast<double>(delay);
-
-                            spdlog::info(
-                                "[FB] Timeline: CLOSE (PairEnd) scheduled reset actor=0x{:08X} scriptKey='{}' delay={} "
-                                "at={}",
-                                e.actor.formID, scriptKey, delay, it->resetAtSeconds);
-                        } else {
-                            spdlog::info(
-                                "[FB] Timeline: CLOSE (PairEnd) reset already scheduled actor=0x{:08X} scriptKey='{}' "
-                                "at={}",
-                                e.actor.formID, scriptKey, it->resetAtSeconds);
-                        }
-
-                        continue;
-                    }
-
-                    CancelTweensForActor(_activeTweens, _lastMorphValue, it->event.actor.formID);
-                    ApplyReset(*it);
-                }
-
-                spdlog::info("[FB] Timeline: CLOSE (PairEnd) actor=0x{:08X} scriptKey='{}'", e.actor.formID, scriptKey);
-                _activeTimelines.erase(it);
-            } else {
-                spdlog::info("[FB] PairEnd: no active timeline actor=0x{:08X} scriptKey='{}'", e.actor.formID,
-                             scriptKey);
-            }
-            continue;
-        }
-
-        const auto scriptIt = snap->scripts.find(scriptKey);
-        if (scriptIt == snap->scripts.end()) {
-            spdlog::warn("[FB] Tick: event '{}' mapped to script '{}' but script not found", eventTag, scriptKey);
-            continue;
-        }
-
-        // Policy: 1 active timeline per actor (by formID)
-        auto findIt = std::find_if(_activeTimelines.begin(), _activeTimelines.end(), [&](const ActiveTimeline& tl) {
-            return tl.event.IsValid() && tl.event.actor.formID == e.actor.formID;
-        });
-
-        if (findIt == _activeTimelines.end()) {
-            ActiveTimeline tl{};
-            tl.startTimeSeconds = _timeSeconds;
-            tl.event = e;
-            tl.scriptKey = scriptKey;
-            tl.elapsed = 0.0f;
-            tl.nextIndex = 0;
-            tl.generation = snap->generation;
-            tl.commandsComplete = false;
-            tl.resetScheduled = false;
-            tl.resetAtSeconds = 0.0;
-            tl.touchedMorphCaster = false;
-            tl.touchedMorphTarget = false;
-
-            _activeTimelines.emplace_back(std::move(tl));
-            _activeTimelines.back().touchedMorphsCaster.clear();
-            _activeTimelines.back().touchedMorphsTarget.clear();
-
-            spdlog::info("[FB] Timeline: START actor=0x{:08X} eventTag='{}' scriptKey='{}' gen={} ({} cmds)",
-                         e.actor.formID, eventTag, scriptKey, snap->generation, scriptIt->second.size());
-        } else {
-            findIt->event = e;
-            findIt->scriptKey = scriptKey;
-            findIt->startTimeSeconds = _timeSeconds;
-            findIt->elapsed = 0.0f;
-            findIt->nextIndex = 0;
-            findIt->generation = snap->generation;
-            findIt->commandsComplete = false;
-            findIt->resetScheduled = false;
-            findIt->resetAtSeconds = 0.0;
-
-            spdlog::info("[FB] Timeline: RESET actor=0x{:08X} eventTag='{}' scriptKey='{}' gen={} ({} cmds)",
-                         e.actor.formID, eventTag, scriptKey, snap->generation, scriptIt->second.size());
-        }
-    }
-
-    std::size_t guard = 0;
-
-    // 3) Tick active timelines and fire due commands
-    for (std::size_t i = 0; i < _activeTimelines.size(); /* manual */) {
-        if (++guard > 100000) {
-            spdlog::critical("[FB] Tick: guard tripped (timeline loop spin) timelines={}", _activeTimelines.size());
-            break;
-        }
-
-        auto& tl = _activeTimelines[i];
-        tl.elapsed = _timeSeconds - tl.startTimeSeconds;
-
-        if (tl.resetScheduled) {
-            if (_timeSeconds >= tl.resetAtSeconds) {
-                CancelTweensForActor(_activeTweens, _lastMorphValue, tl.event.actor.formID);
-                ApplyReset(tl);
-                spdlog::info("[FB] Timeline: RESET (delayed) actor=0x{:08X} scriptKey='{}' now={} at={}",
-                             tl.event.actor.formID, tl.scriptKey, _timeSeconds, tl.resetAtSeconds);
-
-                _activeTimelines[i] = std::move(_activeTimelines.back());
-                _activeTimelines.pop_back();
-                continue;
-            }
-
-            ++i;
-            continue;
-        }
-
-        const auto itScript = snap->scripts.find(tl.scriptKey);
-        if (itScript == snap->scripts.end()) {
-            if (snap->ResetOnPairEnd) {
-                const float delay = snap->ResetDelay;
-
-                if (delay > 0.0f) {
-                    if (!tl.resetScheduled) {
-                        tl.resetScheduled = true;
-                        tl.resetAtSeconds = _timeSeconds + static_cast<double>(delay);
-
-                        spdlog::info(
-                            "[FB] Timeline: DROP missing scriptKey='{}' scheduled reset actor=0x{:08X} delay={} at={}",
-                            tl.scriptKey, tl.event.actor.formID, delay, tl.resetAtSeconds);
-                    }
-
-                    ++i;
-                    continue;
-                }
-
-                CancelTweensForActor(_activeTweens, _lastMorphValue, tl.event.actor.formID);
-                ApplyReset(tl);
-            }
-
-            spdlog::info("[FB] Timeline: DROP missing scriptKey='{}'", tl.scriptKey);
-
-            _activeTimelines[i] = std::move(_activeTimelines.back());
-            _activeTimelines.pop_back();
-            continue;
-        }
-
-        const auto& timed = itScript->second;
-
-        if (tl.nextIndex >= timed.size()) {
-            if (!tl.commandsComplete) {
-                tl.commandsComplete = true;
-                spdlog::info("[FB] Timeline: COMPLETE (waiting PairEnd) actor=0x{:08X} scriptKey='{}' elapsed={}",
-                             tl.event.actor.formID, tl.scriptKey, tl.elapsed);
-            }
-            ++i;
-            continue;
-        }
-
-        while (tl.nextIndex < timed.size() && tl.elapsed >= timed[tl.nextIndex].time) {
-            const auto& cmd = timed[tl.nextIndex].command;
-
-            spdlog::info(
-                "[FB] Timeline: FIRE actor=0x{:08X} scriptKey='{}' t={} elapsed={} idx={}/{} type={} opcode='{}'",
-                tl.event.actor.formID, tl.scriptKey, timed[tl.nextIndex].time, tl.elapsed, tl.nextIndex + 1,
-                timed.size(), static_cast<std::uint32_t>(cmd.type), cmd.opcode);
-
-            CaptureOriginalScaleIfNeeded(tl, cmd);
-            bool consumedByTween = false;
-
-            float parsedValue = 0.0f;
-            bool parsedValueOK = false;
-            {
-                char* end = nullptr;
-                parsedValue = std::strtof(cmd.args.c_str(), &end);
-                parsedValueOK = (end != cmd.args.c_str());
-            }
-
-            if (parsedValueOK) {
-                if (cmd.type == FBCommandType::Transform && cmd.opcode == "Scale") {
-                    float tweenDur = cmd.tween.duration;
-                    if (tweenDur <= 0.0f && !cmd.tween.hasTween && snap->DefaultTweenScale > 0.0f) {
-                        tweenDur = snap->DefaultTweenScale;
-                    }
-
-                    const bool wantsTween = (tweenDur > 0.0f);
-                    if (wantsTween) {
-                        const std::string_view node = FB::Maps::ResolveNode(cmd.target);
-
-                        ActiveTween tw;
-                        tw.event = tl.event;
-                        tw.role = cmd.role;
-                        tw.type = FBCommandType::Transform;
-                        tw.channelKey = "Scale|" + std::string(node);
-                        tw.target = std::string(node);
-                        tw.startTimeSeconds = _timeSeconds + cmd.tween.delay;
-                        tw.durationSeconds = tweenDur;
-                        tw.startValue = 1.0f;  // captured later at actual tween start
-                        tw.endValue = parsedValue;
-                        tw.easing = cmd.tween.easing;
-                        tw.generation = snap->generation;
-                        tw.startCaptured = false;
-
-                        auto key = MakeTweenKey(tl.event.actor.formID, cmd.role, tw.channelKey);
-                        _activeTweens[key] = tw;
-
-                        consumedByTween = true;
-
-                        spdlog::info("[FB] Tween: create scale actor=0x{:08X} role={} node='{}' end={} dur={} delay={}",
-                                     tl.event.actor.formID, (cmd.role == ActorRole::Target ? "T" : "C"), node,
-                                     parsedValue, tweenDur, cmd.tween.delay);
-                    }
-                } else if (cmd.type == FBCommandType::Morph) {
-                    float tweenDur = cmd.tween.duration;
-                    if (tweenDur <= 0.0f && !cmd.tween.hasTween && snap->DefaultTweenMorph > 0.0f) {
-                        tweenDur = snap->DefaultTweenMorph;
-                    }
-
-                    const std::string morph = std::string(FB::Maps::ResolveMorph(cmd.target));
-
-                    if (tweenDur > 0.0f) {
-                        const auto cacheKey = MakeMorphCacheKey(tl.event.actor.formID, cmd.role, morph);
-
-                        ActiveTween tw;
-                        tw.event = tl.event;
-                        tw.role = cmd.role;
-                        tw.type = FBCommandType::Morph;
-                        tw.channelKey = "Morph|" + morph;
-                        tw.target = morph;
-                        tw.startTimeSeconds = _timeSeconds + cmd.tween.delay;
-                        tw.durationSeconds = tweenDur;
-                        tw.startValue = 0.0f;
-                        tw.endValue = parsedValue;
-                        tw.easing = cmd.tween.easing;
-                        tw.generation = snap->generation;
-                        tw.startCaptured = true;
-
-                        auto itCache = _lastMorphValue.find(cacheKey);
-                        if (itCache != _lastMorphValue.end()) {
-                            tw.startValue = itCache->second;
-                        }
-
-                        auto key = MakeTweenKey(tl.event.actor.formID, cmd.role, tw.channelKey);
-                        _activeTweens[key] = tw;
-
-                        consumedByTween = true;
-
-                        spdlog::info(
-                            "[FB] Tween: create morph actor=0x{:08X} role={} morph='{}' start={} end={} dur={} "
-                            "delay={}",
-                            tl.event.actor.formID, (cmd.role == ActorRole::Target ? "T" : "C"), morph, tw.startValue,
-                            parsedValue, tweenDur, cmd.tween.delay);
-                    }
-                }
-            }
-
-            if (!consumedByTween) {
-                FB::Exec::Execute_MainThread(cmd, tl.event);
-            }
-
-            if (cmd.type == FBCommandType::Morph) {
-                const std::string_view resolvedSV = FB::Maps::ResolveMorph(cmd.target);
-                const std::string morphName(resolvedSV);
-
-                float v = 0.0f;
-                {
-                    std::string tmp(cmd.args);
-                    char* end = nullptr;
-                    v = std::strtof(tmp.c_str(), &end);
-                    if (end == tmp.c_str()) {
-                        spdlog::warn("[FB] Sustain: failed to parse morph value args='{}' morph='{}'", cmd.args,
-                                     morphName);
-                    } else {
-                        const auto cacheKey = MakeMorphCacheKey(tl.event.actor.formID, cmd.role, morphName);
-                        _lastMorphValue[cacheKey] = v;
-
-                        if (cmd.role == ActorRole::Caster) {
-                            tl.sustainMorphsCaster[morphName] = v;
-                        } else if (cmd.role == ActorRole::Target) {
-                            tl.sustainMorphsTarget[morphName] = v;
-                        }
-                    }
-                }
-            }
-
-            ++tl.nextIndex;
-        }
-
-        ++i;
-    }
-
-    // 4) Evaluate active tweens
-    for (auto it = _activeTweens.begin(); it != _activeTweens.end();) {
-        auto& tw = it->second;
-
-        if (tw.generation != snap->generation) {
-            it = _activeTweens.erase(it);
-            continue;
-        }
-
-        if (_timeSeconds < tw.startTimeSeconds) {
-            ++it;
-            continue;
-        }
-
-        RE::Actor* actor = FB::Actors::ResolveActorForEvent(tw.event, tw.role);
-        if (!actor) {
-            ++it;
-            continue;
-        }
-
-        if (tw.type == FBCommandType::Transform && !tw.startCaptured) {
-            float s = 1.0f;
-            if (FBTransform::TryGetScale(actor, tw.target, s)) {
-                tw.startValue = s;
-            } else {
-                tw.startValue = 1.0f;
-            }
-            tw.startCaptured = true;
-        }
-
-        float t = 1.0f;
-        if (tw.durationSeconds > 0.0f) {
-            t = Clamp01((_timeSeconds - tw.startTimeSeconds) / tw.durationSeconds);
-        }
-
-        const float eased = ApplyEasing(tw.easing, t);
-        const float v = Lerp(tw.startValue, tw.endValue, eased);
-
-        if (tw.type == FBCommandType::Transform) {
-            FBTransform::ApplyScale_MainThread(actor, tw.target, v);
-        } else if (tw.type == FBCommandType::Morph) {
-            FB::Morph::Set(actor, tw.target, v);
-
-            const auto cacheKey = MakeMorphCacheKey(tw.event.actor.formID, tw.role, tw.target);
-            _lastMorphValue[cacheKey] = v;
-        }
-
-        if (t >= 1.0f) {
-            it = _activeTweens.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
\ No newline at end of file
+#include "FBUpdate.h"
+
+#include <RE/Skyrim.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "FBActors.h"
+#include "FBConfig.h"
+#include "FBDispatch.h"
+#include "FBEvents.h"
+#include "FBExec.h"
+#include "FBFx.h"
+#include "FBHkx.h"
+#include "FBMaps.h"
+#include "FBMetrics.h"
+#include "FBMorph.h"
+#include "FBState.h"
+#include "FBStructs.h"
+#include "FBTags.h"
+#include "FBTransform.h"
+#include "FBTriggers.h"
+
+namespace {
+    // Below this many timelines + tweens a pass runs its shards back to back on one pool thread.
+    constexpr std::size_t kParallelThreshold = 32;
+
+    // A pass is evaluated for the frame that will apply it; predict that frame's dt from this one.
+    constexpr float kMaxPredictDtSeconds = 0.10f;
+    constexpr float kDefaultPredictDtSeconds = 1.0f / 60.0f;
+
+    constexpr double kNever = std::numeric_limits<double>::infinity();
+
+    // Timelines start at their event's timestamp, but never further back than this (a stale
+    // stamp must not fast-forward a whole script).
+    constexpr float kMaxStartCompensationSeconds = 0.25f;
+
+    // Records how long Tick() took, whichever way it returns.
+    struct TickTimer {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ~TickTimer() { FB::Metrics::RecordTick(std::chrono::steady_clock::now() - start); }
+    };
+}
+
+FBUpdate::FBUpdate(FBConfig& config, FBEvents& events, FBTriggers& triggers)
+    : _config(config),
+      _events(events),
+      _triggers(triggers),
+      _nextDueAtSeconds(kNever),
+      _pool(FBWorkerPool::DefaultThreadCount()) {
+    spdlog::info("[FB] Update: evaluation pool threads={} shards={}", _pool.ThreadCount(), kShardCount);
+}
+
+FBUpdate::~FBUpdate() {
+    if (_evalDone.valid()) {
+        _evalDone.wait();
+    }
+}
+
+void FBUpdate::ApplyPostAnimSustainForActor(RE::Actor* actor, std::uint8_t phase) {
+    // Baseline stub: feature intentionally inactive for now.
+}
+
+void FBUpdate::ApplyWorldDataSustainForObject(RE::NiAVObject* object) {
+    // Baseline stub: feature intentionally inactive for now.
+}
+static auto FindActiveTimelineIter(std::vector<ActiveTimeline>& timelines, const FBEvent& e,
+                                   const std::string& scriptKey) {
+    return std::find_if(timelines.begin(), timelines.end(), [&](const ActiveTimeline& tl) {
+        return tl.event.actor.formID == e.actor.formID && tl.scriptKey == scriptKey;
+    });
+}
+
+// Scale and Morph.Set commands with a numeric value are layered through the channel table;
+// everything else still goes straight to FB::Exec.
+static bool TryGetChannelKind(const FBCommand& cmd, ChannelKind& outKind) {
+    if (cmd.type == FBCommandType::Transform && cmd.opcode == "Scale") {
+        outKind = ChannelKind::Scale;
+        return true;
+    }
+    if (cmd.type == FBCommandType::Morph && cmd.opcode == "Set") {
+        outKind = ChannelKind::Morph;
+        return true;
+    }
+    return false;
+}
+
+static std::string MakeScaleBaseKey(std::uint32_t formID, std::string_view nodeName) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "0x%08X|", formID);
+    return std::string(buf) + std::string(nodeName);
+}
+
+static void ApplySustain(ActiveTimeline& tl, float nowSeconds, std::span<FBChannelTable> channels) {
+    // Throttle: 10 Hz is usually plenty for win the tug-of-war without spamming Papyrus.
+    constexpr float kSustainInterval = 0.10f;
+
+    if (nowSeconds < tl.nextSustainAtSeconds) {
+        return;
+    }
+    tl.nextSustainAtSeconds = nowSeconds + kSustainInterval;
+
+    // Re-send each sustained morph/expression. The channel table folds them with any other
+    // layers on the same morph, so each one is still written once.
+    for (auto& table : channels) {
+        table.MarkSourceDirty(tl.id, ChannelKind::Morph);
+    }
+}
+
+static float Clamp01(float x) {
+    if (x < 0.0f) return 0.0f;
+    if (x > 1.0f) return 1.0f;
+    return x;
+}
+
+static float Lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+static float ApplyEasing(Easing easing, float t) {
+    return t;  // Linear only for now
+}
+
+static std::string MakeTweenKey(std::uint64_t source, ActorRole role, std::string_view channel) {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "%llu|%u|", static_cast<unsigned long long>(source),
+                  static_cast<unsigned>(role));
+    return std::string(buf) + std::string(channel);
+}
+
+static void CancelTweensForTimeline(std::unordered_map<std::string, FBUpdate::ActiveTween>& activeTweens,
+                                    std::uint64_t source) {
+    for (auto it = activeTweens.begin(); it != activeTweens.end();) {
+        if (it->second.source == source) {
+            it = activeTweens.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+static void LogReset(const ActiveTimeline& tl) {
+    spdlog::info("[FB] Reset: released channels actor=0x{:08X} scriptKey='{}' id={}", tl.event.actor.formID,
+                 tl.scriptKey, tl.id);
+}
+
+static void ApplyReset(ActiveTimeline& tl, std::span<FBChannelTable> channels) {
+    // Drop every layer this timeline contributed. Channels left with no layers are restored by
+    // the next commit (captured scale / morph clear); channels still driven by another timeline
+    // simply re-resolve without this one.
+    for (auto& table : channels) {
+        table.RemoveSource(tl.id, true);
+    }
+    FB::Fx::DetachSource(tl.id);
+    FB::State::Unwind(tl.id);
+    LogReset(tl);
+
+    tl.nextSustainAtSeconds = 0.0f;
+}
+
+// Closing without a reset leaves the last applied values in the engine; the timeline's layers
+// are forgotten rather than restored. Tweens already running are allowed to finish. Gameplay
+// state is never left behind.
+static void DetachTimeline(ActiveTimeline& tl, std::span<FBChannelTable> channels) {
+    for (auto& table : channels) {
+        table.RemoveSource(tl.id, false);
+    }
+    FB::State::Unwind(tl.id);
+}
+
+bool FBUpdate::ParseChannelCommand(const FBCommand& cmd, const Snapshot& snap, ChannelCommand& out) {
+    char* end = nullptr;
+    const float parsedValue = std::strtof(cmd.args.c_str(), &end);
+    if (end == cmd.args.c_str() || !TryGetChannelKind(cmd, out.kind)) {
+        return false;
+    }
+
+    const bool isScale = (out.kind == ChannelKind::Scale);
+    out.channelName = isScale ? FB::Maps::ResolveNode(cmd.target) : FB::Maps::ResolveMorph(cmd.target);
+    out.value = parsedValue;
+
+    out.tweenDuration = cmd.tween.duration;
+    const float defaultDur = isScale ? snap.DefaultTweenScale : snap.DefaultTweenMorph;
+    if (out.tweenDuration <= 0.0f && !cmd.tween.hasTween && defaultDur > 0.0f) {
+        out.tweenDuration = defaultDur;
+    }
+    return true;
+}
+
+// Update-clock time of an event: its HandleAnimEvent stamp mapped back from the wall clock.
+static float EventTimeSeconds(const FBEvent& e, float nowSeconds, std::chrono::steady_clock::time_point wallNow) {
+    if (e.timestamp == 0) {
+        return nowSeconds;
+    }
+
+    const auto stamp = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(e.timestamp));
+    const float lag = std::chrono::duration<float>(wallNow - stamp).count();
+    return nowSeconds - std::clamp(lag, 0.0f, kMaxStartCompensationSeconds);
+}
+
+static std::string MakeChannelRetryKey(std::uint32_t formID, ChannelKind kind, std::string_view name) {
+    return (kind == ChannelKind::Scale ? "S|" : "M|") + MakeScaleBaseKey(formID, name);
+}
+
+static RE::Actor* LookupActor(std::uint32_t formID) {
+    auto* form = formID ? RE::TESForm::LookupByID(formID) : nullptr;
+    return form ? form->As<RE::Actor>() : nullptr;
+}
+
+static std::uint32_t BoundFormID(const ActiveTimeline& tl, ActorRole role) {
+    return role == ActorRole::Caster ? tl.casterFormID : tl.targetFormID;
+}
+
+static RE::ActorHandle BoundHandle(const ActiveTimeline& tl, ActorRole role) {
+    return role == ActorRole::Caster ? tl.casterHandle : tl.targetHandle;
+}
+
+std::size_t FBUpdate::ShardOf(std::uint32_t formID) noexcept {
+    // Fibonacci hashing: nearby references often differ only in their low form ID bits.
+    return static_cast<std::size_t>(static_cast<std::uint32_t>(formID * 2654435769u) >> 29) % kShardCount;
+}
+
+void FBUpdate::EvalShard::Clear() {
+    timelines.clear();
+    tweens.clear();
+    newTweens.clear();
+    ops.clear();
+    execs.clear();
+    releases.clear();
+    seek.clear();
+    nextDueAtSeconds = kNever;
+    awaitingCapture = 0;
+    samplesSent = 0;
+    samplesHeld = 0;
+}
+
+//
+// Game thread
+//
+
+float FBUpdate::CaptureScaleBase(RE::Actor* actor, std::string_view nodeName) {
+    auto key = MakeScaleBaseKey(actor->formID, nodeName);
+    if (auto it = _scaleBase.find(key); it != _scaleBase.end()) {
+        return it->second;
+    }
+
+    float current = 1.0f;
+    if (!FBTransform::TryGetScale(actor, nodeName, current)) {
+        spdlog::debug("[FB] Reset: capture failed actor=0x{:08X} node='{}'", actor->formID, nodeName);
+        return 1.0f;
+    }
+
+    _scaleBase.emplace(std::move(key), current);
+
+    spdlog::info("[FB] Reset: captured actor=0x{:08X} node='{}' scale={}", actor->formID, nodeName, current);
+    return current;
+}
+
+void FBUpdate::BindTimelineActors(ActiveTimeline& tl, RE::Actor* caster, RE::Actor* pinnedTarget) {
+    // The one nearest-actor scan of the timeline; every later lookup goes through the handles.
+    // A trigger that names its target skips the scan.
+    RE::Actor* target = pinnedTarget;
+    if (!target && caster) {
+        target = FB::Actors::ResolveActorForEvent(tl.event, ActorRole::Target);
+    }
+
+    tl.targetPinned = pinnedTarget != nullptr;
+    tl.casterFormID = caster ? caster->formID : 0;
+    tl.targetFormID = target ? target->formID : 0;
+    tl.casterHandle = caster ? caster->GetHandle() : RE::ActorHandle{};
+    tl.targetHandle = target ? target->GetHandle() : RE::ActorHandle{};
+}
+
+void FBUpdate::RevalidateTimelineActors() {
+    // Participants stay fixed for the whole timeline; a handle is only re-resolved once it goes
+    // stale (the reference was unloaded or deleted), never because someone else walked closer.
+    for (auto& tl : _activeTimelines) {
+        if (tl.casterFormID != 0 && !FB::Actors::ResolveHandle(tl.casterHandle)) {
+            RE::Actor* caster = FB::Actors::ResolveActorForEvent(tl.event, ActorRole::Caster);
+            tl.casterHandle = caster ? caster->GetHandle() : RE::ActorHandle{};
+
+            spdlog::debug("[FB] Timeline: caster handle stale actor=0x{:08X} id={} rebound={}", tl.casterFormID,
+                          tl.id, caster != nullptr);
+        }
+
+        if (tl.targetFormID != 0 && !FB::Actors::ResolveHandle(tl.targetHandle)) {
+            RE::Actor* target = tl.targetPinned ? LookupActor(tl.targetFormID)
+                                                : FB::Actors::ResolveActorForEvent(tl.event, ActorRole::Target);
+            tl.targetHandle = target ? target->GetHandle() : RE::ActorHandle{};
+
+            spdlog::info("[FB] Timeline: target handle stale id={} old=0x{:08X} new=0x{:08X}", tl.id,
+                         tl.targetFormID, target ? target->formID : 0);
+            tl.targetFormID = target ? target->formID : 0;
+        }
+    }
+}
+
+void FBUpdate::CaptureAwaitingTweens() {
+    for (auto& [key, tw] : _activeTweens) {
+        if (!tw.needsCapture) {
+            continue;
+        }
+        tw.needsCapture = false;
+
+        auto* form = RE::TESForm::LookupByID(tw.formID);
+        RE::Actor* actor = form ? form->As<RE::Actor>() : nullptr;
+        if (!actor) {
+            continue;  // the next pass asks again
+        }
+
+        const float base = CaptureScaleBase(actor, tw.target);
+        tw.startValue = base;
+        TryGetTweenStart(tw, &base, tw.startValue);
+        tw.startCaptured = true;
+    }
+
+    _tweensAwaitingCapture = 0;
+}
+
+void FBUpdate::ScheduleChannelRetry(std::uint32_t formID, ChannelKind kind, const std::string& name) {
+    auto key = MakeChannelRetryKey(formID, kind, name);
+    if (_pendingChannelRetries.contains(key)) {
+        return;
+    }
+
+    FBRetryItem item{};
+    item.kind = FBRetryItem::Kind::Channel;
+    item.formID = formID;
+    item.channelKind = kind;
+    item.channelName = name;
+    if (_retryQueue.Schedule(std::move(item), _timeSeconds)) {
+        _pendingChannelRetries.insert(std::move(key));
+    }
+}
+
+void FBUpdate::ProcessRetries() {
+    _retryQueue.Collect(_timeSeconds, _dueRetries);
+
+    for (auto& item : _dueRetries) {
+        if (item.kind == FBRetryItem::Kind::Event) {
+            // Re-checked (and re-queued if needed) with the drained events; starts now, not at its stamp.
+            item.event.timestamp = 0;
+            _drainedEvents.push_back(item.event);
+            continue;
+        }
+
+        RE::Actor* actor = LookupActor(item.formID);
+        const bool ready = actor && actor->Get3D1(false);
+
+        if (item.kind == FBRetryItem::Kind::Channel) {
+            auto key = MakeChannelRetryKey(item.formID, item.channelKind, item.channelName);
+            if (ready) {
+                _pendingChannelRetries.erase(key);
+                if (ChannelsFor(item.formID).MarkChannelDirty(item.formID, item.channelKind, item.channelName)) {
+                    _channelsDirty = true;
+                    _retryQueue.NoteSuccess();
+                }
+                continue;
+            }
+            if (!actor || !_retryQueue.Schedule(std::move(item), _timeSeconds)) {
+                _pendingChannelRetries.erase(key);
+            }
+            continue;
+        }
+
+        if (ready) {
+            _retryQueue.NoteSuccess();
+            spdlog::info("[FB] Retry: exec {}.{} actor=0x{:08X} after {} attempts", item.command->opcode,
+                         item.command->target, item.formID, item.event.retries);
+            FB::Exec::Execute_MainThread(*item.command, item.event, actor, item.source);
+            FB::Metrics::Add(FB::Metrics::Counter::CommandsFired);
+        } else if (actor) {
+            _retryQueue.Schedule(std::move(item), _timeSeconds);
+        }
+    }
+
+    _dueRetries.clear();
+    FB::Morph::Flush_MainThread();
+}
+
+void FBUpdate::ReleaseSource(std::uint64_t source, bool restore) {
+    for (auto& table : _channelShards) {
+        table.RemoveSource(source, restore);
+    }
+    _channelsDirty = true;
+}
+
+void FBUpdate::FinishEvaluation() {
+    if (!_evalDone.valid()) {
+        return;
+    }
+
+    // The pass merges into _buffers[_evalIndex] as it ends: join it before flipping.
+    auto& ready = _buffers[_evalIndex];
+    bool ok = true;
+    try {
+        _evalDone.get();
+    } catch (const std::exception& ex) {
+        spdlog::error("[FB] Update: evaluation pass failed: {}", ex.what());
+        ok = false;
+    }
+    _evalIndex ^= 1;
+
+    if (!ok) {
+        ready.Clear();
+        return;
+    }
+    CommitBuffer(ready);
+    ready.Clear();
+}
+
+void FBUpdate::CommitBuffer(const FBCommandBuffer& buffer) {
+    std::uint64_t fired = 0;
+    for (const auto& entry : buffer.execs) {
+        // An actor still loading its 3D would swallow the command; run it once the 3D is there.
+        RE::Actor* actor = FB::Actors::ResolveHandle(entry.actor);
+        if (actor && !actor->Get3D1(false)) {
+            FBRetryItem item{};
+            item.kind = FBRetryItem::Kind::Exec;
+            item.formID = actor->formID;
+            item.event = entry.event;
+            item.event.retries = 0;
+            item.command = entry.command;
+            item.snapshot = buffer.snapshot;
+            item.source = entry.source;
+            _retryQueue.Schedule(std::move(item), _timeSeconds);
+            continue;
+        }
+
+        FB::Exec::Execute_MainThread(*entry.command, entry.event, actor, entry.source);
+        ++fired;
+    }
+    if (fired > 0) {
+        FB::Metrics::Add(FB::Metrics::Counter::CommandsFired, fired);
+    }
+
+    // Timelines the pass closed: unwind their gameplay state; a reset also drops their effects
+    for (const auto& end : buffer.ended) {
+        if (end.reset) {
+            FB::Fx::DetachSource(end.source);
+        }
+        FB::State::Unwind(end.source);
+    }
+
+    for (const auto& w : buffer.writes) {
+        auto* form = RE::TESForm::LookupByID(w.formID);
+        RE::Actor* actor = form ? form->As<RE::Actor>() : nullptr;
+
+        if (w.kind == ChannelKind::Scale) {
+            const auto baseKey = MakeScaleBaseKey(w.formID, w.name);
+
+            if (!actor || !actor->Get3D1(false)) {
+                if (w.op != ChannelOp::Set) {
+                    _scaleBase.erase(baseKey);
+                } else if (actor) {
+                    ScheduleChannelRetry(w.formID, w.kind, w.name);
+                }
+                continue;
+            }
+
+            const float base = CaptureScaleBase(actor, w.name);
+
+            if (w.op == ChannelOp::Forget) {
+                if (w.flush) {
+                    FBTransform::ApplyScale_MainThread(actor, w.name, w.Apply(base));
+                }
+                _scaleBase.erase(baseKey);
+                continue;
+            }
+
+            if (w.op == ChannelOp::Restore) {
+                FBTransform::ApplyScale_MainThread(actor, w.name, base);
+                _scaleBase.erase(baseKey);
+
+                spdlog::info("[FB] Reset: applied actor=0x{:08X} node='{}' scale={}", actor->formID, w.name, base);
+                continue;
+            }
+
+            FBTransform::ApplyScale_MainThread(actor, w.name, w.Apply(base));
+            continue;
+        }
+
+        // Morph / expression channels have an implicit base of 0.
+        if (!actor || (w.op == ChannelOp::Forget && !w.flush)) {
+            continue;
+        }
+
+        // Only try if actor has 3D loaded; avoids pointless calls and reduces risk.
+        if (!actor->Get3D1(false)) {
+            spdlog::debug("[FB] Channel: defer morph write (3D not loaded) actor=0x{:08X} morph='{}'", actor->formID,
+                          w.name);
+            if (w.op == ChannelOp::Set) {
+                ScheduleChannelRetry(w.formID, w.kind, w.name);
+            }
+            continue;
+        }
+
+        if (w.op == ChannelOp::Restore) {
+            FB::Morph::Clear_MainThread(actor, w.name);
+        } else {
+            FB::Morph::Set(actor, w.name, w.Apply(0.0f), w.force);
+        }
+    }
+
+    // One body-morph submission per actor for everything this frame wrote
+    FB::Morph::Flush_MainThread();
+}
+
+void FBUpdate::StartOrResetTimeline(const FBEvent& e, const std::string& scriptKey, std::size_t commandCount,
+                                    float eventTime, RE::Actor* caster, RE::Actor* pinnedTarget,
+                                    Generation generation) {
+    const auto eventTag = FB::Tags::Name(e.tag);
+
+    // Policy: 1 active timeline per (actor, scriptKey). Different scripts on the same actor run
+    // side by side and meet in the channel table instead of overwriting each other.
+    auto findIt = FindActiveTimelineIter(_activeTimelines, e, scriptKey);
+
+    if (findIt == _activeTimelines.end()) {
+        ActiveTimeline tl{};
+        tl.id = _nextTimelineId++;
+        tl.startTimeSeconds = eventTime;
+        tl.event = e;
+        tl.scriptKey = scriptKey;
+        tl.elapsed = 0.0f;
+        tl.nextIndex = 0;
+        tl.generation = generation;
+        tl.commandsComplete = false;
+        tl.resetScheduled = false;
+        tl.resetAtSeconds = 0.0;
+        BindTimelineActors(tl, caster, pinnedTarget);
+
+        _activeTimelines.emplace_back(std::move(tl));
+
+        spdlog::info("[FB] Timeline: START actor=0x{:08X} eventTag='{}' scriptKey='{}' gen={} ({} cmds) lag={}",
+                     e.actor.formID, eventTag, scriptKey, generation, commandCount, _timeSeconds - eventTime);
+    } else {
+        findIt->event = e;
+        findIt->scriptKey = scriptKey;
+        findIt->startTimeSeconds = eventTime;
+        findIt->elapsed = 0.0f;
+        findIt->nextIndex = 0;
+        findIt->generation = generation;
+        findIt->commandsComplete = false;
+        findIt->resetScheduled = false;
+        findIt->resetAtSeconds = 0.0;
+        BindTimelineActors(*findIt, caster, pinnedTarget);
+
+        spdlog::info("[FB] Timeline: RESET actor=0x{:08X} eventTag='{}' scriptKey='{}' gen={} ({} cmds) lag={}",
+                     e.actor.formID, eventTag, scriptKey, generation, commandCount, _timeSeconds - eventTime);
+    }
+
+    _nextDueAtSeconds = std::min(_nextDueAtSeconds, static_cast<double>(eventTime));
+}
+
+void FBUpdate::StartTimelineUnbound(const FBEvent& e, const std::string& scriptKey) {
+    const auto snap = _config.GetSnapshot();
+    if (!snap) {
+        return;
+    }
+
+    const auto script = snap->scripts.find(scriptKey);
+    if (script == snap->scripts.end()) {
+        spdlog::warn("[FB] Timeline: unbound start of unknown scriptKey='{}'", scriptKey);
+        return;
+    }
+
+    StartOrResetTimeline(e, scriptKey, script->second.size(), _timeSeconds, nullptr, nullptr, snap->generation);
+    if (auto it = FindActiveTimelineIter(_activeTimelines, e, scriptKey); it != _activeTimelines.end()) {
+        it->casterFormID = e.actor.formID;
+    }
+}
+
+void FBUpdate::StartTimelinesFromTriggers(const Snapshot& snap, std::chrono::steady_clock::time_point wallNow) {
+    for (const auto& trigger : _drainedTriggers) {
+        const auto key = FB::Tags::Name(trigger.key);
+        if (!trigger.IsValid()) {
+            spdlog::warn("[FB] Tick: invalid trigger (key='{}' actorA=0x{:08X})", key, trigger.actorA.formID);
+            continue;
+        }
+
+        const EventBinding* binding = nullptr;
+        if (trigger.source == FBTriggerSource::Devourment && trigger.kind == FBTriggerKind::VoreSwallowSuccess) {
+            binding = snap.FindDevourmentTrigger(trigger.key);
+        }
+        if (!binding) {
+            spdlog::info("[FB][DVT] trigger '{}' pred=0x{:08X} -> no mapping", key, trigger.actorA.formID);
+            continue;
+        }
+        if (!binding->script) {
+            spdlog::warn("[FB][DVT] trigger '{}' mapped to script '{}' but script not found", key,
+                         binding->scriptKey);
+            continue;
+        }
+
+        // Triggers are one-shot gameplay moments; unlike animation events they are not retried.
+        RE::Actor* caster = LookupActor(trigger.actorA.formID);
+        RE::Actor* target = LookupActor(trigger.actorB.formID);
+        if (!caster || !caster->Get3D1(false) || (trigger.actorB.IsValid() && !target)) {
+            spdlog::info("[FB][DVT] trigger '{}' pred=0x{:08X} prey=0x{:08X} ignored: actors not ready", key,
+                         trigger.actorA.formID, trigger.actorB.formID);
+            continue;
+        }
+
+        FBEvent e{};
+        e.tag = trigger.key;
+        e.actor = trigger.actorA;
+        e.timestamp = trigger.timestamp;
+
+        spdlog::info("[FB][DVT] trigger '{}' pred=0x{:08X} prey=0x{:08X} -> scriptKey='{}'", key,
+                     trigger.actorA.formID, trigger.actorB.formID, binding->scriptKey);
+
+        // Seam: a paired animation for the predator and prey will be launched by the timeline's
+        // own commands (an execution-layer capability), not by the trigger path.
+        StartOrResetTimeline(e, binding->scriptKey, binding->script->size(), EventTimeSeconds(e, _timeSeconds, wallNow),
+                             caster, target, snap.generation);
+    }
+}
+
+void FBUpdate::LogStats(std::string_view reason) {
+    spdlog::info("[FB] Stats ({}): timelines={} tweens={} sinks on {} actors", reason, _timelineCount,
+                 _tweenCount, _events.RegisteredActorCount());
+
+    const std::string report = FB::Metrics::Format();
+    for (std::size_t begin = 0, end; begin < report.size(); begin = end + 1) {
+        end = report.find('\n', begin);
+        if (end == std::string::npos) {
+            end = report.size();
+        }
+        spdlog::info("[FB] Stats: {}", std::string_view(report).substr(begin, end - begin));
+    }
+
+    spdlog::info("[FB] Stats: events dropped={} coalesced={} triggers dropped={} retries queued={} retried={} "
+                 "succeeded={} gaveUp={}",
+                 _events.DroppedCount(), _coalescedEvents, _triggers.DroppedCount(), _retryQueue.Size(),
+                 _retryQueue.RetryCount(), _retryQueue.SuccessCount(), _retryQueue.GiveUpCount());
+
+    const auto dispatch = FB::Dispatch::GetStats();
+    spdlog::info("[FB] Stats: dispatch sent={} completed={} replaced={} deferred={} timedOut={} rejected={} "
+                 "pending={} inFlight={}",
+                 dispatch.sent, dispatch.completed, dispatch.replaced, dispatch.deferred, dispatch.timedOut,
+                 dispatch.rejected, dispatch.pending, dispatch.inFlight);
+
+    spdlog::info("[FB] Stats: morph writes sent={} suppressed={} tween samples sent={} held={}",
+                 FB::Morph::SentCount(), FB::Morph::SuppressedCount(), MorphTweenSamplesSent(),
+                 MorphTweenSamplesHeld());
+
+    const auto audio = FB::Fx::GetAudioStats();
+    const auto visual = FB::Fx::GetVisualStats();
+    spdlog::info("[FB] Stats: fx sounds started={} stolen={} failed={} voices={} effects attached={} refreshed={} "
+                 "detached={} failed={} live={}",
+                 audio.starts, audio.steals, audio.failed, audio.voices, visual.attaches, visual.refreshes,
+                 visual.detaches, visual.failed, visual.attached);
+
+    const auto state = FB::State::GetStats();
+    const auto hkx = FB::Hkx::GetStats();
+    spdlog::info("[FB] Stats: state applied={} skipped={} reverted={} journal={} hkx hits={} hashHits={} parsed={} "
+                 "failed={}",
+                 state.applied, state.skipped, state.reverted, state.journalEntries, hkx.hits, hkx.hashHits,
+                 hkx.parsed, hkx.failed);
+}
+
+double FBUpdate::NextWorkAtSeconds() const {
+    const double now = _timeSeconds;
+
+    // A pass in flight owns the timelines; its buffer must be applied next frame anyway.
+    if (_evalDone.valid() || _events.Size() > 0 || _triggers.Size() > 0 || _events.HasPendingRegistrations() ||
+        FB::Dispatch::HasPending()) {
+        return now;
+    }
+
+    const auto snap = _config.GetSnapshot();
+    if (!snap) {
+        return kNever;
+    }
+
+    if (snap->generation != _lastSeenGeneration || _channelsDirty || _tweensAwaitingCapture > 0) {
+        return now;
+    }
+
+    return std::min(_nextDueAtSeconds, _retryQueue.NextDueSeconds());
+}
+
+void FBUpdate::Tick(float dtSeconds) {
+    const TickTimer timer;
+    FB::Actors::BeginFrame();
+
+    // 1) Apply what the previous pass evaluated for this frame
+    FinishEvaluation();
+    _timelineCount = _activeTimelines.size();
+    _tweenCount = _activeTweens.size();
+
+    // Send this frame's share of queued Papyrus calls
+    FB::Dispatch::Pump();
+
+    // Attach/detach animation sinks for actors that loaded or unloaded 3D (budgeted)
+    _events.ProcessRegistrations();
+
+    const auto snap = _config.GetSnapshot();
+    if (!snap) {
+        spdlog::warn("[FB] Tick(dt={}): no config snapshot", dtSeconds);
+        return;
+    }
+
+    if (_lastSeenGeneration != snap->generation) {
+        spdlog::info("[FB] Generation change {} -> {}; dropping {} timelines", _lastSeenGeneration, snap->generation,
+                     _activeTimelines.size());
+
+        for (auto& tl : _activeTimelines) {
+            if (snap->ResetOnPairEnd) {
+                ApplySustain(tl, _timeSeconds, _channelShards);
+                ApplyReset(tl, _channelShards);
+            } else {
+                DetachTimeline(tl, _channelShards);
+            }
+        }
+
+        _activeTimelines.clear();
+        _activeTweens.clear();
+        _channelsDirty = true;
+        _nextDueAtSeconds = kNever;
+        _tweensAwaitingCapture = 0;
+        _retryQueue.Clear();
+        _pendingChannelRetries.clear();
+        _lastSeenGeneration = snap->generation;
+
+        FB::Morph::SetEpsilon(snap->MorphEpsilon);
+        FB::Dispatch::SetBudget(snap->PapyrusCallsPerFrame);
+        FB::Morph::SetNativeExpressions(snap->NativeExpressions);
+        FB::Fx::SetVoicesPerActor(snap->FxVoicesPerActor);
+        spdlog::info("[FB] Update: morph epsilon={} tween step={} maxInterval={}s papyrus calls/frame={} "
+                     "expressions={}",
+                     snap->MorphEpsilon, snap->MorphTweenStep, snap->MorphTweenMaxInterval,
+                     snap->PapyrusCallsPerFrame, FB::Morph::ExpressionBackendName());
+    }
+
+    _timeSeconds += dtSeconds;
+
+    if (snap->StatsLogInterval > 0.0f && _timeSeconds - _lastStatsLogAtSeconds >= snap->StatsLogInterval) {
+        _lastStatsLogAtSeconds = _timeSeconds;
+        LogStats("periodic");
+    }
+
+    // 2) Drain events
+    _events.Drain(_drainedEvents);
+    const auto& events = _drainedEvents;
+    if (!events.empty()) {
+        FB::Metrics::Add(FB::Metrics::Counter::EventsDrained, events.size());
+        spdlog::info("[FB] Tick(dt={}): gen={} drainedEvents={} coalescedTotal={}", dtSeconds, snap->generation,
+                     events.size(), _coalescedEvents);
+    }
+
+    // Deferred work whose backoff has expired (events rejoin the drained list)
+    if (_retryQueue.Size() > 0) {
+        ProcessRetries();
+    }
+
+    // 3) Create/Reset timelines from events
+    const auto wallNow = std::chrono::steady_clock::now();
+    for (const auto& e : events) {
+        if (!e.IsValid()) {
+            spdlog::warn("[FB] Tick: invalid event (tag='{}' actor=0x{:08X})", FB::Tags::Name(e.tag),
+                         e.actor.formID);
+            continue;
+        }
+
+        const auto eventTag = FB::Tags::Name(e.tag);
+        const float eventTime = EventTimeSeconds(e, _timeSeconds, wallNow);
+
+        // The same tag from the same actor inside the window is a duplicate (a graph echoing it,
+        // a sink on two graphs); restarting the timeline for each would redo the same work.
+        const std::uint64_t coalesceKey = (static_cast<std::uint64_t>(e.tag) << 32) | e.actor.formID;
+        if (auto [last, inserted] = _lastEventAtSeconds.try_emplace(coalesceKey, _timeSeconds);
+            !inserted && e.retries == 0) {
+            if (_timeSeconds - last->second <= snap->EventCoalesceWindow) {
+                ++_coalescedEvents;
+                spdlog::debug("[FB] Tick: coalesced '{}' actor=0x{:08X} (total={})", eventTag, e.actor.formID,
+                              _coalescedEvents);
+                continue;
+            }
+            last->second = _timeSeconds;
+        }
+
+        const EventBinding* binding = snap->FindEvent(e.tag);
+        if (!binding) {
+            spdlog::info("[FB] Tick: event '{}' actor=0x{:08X} -> no mapping", eventTag, e.actor.formID);
+            continue;
+        }
+
+        const auto& scriptKey = binding->scriptKey;
+
+        // PairEnd is a clip-end marker: close an existing timeline, do NOT start/reset immediately.
+        if (e.tag == FB::Tags::kPairEnd) {
+            auto it = FindActiveTimelineIter(_activeTimelines, e, scriptKey);
+            if (it != _activeTimelines.end()) {
+                if (snap->ResetOnPairEnd) {
+                    const float delay = snap->ResetDelay;
+
+                    if (delay > 0.0f) {
+                        if (!it->resetScheduled) {
+                            it->resetScheduled = true;
+                            it->resetAtSeconds = eventTime + static_cast<double>(delay);
+                            _nextDueAtSeconds = std::min(_nextDueAtSeconds, it->resetAtSeconds);
+
+                            spdlog::info(
+                                "[FB] Timeline: CLOSE (PairEnd) scheduled reset actor=0x{:08X} scriptKey='{}' delay={} "
+                                "at={}",
+                                e.actor.formID, scriptKey, delay, it->resetAtSeconds);
+                        } else {
+                            spdlog::info(
+                                "[FB] Timeline: CLOSE (PairEnd) reset already scheduled actor=0x{:08X} scriptKey='{}' "
+                                "at={}",
+                                e.actor.formID, scriptKey, it->resetAtSeconds);
+                        }
+
+                        continue;
+                    }
+
+                    CancelTweensForTimeline(_activeTweens, it->id);
+                    ApplyReset(*it, _channelShards);
+                } else {
+                    DetachTimeline(*it, _channelShards);
+                }
+                _channelsDirty = true;
+
+                spdlog::info("[FB] Timeline: CLOSE (PairEnd) actor=0x{:08X} scriptKey='{}'", e.actor.formID, scriptKey);
+                _activeTimelines.erase(it);
+            } else {
+                spdlog::info("[FB] PairEnd: no active timeline actor=0x{:08X} scriptKey='{}'", e.actor.formID,
+                             scriptKey);
+            }
+            continue;
+        }
+
+        if (!binding->script) {
+            spdlog::warn("[FB] Tick: event '{}' mapped to script '{}' but script not found", eventTag, scriptKey);
+            continue;
+        }
+
+        // The caster must have 3D before anything is bound or fired; until then the event waits.
+        RE::Actor* caster = FB::Actors::ResolveActorForEvent(e, ActorRole::Caster);
+        if (!caster || !caster->Get3D1(false)) {
+            FBRetryItem item{};
+            item.kind = FBRetryItem::Kind::Event;
+            item.formID = e.actor.formID;
+            item.event = e;
+            if (_retryQueue.Schedule(std::move(item), _timeSeconds)) {
+                spdlog::info("[FB] Tick: event '{}' actor=0x{:08X} not ready (attempt {}), retrying", eventTag,
+                             e.actor.formID, e.retries + 1);
+            }
+            continue;
+        }
+        if (e.retries > 0) {
+            _retryQueue.NoteSuccess();
+        }
+
+        StartOrResetTimeline(e, scriptKey, binding->script->size(), eventTime, caster, nullptr, snap->generation);
+    }
+
+    if (!events.empty()) {
+        std::erase_if(_lastEventAtSeconds,
+                      [&](const auto& entry) { return _timeSeconds - entry.second > snap->EventCoalesceWindow; });
+    }
+
+    // 3b) Timelines started by external triggers (FBTriggers.h)
+    _triggers.Drain(_drainedTriggers);
+    if (!_drainedTriggers.empty()) {
+        FB::Metrics::Add(FB::Metrics::Counter::TriggersDrained, _drainedTriggers.size());
+        StartTimelinesFromTriggers(*snap, wallNow);
+    }
+
+    if (!_activeTimelines.empty()) {
+        RevalidateTimelineActors();
+    }
+
+    // 4) Tween starts that need an engine read are captured here, between passes
+    if (_tweensAwaitingCapture > 0) {
+        CaptureAwaitingTweens();
+    }
+
+    // 5) Evaluate the next frame off-thread, unless nothing is due by then
+    const float predictDt =
+        (dtSeconds > 0.0f && dtSeconds <= kMaxPredictDtSeconds) ? dtSeconds : kDefaultPredictDtSeconds;
+    const float evalTime = _timeSeconds + predictDt;
+
+    if (!_channelsDirty && _nextDueAtSeconds > evalTime) {
+        return;
+    }
+    _channelsDirty = false;
+
+    _evalDone = _pool.Submit([this, snap, evalTime]() { Evaluate(snap, evalTime); });
+}
+
+//
+// Evaluation pass (worker pool). Only timelines, tweens, channel shards and the back buffer are
+// touched here, and Tick never touches them while a pass is in flight. No RE:: calls.
+//
+
+bool FBUpdate::TryGetTweenStart(const ActiveTween& tw, const float* scaleBase, float& out) const {
+    const ChannelKind kind = (tw.type == FBCommandType::Morph) ? ChannelKind::Morph : ChannelKind::Scale;
+    const auto& channels = ChannelsFor(tw.formID);
+
+    // Continue from this timeline's own layer if it already drives the channel.
+    if (auto own = channels.GetLayerValue(tw.formID, kind, tw.target, tw.source); own) {
+        out = *own;
+        return true;
+    }
+
+    // Blended layers start from their neutral value so they fade in on top of what is there.
+    if (tw.layer.mode != BlendMode::Override) {
+        out = FBChannelTable::Identity(tw.layer.mode);
+        return true;
+    }
+
+    // Override starts from whatever is currently shown; for a node that needs its engine scale.
+    if (kind == ChannelKind::Scale) {
+        if (!scaleBase) {
+            return false;
+        }
+        out = channels.GetResolvedValue(tw.formID, kind, tw.target, *scaleBase).value_or(*scaleBase);
+        return true;
+    }
+
+    // Morphs have no engine read; the shadow of what we last applied stands in for it (safe here:
+    // it is only written by Tick while no pass is running).
+    if (auto resolved = channels.GetResolvedValue(tw.formID, kind, tw.target, 0.0f); resolved) {
+        out = *resolved;
+    } else {
+        out = FB::Morph::GetApplied(tw.formID, tw.target).value_or(0.0f);
+    }
+    return true;
+}
+
+void FBUpdate::Evaluate(std::shared_ptr<const Snapshot> snap, float evalTime) {
+    for (auto& shard : _evalShards) {
+        shard.Clear();
+    }
+
+    // Shard by event actor: a tween always lands in the same shard as its timeline.
+    for (std::size_t i = 0; i < _activeTimelines.size(); ++i) {
+        _evalShards[ShardOf(_activeTimelines[i].event.actor.formID)].timelines.push_back(i);
+    }
+    for (auto& [key, tw] : _activeTweens) {
+        _evalShards[ShardOf(tw.event.actor.formID)].tweens.push_back(&tw);
+    }
+
+    // Phase 1: timelines/tweens -> layer ops (channel tables are only read).
+    // Phase 2: layer ops -> channel shards -> writes (each shard owns its actors' channels).
+    const auto evaluateShard = [&](std::size_t i) { EvaluateShard(_evalShards[i], *snap, evalTime); };
+    const auto resolveShard = [&](std::size_t i) { ResolveChannelShard(i); };
+
+    if (_activeTimelines.size() + _activeTweens.size() >= kParallelThreshold) {
+        _pool.ParallelFor(kShardCount, evaluateShard);
+        _pool.ParallelFor(kShardCount, resolveShard);
+    } else {
+        for (std::size_t i = 0; i < kShardCount; ++i) {
+            evaluateShard(i);
+        }
+        for (std::size_t i = 0; i < kShardCount; ++i) {
+            resolveShard(i);
+        }
+    }
+
+    // Merge: fill the back buffer and retire what the shards closed.
+    auto& out = _buffers[_evalIndex];
+    out.snapshot = snap;
+
+    double nextDue = kNever;
+    std::size_t awaiting = 0;
+    std::uint64_t tweensEvaluated = 0;
+
+    for (auto& shard : _evalShards) {
+        out.execs.insert(out.execs.end(), std::make_move_iterator(shard.execs.begin()),
+                         std::make_move_iterator(shard.execs.end()));
+        for (const auto& r : shard.releases) {
+            out.ended.push_back(FBTimelineEnd{r.source, r.restore});
+        }
+        nextDue = std::min(nextDue, shard.nextDueAtSeconds);
+        awaiting += shard.awaitingCapture;
+        _morphSamplesSent.fetch_add(shard.samplesSent, std::memory_order_relaxed);
+        _morphSamplesHeld.fetch_add(shard.samplesHeld, std::memory_order_relaxed);
+        tweensEvaluated += shard.tweens.size() + shard.newTweens.size();
+    }
+    FB::Metrics::Add(FB::Metrics::Counter::TweensEvaluated, tweensEvaluated);
+    for (const auto& writes : _shardWrites) {
+        out.writes.insert(out.writes.end(), writes.begin(), writes.end());
+    }
+
+    std::erase_if(_activeTimelines, [](const ActiveTimeline& tl) { return tl.closed; });
+    std::erase_if(_activeTweens, [](const auto& entry) { return entry.second.finished; });
+
+    for (auto& shard : _evalShards) {
+        for (auto& [key, tw] : shard.newTweens) {
+            if (!tw.finished) {
+                _activeTweens.insert_or_assign(std::move(key), std::move(tw));
+            }
+        }
+    }
+
+    _nextDueAtSeconds = nextDue;
+    _tweensAwaitingCapture = awaiting;
+}
+
+void FBUpdate::EvaluateShard(EvalShard& shard, const Snapshot& snap, float evalTime) {
+    for (const auto i : shard.timelines) {
+        EvaluateTimeline(shard, _activeTimelines[i], snap, evalTime);
+    }
+
+    for (auto* tw : shard.tweens) {
+        EvaluateTween(shard, *tw, snap, evalTime);
+    }
+
+    // Tweens created this pass start right away (delay 0) rather than a frame late.
+    for (auto& [key, tw] : shard.newTweens) {
+        EvaluateTween(shard, tw, snap, evalTime);
+    }
+}
+
+void FBUpdate::EvaluateTimeline(EvalShard& shard, ActiveTimeline& tl, const Snapshot& snap, float evalTime) {
+    tl.elapsed = evalTime - tl.startTimeSeconds;
+
+    if (tl.resetScheduled) {
+        if (evalTime >= tl.resetAtSeconds) {
+            shard.releases.push_back({tl.id, true});
+            LogReset(tl);
+            spdlog::info("[FB] Timeline: RESET (delayed) actor=0x{:08X} scriptKey='{}' now={} at={}",
+                         tl.event.actor.formID, tl.scriptKey, evalTime, tl.resetAtSeconds);
+
+            tl.closed = true;
+            return;
+        }
+
+        shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, tl.resetAtSeconds);
+        return;
+    }
+
+    const auto itScript = snap.scripts.find(tl.scriptKey);
+    if (itScript == snap.scripts.end()) {
+        if (snap.ResetOnPairEnd) {
+            const float delay = snap.ResetDelay;
+
+            if (delay > 0.0f) {
+                tl.resetScheduled = true;
+                tl.resetAtSeconds = evalTime + static_cast<double>(delay);
+                shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, tl.resetAtSeconds);
+
+                spdlog::info("[FB] Timeline: DROP missing scriptKey='{}' scheduled reset actor=0x{:08X} delay={} at={}",
+                             tl.scriptKey, tl.event.actor.formID, delay, tl.resetAtSeconds);
+                return;
+            }
+
+            shard.releases.push_back({tl.id, true});
+            LogReset(tl);
+        } else {
+            shard.releases.push_back({tl.id, false});
+        }
+
+        spdlog::info("[FB] Timeline: DROP missing scriptKey='{}'", tl.scriptKey);
+
+        tl.closed = true;
+        return;
+    }
+
+    const auto& timed = itScript->second;
+
+    // Seek: the list is sorted by time, so everything due by `elapsed` is one binary search away.
+    const std::size_t firstDue = tl.nextIndex;
+    const std::size_t endDue = static_cast<std::size_t>(
+        std::upper_bound(timed.begin() + static_cast<std::ptrdiff_t>(firstDue), timed.end(), tl.elapsed,
+                         [](float elapsed, const TimedCommand& c) { return elapsed < c.time; }) -
+        timed.begin());
+
+    // Joining late (event lag, a long frame) makes several commands due at once. Only the last
+    // command per (role, channel) decides a channel's value, so earlier ones are folded into it
+    // instead of each becoming a write; an earlier instant value seeds a final tween's start.
+    auto& seek = shard.seek;
+    seek.clear();
+    if (endDue - firstDue > 1) {
+        ChannelCommand cc;
+        for (std::size_t i = firstDue; i < endDue; ++i) {
+            const auto& cmd = timed[i].command;
+            if (!ParseChannelCommand(cmd, snap, cc)) {
+                continue;
+            }
+
+            auto it = std::find_if(seek.begin(), seek.end(), [&](const SeekEntry& s) {
+                return s.role == cmd.role && s.kind == cc.kind && s.channelName == cc.channelName;
+            });
+            if (it == seek.end()) {
+                it = seek.insert(seek.end(), SeekEntry{cmd.role, cc.kind, cc.channelName});
+            } else {
+                it->hasInstant = !it->lastIsTween;
+                it->instantValue = it->lastValue;
+            }
+
+            it->lastIndex = i;
+            it->lastValue = cc.value;
+            it->lastIsTween = cc.tweenDuration > 0.0f;
+        }
+    }
+
+    std::size_t folded = 0;
+    ChannelCommand cc;
+
+    for (std::size_t i = firstDue; i < endDue; ++i) {
+        const auto& cmd = timed[i].command;
+        const bool isChannel = ParseChannelCommand(cmd, snap, cc);
+
+        const SeekEntry* entry = nullptr;
+        if (isChannel && !seek.empty()) {
+            const auto it = std::find_if(seek.begin(), seek.end(), [&](const SeekEntry& s) {
+                return s.role == cmd.role && s.kind == cc.kind && s.channelName == cc.channelName;
+            });
+            entry = (it != seek.end()) ? &*it : nullptr;
+        }
+        if (entry && entry->lastIndex != i) {
+            ++folded;
+            continue;
+        }
+
+        spdlog::info("[FB] Timeline: FIRE actor=0x{:08X} scriptKey='{}' t={} elapsed={} idx={}/{} type={} opcode='{}'",
+                     tl.event.actor.formID, tl.scriptKey, timed[i].time, tl.elapsed, i + 1, timed.size(),
+                     static_cast<std::uint32_t>(cmd.type), cmd.opcode);
+
+        if (isChannel) {
+            const float* seededStart = (entry && entry->hasInstant) ? &entry->instantValue : nullptr;
+            FireChannelCommand(shard, tl, cmd, cc, tl.startTimeSeconds + timed[i].time, seededStart);
+        } else {
+            shard.execs.push_back(FBExecEntry{&cmd, tl.event, BoundHandle(tl, cmd.role), tl.id});
+        }
+    }
+
+    tl.nextIndex = endDue;
+
+    if (folded > 0) {
+        spdlog::info("[FB] Timeline: SEEK actor=0x{:08X} scriptKey='{}' elapsed={} due={} folded={}",
+                     tl.event.actor.formID, tl.scriptKey, tl.elapsed, endDue - firstDue, folded);
+    }
+
+    if (tl.nextIndex < timed.size()) {
+        shard.nextDueAtSeconds =
+            std::min(shard.nextDueAtSeconds, static_cast<double>(tl.startTimeSeconds + timed[tl.nextIndex].time));
+    } else if (!tl.commandsComplete) {
+        tl.commandsComplete = true;
+        spdlog::info("[FB] Timeline: COMPLETE (waiting PairEnd) actor=0x{:08X} scriptKey='{}' elapsed={}",
+                     tl.event.actor.formID, tl.scriptKey, tl.elapsed);
+    }
+}
+
+void FBUpdate::FireChannelCommand(EvalShard& shard, const ActiveTimeline& tl, const FBCommand& cmd,
+                                  const ChannelCommand& cc, float keyTimeSeconds, const float* seededStart) {
+    const bool isScale = (cc.kind == ChannelKind::Scale);
+    const std::uint32_t formID = BoundFormID(tl, cmd.role);
+
+    if (!formID) {
+        spdlog::info("[FB] Channel: could not resolve actor for role={} formID=0x{:08X}",
+                     static_cast<std::uint32_t>(cmd.role), tl.event.actor.formID);
+        return;
+    }
+
+    if (cc.tweenDuration > 0.0f) {
+        ActiveTween tw;
+        tw.event = tl.event;
+        tw.role = cmd.role;
+        tw.source = tl.id;
+        tw.layer = cmd.layer;
+        tw.type = cmd.type;
+        tw.channelKey = (isScale ? "Scale|" : "Morph|") + cc.channelName;
+        tw.target = cc.channelName;
+        tw.startTimeSeconds = keyTimeSeconds + cmd.tween.delay;  // on schedule, even when fired late
+        tw.durationSeconds = cc.tweenDuration;
+        tw.startValue = seededStart ? *seededStart : (isScale ? 1.0f : 0.0f);  // else captured at tween start
+        tw.endValue = cc.value;
+        tw.easing = cmd.tween.easing;
+        tw.generation = tl.generation;
+        tw.formID = formID;
+        tw.startCaptured = (seededStart != nullptr);
+
+        auto key = MakeTweenKey(tl.id, cmd.role, tw.channelKey);
+        shard.newTweens.emplace_back(std::move(key), std::move(tw));
+
+        spdlog::info("[FB] Tween: create {} actor=0x{:08X} role={} target='{}' end={} dur={} delay={}",
+                     isScale ? "scale" : "morph", tl.event.actor.formID, (cmd.role == ActorRole::Target ? "T" : "C"),
+                     cc.channelName, cc.value, cc.tweenDuration, cmd.tween.delay);
+        return;
+    }
+
+    LayerOp op{};
+    op.formID = formID;
+    op.kind = cc.kind;
+    op.name = cc.channelName;
+    op.source = tl.id;
+    op.layer = cmd.layer;
+    op.value = cc.value;
+    shard.ops.push_back(std::move(op));
+
+    spdlog::info("[FB] Channel: layer actor=0x{:08X} role={} target='{}' value={} blend={} prio={}", formID,
+                 (cmd.role == ActorRole::Target ? "T" : "C"), cc.channelName, cc.value,
+                 static_cast<std::uint32_t>(cmd.layer.mode), cmd.layer.priority);
+}
+
+void FBUpdate::EvaluateTween(EvalShard& shard, ActiveTween& tw, const Snapshot& snap, float evalTime) {
+    if (tw.finished) {
+        return;
+    }
+
+    // Tweens of a timeline reset this pass are cancelled; detached timelines let theirs finish.
+    const bool cancelled = std::any_of(shard.releases.begin(), shard.releases.end(), [&](const SourceRelease& r) {
+        return r.restore && r.source == tw.source;
+    });
+    if (cancelled || tw.generation != snap.generation) {
+        tw.finished = true;
+        return;
+    }
+
+    if (evalTime < tw.startTimeSeconds) {
+        shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, static_cast<double>(tw.startTimeSeconds));
+        return;
+    }
+
+    if (!tw.startCaptured) {
+        const auto baseIt = _scaleBase.find(MakeScaleBaseKey(tw.formID, tw.target));
+        const float* base = (baseIt != _scaleBase.end()) ? &baseIt->second : nullptr;
+
+        if (!TryGetTweenStart(tw, base, tw.startValue)) {
+            tw.needsCapture = true;
+            ++shard.awaitingCapture;
+            shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, static_cast<double>(evalTime));
+            return;
+        }
+        tw.startCaptured = true;
+    }
+
+    float t = 1.0f;
+    if (tw.durationSeconds > 0.0f) {
+        t = Clamp01((evalTime - tw.startTimeSeconds) / tw.durationSeconds);
+    }
+
+    const float eased = ApplyEasing(tw.easing, t);
+    const float v = Lerp(tw.startValue, tw.endValue, eased);
+
+    // Every morph sample is a mesh rebuild: between the first and the last one, only emit once the
+    // value has moved by the step or the interval has run out. The easing is linear, so the time
+    // the value crosses the step is known and the pass need not run before then.
+    const bool isMorph = (tw.type == FBCommandType::Morph);
+    if (isMorph && snap.MorphTweenStep > 0.0f && t < 1.0f && tw.hasEmitted && tw.easing == Easing::Linear) {
+        const float speed = std::fabs(tw.endValue - tw.startValue) / std::max(tw.durationSeconds, 1e-6f);
+        float holdSeconds = (speed > 0.0f) ? snap.MorphTweenStep / speed : tw.durationSeconds;
+        if (snap.MorphTweenMaxInterval > 0.0f) {
+            holdSeconds = std::min(holdSeconds, snap.MorphTweenMaxInterval);
+        }
+
+        const float nextSampleAt =
+            std::min(tw.lastEmittedAtSeconds + holdSeconds, tw.startTimeSeconds + tw.durationSeconds);
+        if (evalTime < nextSampleAt) {
+            ++shard.samplesHeld;
+            shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, static_cast<double>(nextSampleAt));
+            return;
+        }
+    }
+
+    if (isMorph) {
+        tw.hasEmitted = true;
+        tw.lastEmittedAtSeconds = evalTime;
+        ++shard.samplesSent;
+    }
+
+    LayerOp op{};
+    op.formID = tw.formID;
+    op.kind = (tw.type == FBCommandType::Morph) ? ChannelKind::Morph : ChannelKind::Scale;
+    op.name = tw.target;
+    op.source = tw.source;
+    op.layer = tw.layer;
+    op.value = v;
+    shard.ops.push_back(op);
+
+    if (t < 1.0f) {
+        shard.nextDueAtSeconds = std::min(shard.nextDueAtSeconds, static_cast<double>(evalTime));
+        return;
+    }
+
+    // Timeline already closed without reset: leave the end value applied, drop the layer.
+    const bool timelineActive = std::any_of(shard.timelines.begin(), shard.timelines.end(), [&](std::size_t i) {
+        const auto& tl = _activeTimelines[i];
+        return tl.id == tw.source && !tl.closed;
+    });
+    if (!timelineActive) {
+        op.remove = true;
+        shard.ops.push_back(std::move(op));
+    }
+
+    tw.finished = true;
+}
+
+void FBUpdate::ResolveChannelShard(std::size_t index) {
+    auto& table = _channelShards[index];
+
+    for (const auto& shard : _evalShards) {
+        for (const auto& r : shard.releases) {
+            table.RemoveSource(r.source, r.restore);
+        }
+    }
+
+    // Ops keep their per-shard order, so a tween's final Set always precedes its removal.
+    for (const auto& shard : _evalShards) {
+        for (const auto& op : shard.ops) {
+            if (ShardOf(op.formID) != index) {
+                continue;
+            }
+
+            if (op.remove) {
+                table.RemoveLayer(op.formID, op.kind, op.name, op.source, false);
+            } else {
+                table.SetLayer(op.formID, op.kind, op.name, op.source, op.layer, op.value);
+            }
+        }
+    }
+
+    _shardWrites[index].clear();
+    table.Resolve(_shardWrites[index]);
+}
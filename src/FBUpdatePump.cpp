@@ -1,39 +1,215 @@
-#include <RE/Skyrim.h>
-#include <SKSE/SKSE.h>
-#include <spdlog/spdlog.h>
-
-#include <chrono>
-#include <thread>
-
-#include "FBUpdatePump.h"
-#include "FBUpdate.h"
-
-FBUpdatePump::FBUpdatePump(FBUpdate& update) : _update(update) {}
-
-void FBUpdatePump::Start() {
-    spdlog::info("[FB] UpdatePump: Start() called");
-
-    if (_running.exchange(true)) {
-        return;  // already running
-    }
-
-    std::thread([this]() {
-        using clock = std::chrono::steady_clock;
-
-        auto last = clock::now();
-        while (_running.load()) {
-            const auto now = clock::now();
-            const std::chrono::duration<float> dt = now - last;
-            last = now;
-
-            if (auto* task = SKSE::GetTaskInterface(); task) {
-                const float dtSeconds = dt.count();
-                task->AddTask([this, dtSeconds]() { _update.Tick(dtSeconds); });
-            }
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));  // ~60 Hz
-        }
-    }).detach();
-}
-
-void FBUpdatePump::Stop() { _running.store(false); }
+#include <RE/Skyrim.h>
+#include <SKSE/SKSE.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "FBUpdatePump.h"
+#include "FBMetrics.h"
+#include "FBUpdate.h"
+
+namespace {
+    constexpr auto kFallbackInterval = std::chrono::milliseconds(16);  // ~60 Hz
+
+    // A stalled frame (load screen, long script) must not turn into one giant step that fires
+    // half a timeline at once; clamp so timelines resume where the animation resumes.
+    // After a deliberate park the planned park length is real time and is added to the clamp;
+    // a stall past the end of the park is clamped like any other.
+    constexpr float kMaxTickDtSeconds = 0.10f;
+}
+
+FBUpdatePump::FBUpdatePump(FBUpdate& update) : _update(update) {}
+
+FBUpdatePump::~FBUpdatePump() { Stop(); }
+
+void FBUpdatePump::Start() {
+    spdlog::info("[FB] UpdatePump: Start() called");
+
+    if (_running.exchange(true)) {
+        return;  // already running
+    }
+
+    _worker = std::thread([this]() { WorkerLoop(); });
+}
+
+void FBUpdatePump::Stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _cv.notify_all();
+
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+
+    spdlog::info("[FB] UpdatePump: stopped");
+}
+
+void FBUpdatePump::Wake() {
+    _wakeRequested.store(true);
+
+    if (!_frameDriven.load()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+        }
+        _cv.notify_all();
+    }
+}
+
+void FBUpdatePump::OnFrame() {
+    if (!_running.load()) {
+        return;
+    }
+
+    if (!_frameDriven.exchange(true)) {
+        spdlog::info("[FB] UpdatePump: frame hook active; fallback worker parked");
+        _cv.notify_all();
+    }
+
+    const auto now = clock::now();
+    if (!ShouldTick(now)) {
+        return;
+    }
+
+    RunTick(now);
+}
+
+void FBUpdatePump::TickNow() {
+    if (!_running.load()) {
+        return;
+    }
+
+    RunTick(clock::now());
+
+    // The tick may have un-parked the pump (a pass in flight); a parked worker only sees that
+    // through a wake.
+    Wake();
+}
+
+bool FBUpdatePump::ShouldTick(clock::time_point now) {
+    if (_wakeRequested.exchange(false)) {
+        return true;
+    }
+
+    const auto parkUntil = _parkUntil.load();
+    return parkUntil != kParkedForever && now.time_since_epoch().count() >= parkUntil;
+}
+
+void FBUpdatePump::RunTick(clock::time_point now) {
+    float dtSeconds = 0.0f;
+    if (_hasLastTick) {
+        dtSeconds = std::min(std::chrono::duration<float>(now - _lastTick).count(),
+                             _parkedSeconds + kMaxTickDtSeconds);
+    }
+    _lastTick = now;
+    _hasLastTick = true;
+
+    _update.Tick(dtSeconds);
+    _ticksRun.fetch_add(1, std::memory_order_relaxed);
+
+    // Decide whether the next frames can be skipped.
+    const double nowUpdate = _update.NowSeconds();
+    const double nextWork = _update.NextWorkAtSeconds();
+
+    const bool wasParked = _parked;
+    _parked = nextWork > nowUpdate;
+    _parkedSeconds = 0.0f;
+
+    if (!_parked) {
+        _parkUntil.store(kNotParked);
+        return;
+    }
+
+    // Parked with nothing scheduled, nothing waits on the time that passes: resume with one
+    // clamped step like after a stall.
+    if (std::isinf(nextWork)) {
+        _parkUntil.store(kParkedForever);
+    } else {
+        _parkedSeconds = static_cast<float>(nextWork - nowUpdate);
+        const auto wait = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(nextWork - nowUpdate));
+        _parkUntil.store((now + wait).time_since_epoch().count());
+    }
+
+    if (!wasParked) {
+        spdlog::debug("[FB] UpdatePump: parked (next work in {}s)", nextWork - nowUpdate);
+    }
+}
+
+void FBUpdatePump::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto nextPost = clock::now();
+
+    while (_running.load()) {
+        if (_frameDriven.load()) {
+            // Frames are driving the tick now; sleep until Stop().
+            _cv.wait(lock, [this]() { return !_running.load(); });
+            break;
+        }
+
+        // A wake only matters once the previously posted tick has run.
+        const auto wakePred = [this]() {
+            return !_running.load() || _frameDriven.load() || (_wakeRequested.load() && !_tickPending.load());
+        };
+
+        const auto parkUntil = _parkUntil.load();
+        if (parkUntil == kParkedForever && !_tickPending.load()) {
+            _cv.wait(lock, wakePred);
+        } else {
+            auto deadline = nextPost;
+            if (parkUntil != kParkedForever) {
+                deadline = std::max(deadline, clock::time_point(clock::duration(parkUntil)));
+            }
+            _cv.wait_until(lock, deadline, wakePred);
+        }
+        _workerWakeups.fetch_add(1, std::memory_order_relaxed);
+
+        if (!_running.load() || _frameDriven.load()) {
+            continue;
+        }
+
+        const auto now = clock::now();
+        if (!_wakeRequested.load() && (_parkUntil.load() == kParkedForever ||
+                                       now.time_since_epoch().count() < _parkUntil.load() || now < nextPost)) {
+            continue;
+        }
+
+        // Never queue a second tick while one is still waiting in the task queue.
+        if (_tickPending.exchange(true)) {
+            nextPost = now + kFallbackInterval;
+            continue;
+        }
+
+        auto* task = SKSE::GetTaskInterface();
+        if (!task) {
+            _tickPending.store(false);
+            nextPost = now + kFallbackInterval;
+            continue;
+        }
+
+        nextPost = now + kFallbackInterval;
+        FB::Metrics::Add(FB::Metrics::Counter::TasksQueued);
+        task->AddTask([this]() {
+            _tickPending.store(false);
+            if (!_running.load() || _frameDriven.load()) {
+                return;
+            }
+
+            const auto now = clock::now();
+            if (ShouldTick(now)) {
+                RunTick(now);
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _cv.notify_all();
+        });
+    }
+}
@@ -0,0 +1,111 @@
+#include "FBWorkerPool.h"
+
+#include <algorithm>
+#include <memory>
+
+FBWorkerPool::FBWorkerPool(std::size_t threadCount) {
+    _threads.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        _threads.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+FBWorkerPool::~FBWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _cv.notify_all();
+
+    for (auto& t : _threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+std::size_t FBWorkerPool::DefaultThreadCount() {
+    const auto hw = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(hw / 4, 1, 4);
+}
+
+void FBWorkerPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return;  // stopping
+            }
+            task = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        task();
+    }
+}
+
+std::future<void> FBWorkerPool::Submit(std::function<void()> task) {
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    auto future = packaged->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.emplace_back([packaged]() { (*packaged)(); });
+    }
+    _cv.notify_one();
+
+    return future;
+}
+
+void FBWorkerPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1 || _threads.empty()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers hold `fn` by pointer: it outlives them because we wait for every index below,
+    // and a helper that starts late finds no index left and never touches it.
+    const auto* fnPtr = &fn;
+    auto drain = [state, fnPtr, count]() {
+        for (;;) {
+            const auto i = state->next.fetch_add(1);
+            if (i >= count) {
+                return;
+            }
+            (*fnPtr)(i);
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    const auto helpers = std::min(count - 1, _threads.size());
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (std::size_t h = 0; h < helpers; ++h) {
+            _queue.emplace_back(drain);
+        }
+    }
+    _cv.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done.load() == count; });
+}
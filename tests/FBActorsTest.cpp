@@ -0,0 +1,143 @@
+// FB::Actors Target resolution: nearest loaded actor strictly within the partner radius, matched
+// against a scan of the handle list per query, and the cost of a frame's queries for 10-1000
+// loaded actors (one position refresh per frame against a handle walk per query).
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "FBActors.h"
+#include "FBTest.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kRadius = 250.0f;  // FBActors.cpp kMaxTargetDist
+    constexpr std::uint32_t kQueriesPerFrame = 8;
+    constexpr std::uint32_t kFrames = 200;
+
+    struct World {
+        explicit World(std::uint32_t count, std::uint32_t seed = 1) {
+            std::mt19937 rng(seed);
+            // Density stays about the same as the count grows: a few partners within the radius.
+            const float extent = 200.0f * std::sqrt(static_cast<float>(count));
+            std::uniform_real_distribution<float> xy(0.0f, extent);
+            std::uniform_real_distribution<float> z(0.0f, 50.0f);
+
+            for (std::uint32_t i = 0; i < count; ++i) {
+                auto& a = actors.emplace_back(std::make_unique<RE::Actor>(0x20000001 + i));
+                a->position = {xy(rng), xy(rng), z(rng)};
+                if (i % 10 != 9) {  // every tenth actor has no 3D
+                    a->root3D = &root;
+                }
+                Standin::RegisterForm(a.get());
+                RE::ProcessLists::GetSingleton()->highActorHandles.push_back(a->GetHandle());
+            }
+        }
+
+        // The resolution before FBActors cached positions: walk the handle list per query.
+        RE::Actor* ScanNearest(RE::Actor* caster) const {
+            RE::Actor* best = nullptr;
+            float bestDist2 = kRadius * kRadius;
+            for (auto& h : RE::ProcessLists::GetSingleton()->highActorHandles) {
+                auto ptr = h.get();
+                RE::Actor* a = ptr.get();
+                if (!a || a == caster || !a->Is3DLoaded()) {
+                    continue;
+                }
+                const auto p = a->GetPosition();
+                const auto c = caster->GetPosition();
+                const float d2 = (p.x - c.x) * (p.x - c.x) + (p.y - c.y) * (p.y - c.y) + (p.z - c.z) * (p.z - c.z);
+                if (d2 < bestDist2) {
+                    bestDist2 = d2;
+                    best = a;
+                }
+            }
+            return best;
+        }
+
+        RE::NiNode root{"NPC Root [Root]"};
+        std::vector<std::unique_ptr<RE::Actor>> actors;
+    };
+
+    RE::Actor* ResolveTarget(RE::Actor* caster) {
+        FBEvent e{};
+        e.tag = 1;
+        e.actor.formID = caster->formID;
+        return FB::Actors::ResolveActorForEvent(e, ActorRole::Target);
+    }
+}
+
+FB_TEST(TargetIsNearestWithinRadius) {
+    RE::NiNode root("NPC Root [Root]");
+    RE::Actor caster(0x20000001), near(0x20000002), nearer(0x20000003), unloaded(0x20000004), far(0x20000005);
+    caster.position = {0.0f, 0.0f, 0.0f};
+    near.position = {200.0f, 0.0f, 0.0f};
+    nearer.position = {0.0f, 120.0f, 50.0f};
+    unloaded.position = {10.0f, 0.0f, 0.0f};
+    far.position = {0.0f, 0.0f, 250.0f};  // on the radius: strictly within excludes it
+    for (auto* a : {&caster, &near, &nearer, &unloaded, &far}) {
+        if (a != &unloaded) {
+            a->root3D = &root;
+        }
+        Standin::RegisterForm(a);
+        RE::ProcessLists::GetSingleton()->highActorHandles.push_back(a->GetHandle());
+    }
+
+    FB::Actors::BeginFrame();
+    FB_CHECK(ResolveTarget(&caster) == &nearer);
+
+    // Positions are read once per frame: a move shows up on the next frame.
+    nearer.position = {0.0f, 240.0f, 0.0f};
+    FB_CHECK(ResolveTarget(&caster) == &nearer);
+    FB::Actors::BeginFrame();
+    FB_CHECK(ResolveTarget(&caster) == &near);
+
+    // So does an actor leaving the high process list.
+    RE::ProcessLists::GetSingleton()->highActorHandles.clear();
+    FB_CHECK(ResolveTarget(&caster) == &near);
+    FB::Actors::BeginFrame();
+    FB_CHECK(ResolveTarget(&caster) == nullptr);
+}
+
+FB_TEST(TargetMatchesScanAndCostsLess) {
+    std::printf("  %7s %16s %16s\n", "actors", "cached us/frame", "scan us/frame");
+    for (const std::uint32_t count : {10u, 100u, 1000u}) {
+        Standin::Reset();
+        World world(count, count);
+
+        // Same answer as a scan for every caster.
+        FB::Actors::BeginFrame();
+        bool matches = true;
+        for (const auto& a : world.actors) {
+            matches = matches && ResolveTarget(a.get()) == world.ScanNearest(a.get());
+        }
+        FB_CHECK(matches);
+
+        // A frame's queries: refresh once, then kQueriesPerFrame lookups.
+        std::uint64_t found = 0;
+        auto start = Clock::now();
+        for (std::uint32_t f = 0; f < kFrames; ++f) {
+            FB::Actors::BeginFrame();
+            for (std::uint32_t q = 0; q < kQueriesPerFrame; ++q) {
+                found += ResolveTarget(world.actors[(f * kQueriesPerFrame + q) % count].get()) ? 1 : 0;
+            }
+        }
+        const double cachedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / kFrames;
+
+        start = Clock::now();
+        for (std::uint32_t f = 0; f < kFrames; ++f) {
+            for (std::uint32_t q = 0; q < kQueriesPerFrame; ++q) {
+                found -= world.ScanNearest(world.actors[(f * kQueriesPerFrame + q) % count].get()) ? 1 : 0;
+            }
+        }
+        const double scanUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / kFrames;
+
+        std::printf("  %7u %16.2f %16.2f\n", count, cachedUs, scanUs);
+        FB_CHECK(found == 0);
+    }
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
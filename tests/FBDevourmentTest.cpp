@@ -0,0 +1,131 @@
+// FB::Devourment against a fake event source: swallow payloads handed to OnSwallow (as the
+// Papyrus bridge would) become FBTriggers, and FBUpdate starts the [DevourmentEventMap] script on
+// the predator. Unsupported, malformed, unmapped and not-yet-loaded cases start nothing.
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "FBEvents.h"
+#include "FBIntegrationDevourment.h"
+#include "FBTest.h"
+#include "FBTriggers.h"
+#include "FBUpdate.h"
+
+namespace {
+    using SwallowPayload = FB::Devourment::SwallowPayload;
+
+    constexpr float kFrameSeconds = 1.0f / 60.0f;
+    constexpr RE::FormID kPredator = 0x70000001;
+    constexpr RE::FormID kPrey = 0x70000002;
+
+    std::shared_ptr<Snapshot> VoreSnapshot(std::string_view name, std::string_view key = "SwallowSuccess_Stomach") {
+        return FBTest::BuildSnapshot(name,
+                                     "[General]\nHkxAnnotations=false\nStatsLogInterval=0\n\n"
+                                     "[FBFiles]\nFBVore=FBVore.hkx\n\n[DevourmentEventMap]\n" +
+                                         std::string(key) + "=FBVore.hkx\n",
+                                     "FBVore",
+                                     "[FB:FBVore.hkx|Caster]\n0.00 FBScale_Head(1.5)\n5.00 FBScale_Head(1.0)\n");
+    }
+
+    struct Scene {
+        explicit Scene(std::shared_ptr<const Snapshot> snap)
+            : config(std::move(snap)), predator(kPredator), prey(kPrey), update(config, events, triggers) {
+            Standin::Load3D(predator, predatorRoot, {"NPC Head [Head]"});
+            Standin::Load3D(prey, preyRoot, {"NPC Head [Head]"});
+            Standin::RegisterForm(&predator);
+            Standin::RegisterForm(&prey);
+            FB::Devourment::Initialize(triggers);
+            update.Tick(kFrameSeconds);  // takes the snapshot's generation
+        }
+
+        // A few frames: the trigger is drained, the timeline starts and its first pass is applied.
+        void Frames(int count = 4) {
+            for (int i = 0; i < count; ++i) {
+                update.Tick(kFrameSeconds);
+            }
+        }
+
+        float HeadScale() {
+            auto* head = predatorRoot.GetObjectByName(RE::BSFixedString("NPC Head [Head]"));
+            return head ? head->local.scale : 0.0f;
+        }
+
+        FBConfig config;
+        FBEvents events;
+        FBTriggers triggers;
+        RE::NiNode predatorRoot{"NPC Root [Root]"};
+        RE::NiNode preyRoot{"NPC Root [Root]"};
+        RE::Actor predator;
+        RE::Actor prey;
+        FBUpdate update;  // destroyed first: its last pass may still touch the actors
+    };
+
+    SwallowPayload Swallow(bool endo = false, std::int32_t locus = 0) { return {kPredator, kPrey, endo, locus}; }
+}
+
+FB_TEST(SwallowStartsMappedScriptOnPredator) {
+    auto snap = VoreSnapshot("SwallowStartsMappedScript");
+    FB_CHECK(snap != nullptr);
+    if (!snap) {
+        return;
+    }
+    Scene scene(snap);
+
+    // The bridge calls in from a Papyrus VM thread.
+    bool queued = false;
+    std::thread vmThread([&]() { queued = FB::Devourment::OnSwallow(Swallow()); });
+    vmThread.join();
+    FB_CHECK(queued);
+    FB_CHECK(scene.triggers.Size() == 1);
+
+    scene.Frames();
+    FB_CHECK(scene.triggers.Size() == 0);
+    FB_CHECK(scene.update.ActiveTimelineCount() == 1);
+    FB_CHECK_NEAR(scene.HeadScale(), 1.5f, 1e-4f);
+}
+
+FB_TEST(SwallowIgnoresUnsupportedPayloads) {
+    auto snap = VoreSnapshot("SwallowIgnoresUnsupported");
+    FB_CHECK(snap != nullptr);
+    if (!snap) {
+        return;
+    }
+    Scene scene(snap);
+
+    FB_CHECK(!FB::Devourment::OnSwallow(Swallow(true)));      // endo
+    FB_CHECK(!FB::Devourment::OnSwallow(Swallow(false, 2)));  // not the stomach
+    FB_CHECK(!FB::Devourment::OnSwallow({kPredator, 0, false, 0}));
+    FB_CHECK(!FB::Devourment::OnSwallow({kPredator, kPredator, false, 0}));
+    FB_CHECK(scene.triggers.Size() == 0);
+
+    scene.Frames();
+    FB_CHECK(scene.update.ActiveTimelineCount() == 0);
+    FB_CHECK(scene.HeadScale() == 1.0f);
+}
+
+FB_TEST(SwallowWithoutMappingOrLoadedPredatorStartsNothing) {
+    auto unmapped = VoreSnapshot("SwallowUnmapped", "SwallowSuccess_Womb");
+    auto mapped = VoreSnapshot("SwallowNotLoaded");
+    FB_CHECK(unmapped != nullptr && mapped != nullptr);
+    if (!unmapped || !mapped) {
+        return;
+    }
+
+    {
+        Scene scene(unmapped);
+        FB_CHECK(FB::Devourment::OnSwallow(Swallow()));  // queued; nothing maps it
+        scene.Frames();
+        FB_CHECK(scene.triggers.Size() == 0);
+        FB_CHECK(scene.update.ActiveTimelineCount() == 0);
+    }
+
+    // Triggers are not retried: a predator without 3D when it is drained misses the moment.
+    Scene scene(mapped);
+    scene.predator.root3D = nullptr;
+    FB_CHECK(FB::Devourment::OnSwallow(Swallow()));
+    scene.Frames();
+    FB_CHECK(scene.update.ActiveTimelineCount() == 0);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
@@ -0,0 +1,185 @@
+// FB::Dispatch against a stand-in VM: the per-frame budget, nearest-to-the-player order, one call
+// in flight per key, replacing and merging queued calls, and refused calls.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBDispatch.h"
+#include "FBMorph.h"
+#include "FBTest.h"
+
+namespace {
+    using BodyMorphArgs = RE::FunctionArguments<RE::Actor*, std::vector<RE::BSFixedString>, std::vector<float>,
+                                                std::vector<RE::BSFixedString>>;
+    using FloatArgs = RE::FunctionArguments<float>;
+
+    // Keeps every call until the test completes it, like a VM that runs calls on its own threads.
+    class RecordingVm final : public FB::Dispatch::IVirtualMachineBackend {
+    public:
+        struct Call {
+            FB::Dispatch::VmCall call;
+            std::unique_ptr<RE::BSScript::IFunctionArguments> args;
+            RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> callback;
+        };
+
+        bool Dispatch(const FB::Dispatch::VmCall& call,
+                      RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>& callback) override {
+            if (refuse) {
+                delete call.args;
+                return false;
+            }
+            calls.push_back({call, std::unique_ptr<RE::BSScript::IFunctionArguments>(call.args), callback});
+            return true;
+        }
+
+        void CompleteAll() {
+            for (auto& c : calls) {
+                if (c.callback) {
+                    (*c.callback)(RE::BSScript::Variable{});
+                    c.callback = {};
+                }
+            }
+        }
+
+        std::vector<Call> calls;
+        bool refuse = false;
+    };
+
+    struct Scene {
+        Scene() {
+            Standin::Load3D(player, playerRoot, {});
+            Standin::SetPlayer(&player);
+            for (std::uint32_t i = 0; i < 4; ++i) {
+                auto& a = actors.emplace_back(std::make_unique<RE::Actor>(0x40000001 + i));
+                a->position = {1000.0f - 200.0f * static_cast<float>(i), 0.0f, 0.0f};  // last is nearest
+                a->root3D = &root;
+                Standin::RegisterForm(a.get());
+            }
+            FB::Dispatch::SetBackend(&vm);
+        }
+
+        ~Scene() {
+            // Retire whatever is still in flight so the next case starts idle.
+            vm.CompleteAll();
+            FB::Dispatch::Pump();
+            FB::Dispatch::SetBackend(nullptr);
+            FB::Dispatch::SetBudget(8);
+        }
+
+        void EnqueueFloat(RE::Actor* actor, std::string key, float value) {
+            FB::Dispatch::EnqueueActorMethod(actor, std::move(key), "SetExpressionPhoneme",
+                                             [value]() { return RE::MakeFunctionArguments(float(value)); });
+        }
+
+        RE::PlayerCharacter player;
+        RE::NiNode playerRoot{"NPC Root [Root]"};
+        RE::NiNode root{"NPC Root [Root]"};
+        std::vector<std::unique_ptr<RE::Actor>> actors;
+        RecordingVm vm;
+    };
+
+    float FloatArg(const RecordingVm::Call& c) {
+        const auto* args = dynamic_cast<const FloatArgs*>(c.args.get());
+        return args ? std::get<0>(args->values) : -1.0f;
+    }
+}
+
+FB_TEST(DispatchSendsBudgetNearestFirst) {
+    Scene scene;
+    FB::Dispatch::SetBudget(2);
+    for (auto& a : scene.actors) {
+        scene.EnqueueFloat(a.get(), "#P0", 0.5f);
+    }
+
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 2);
+    FB_CHECK(scene.vm.calls[0].call.actor == scene.actors[3].get());
+    FB_CHECK(scene.vm.calls[1].call.actor == scene.actors[2].get());
+    FB_CHECK(scene.vm.calls[0].call.isMethod);
+    FB_CHECK(FB::Dispatch::GetStats().pending == 2);
+
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 4);
+    FB_CHECK(scene.vm.calls[3].call.actor == scene.actors[0].get());
+    FB_CHECK(!FB::Dispatch::HasPending());
+}
+
+FB_TEST(DispatchKeepsOneCallInFlightPerKey) {
+    Scene scene;
+    auto* actor = scene.actors[0].get();
+    scene.EnqueueFloat(actor, "#P0", 0.1f);
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 1);
+
+    // Newer values wait for the call in flight; the last one replaces the others.
+    const auto replacedBefore = FB::Dispatch::GetStats().replaced;
+    scene.EnqueueFloat(actor, "#P0", 0.2f);
+    scene.EnqueueFloat(actor, "#P0", 0.3f);
+    scene.EnqueueFloat(actor, "#P1", 0.9f);  // another key is not held back
+    FB::Dispatch::Pump();
+    FB_CHECK(FB::Dispatch::GetStats().replaced - replacedBefore == 1);
+    FB_CHECK(scene.vm.calls.size() == 2);
+    FB_CHECK(FloatArg(scene.vm.calls[1]) == 0.9f);
+    FB_CHECK(FB::Dispatch::GetStats().inFlight == 2);
+
+    scene.vm.CompleteAll();
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 3);
+    FB_CHECK(FloatArg(scene.vm.calls[2]) == 0.3f);
+}
+
+FB_TEST(DispatchMergesBodyMorphBatches) {
+    Scene scene;
+    auto* actor = scene.actors[0].get();
+    const RE::BSFixedString a("FBDispatchA"), b("FBDispatchB"), c("FBDispatchC");
+
+    std::vector<RE::BSFixedString> names{a, b};
+    std::vector<float> values{0.1f, 0.2f};
+    FB::Dispatch::EnqueueBodyMorphs(actor, names, values, {});
+
+    // Before it is sent: B cleared, A replaced, C added.
+    std::vector<RE::BSFixedString> clears{b};
+    FB::Dispatch::EnqueueBodyMorphs(actor, {}, {}, clears);
+    names = {a, c};
+    values = {0.5f, 0.7f};
+    FB::Dispatch::EnqueueBodyMorphs(actor, names, values, {});
+
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 1);
+    const auto& call = scene.vm.calls[0];
+    FB_CHECK(!call.call.isMethod);
+    FB_CHECK(std::string(call.call.className) == FB::Morph::kBridgeClass);
+    FB_CHECK(std::string(call.call.functionName) == FB::Morph::kFnApplyMorphs);
+
+    const auto* args = dynamic_cast<const BodyMorphArgs*>(call.args.get());
+    FB_CHECK(args != nullptr);
+    if (args) {
+        const auto& [argActor, setNames, setValues, clearNames] = args->values;
+        FB_CHECK(argActor == actor);
+        FB_CHECK(setNames.size() == 2 && setNames[0] == a && setNames[1] == c);
+        FB_CHECK(setValues.size() == 2 && setValues[0] == 0.5f && setValues[1] == 0.7f);
+        FB_CHECK(clearNames.size() == 1 && clearNames[0] == b);
+    }
+}
+
+FB_TEST(DispatchCountsRefusedCalls) {
+    Scene scene;
+    scene.vm.refuse = true;
+    const auto before = FB::Dispatch::GetStats();
+    scene.EnqueueFloat(scene.actors[0].get(), "#P0", 0.5f);
+    FB::Dispatch::Pump();
+
+    const auto after = FB::Dispatch::GetStats();
+    FB_CHECK(after.rejected - before.rejected == 1);
+    FB_CHECK(after.sent == before.sent);
+    FB_CHECK(after.inFlight == 0 && after.pending == 0);
+
+    // Nothing holds the key: the next value goes out.
+    scene.vm.refuse = false;
+    scene.EnqueueFloat(scene.actors[0].get(), "#P0", 0.6f);
+    FB::Dispatch::Pump();
+    FB_CHECK(scene.vm.calls.size() == 1);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
@@ -0,0 +1,164 @@
+// FB::Morph expression backends: the native sink writes the actor's face data directly, falls back
+// to the Papyrus natives for an actor without face data, and Papyrus is used throughout when
+// native expressions are off. Writes reach the sink once per actor per flush, last value per slot.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBDispatch.h"
+#include "FBMorph.h"
+#include "FBTest.h"
+
+namespace {
+    using ExpressionWrite = FB::Morph::ExpressionWrite;
+
+    // A loaded head: 16 phonemes and 14 modifiers, like the game's face data.
+    struct Face {
+        Face() {
+            data.phoneme2.values = phonemes.data();
+            data.phoneme2.count = static_cast<std::uint32_t>(phonemes.size());
+            data.modifier2.values = modifiers.data();
+            data.modifier2.count = static_cast<std::uint32_t>(modifiers.size());
+        }
+
+        std::array<float, 16> phonemes{};
+        std::array<float, 14> modifiers{};
+        RE::BSFaceGenAnimationData data;
+    };
+
+    // Records actor method calls by name and reports each one complete.
+    class MethodLog final : public FB::Dispatch::IVirtualMachineBackend {
+    public:
+        bool Dispatch(const FB::Dispatch::VmCall& call,
+                      RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>& callback) override {
+            if (call.isMethod) {
+                names.emplace_back(call.functionName);
+            }
+            delete call.args;
+            (*callback)(RE::BSScript::Variable{});
+            return true;
+        }
+
+        std::vector<std::string> names;
+    };
+
+    class RecordingSink final : public FB::Morph::IExpressionSink {
+    public:
+        const char* Name() const override { return "Recording"; }
+        void Submit(RE::Actor*, std::span<const ExpressionWrite> writes) override {
+            ++submits;
+            last.assign(writes.begin(), writes.end());
+        }
+
+        std::uint32_t submits = 0;
+        std::vector<ExpressionWrite> last;
+    };
+
+    // Each case uses its own actor: FB::Morph's shadow of applied values outlives a case.
+    struct Scene {
+        explicit Scene(RE::FormID formID) : actor(formID) {
+            actor.faceGen = &face.data;
+            Standin::RegisterForm(&actor);
+            FB::Dispatch::SetBackend(&vm);
+            FB::Dispatch::SetBudget(64);
+        }
+
+        ~Scene() {
+            FB::Dispatch::Pump();  // retire the calls sent last frame
+            FB::Dispatch::SetBackend(nullptr);
+            FB::Dispatch::SetBudget(8);
+            FB::Morph::SetNativeExpressions(true);
+        }
+
+        // One frame: flush the batch, then send whatever went to the dispatcher.
+        void Frame() {
+            FB::Morph::Flush_MainThread();
+            FB::Dispatch::Pump();
+        }
+
+        Face face;
+        RE::Actor actor;
+        MethodLog vm;
+    };
+}
+
+FB_TEST(NativeExpressionsWriteFaceData) {
+    Scene scene(0x50000001);
+    FB::Morph::SetNativeExpressions(true);
+    FB_CHECK(std::string(FB::Morph::ExpressionBackendName()) == "Native");
+
+    FB::Morph::Set(&scene.actor, "Aah", 40.0f);       // 0..100 authoring
+    FB::Morph::Set(&scene.actor, "BlinkL", 1.0f);     // 0..1 authoring
+    FB::Morph::Set(&scene.actor, "Happy", 50.0f);     // mood 10 at strength 50
+    scene.Frame();
+
+    FB_CHECK_NEAR(scene.face.phonemes[0], 0.4f, 1e-5f);
+    FB_CHECK(!scene.face.data.phoneme2.isUpdated);
+    FB_CHECK_NEAR(scene.face.modifiers[0], 1.0f, 1e-5f);
+    FB_CHECK(scene.face.data.overrideMood == 10);
+    FB_CHECK_NEAR(scene.face.data.overrideValue, 0.5f, 1e-5f);
+    FB_CHECK(scene.face.data.exprOverride);  // the game's expression AI leaves the mood alone
+    FB_CHECK(scene.vm.names.empty());
+
+    // Clearing sets the slot back to neutral.
+    FB::Morph::Clear(&scene.actor, "Aah");
+    scene.Frame();
+    FB_CHECK(scene.face.phonemes[0] == 0.0f);
+}
+
+FB_TEST(NativeExpressionsFallBackWithoutFace) {
+    Scene scene(0x50000002);
+    scene.actor.faceGen = nullptr;  // head not loaded
+    FB::Morph::SetNativeExpressions(true);
+
+    FB::Morph::Set(&scene.actor, "Aah", 40.0f);
+    FB::Morph::Set(&scene.actor, "BlinkL", 1.0f);
+    FB::Morph::Set(&scene.actor, "Happy", 50.0f);
+    scene.Frame();
+
+    FB_CHECK(scene.vm.names.size() == 3);
+    FB_CHECK(std::find(scene.vm.names.begin(), scene.vm.names.end(), "SetExpressionPhoneme") != scene.vm.names.end());
+    FB_CHECK(std::find(scene.vm.names.begin(), scene.vm.names.end(), "SetExpressionModifier") !=
+             scene.vm.names.end());
+    FB_CHECK(std::find(scene.vm.names.begin(), scene.vm.names.end(), "SetExpressionOverride") !=
+             scene.vm.names.end());
+}
+
+FB_TEST(PapyrusExpressionsWhenNativeIsOff) {
+    Scene scene(0x50000003);
+    FB::Morph::SetNativeExpressions(false);
+    FB_CHECK(std::string(FB::Morph::ExpressionBackendName()) == "Papyrus");
+
+    FB::Morph::Set(&scene.actor, "Aah", 40.0f);
+    scene.Frame();
+    FB_CHECK(scene.vm.names.size() == 1 && scene.vm.names[0] == "SetExpressionPhoneme");
+    FB_CHECK(scene.face.phonemes[0] == 0.0f);  // face data untouched
+}
+
+FB_TEST(ExpressionWritesBatchPerFlush) {
+    Scene scene(0x50000004);
+    RecordingSink sink;
+    FB::Morph::SetExpressionSink(&sink);
+
+    FB::Morph::Set(&scene.actor, "Aah", 0.2f);
+    FB::Morph::Set(&scene.actor, "BlinkL", 0.5f);
+    FB::Morph::Set(&scene.actor, "Aah", 0.6f);  // same slot: replaces the first write
+    FB::Morph::Set(&scene.actor, "Happy", 0.3f);
+    FB::Morph::Set(&scene.actor, "Sad", 0.4f);  // single mood slot
+    scene.Frame();
+
+    FB_CHECK(sink.submits == 1);
+    FB_CHECK(sink.last.size() == 3);
+    if (sink.last.size() == 3) {
+        FB_CHECK(sink.last[0].kind == ExpressionWrite::Kind::Phoneme && sink.last[0].value == 0.6f);
+        FB_CHECK(sink.last[1].kind == ExpressionWrite::Kind::Modifier && sink.last[1].index == 0);
+        FB_CHECK(sink.last[2].kind == ExpressionWrite::Kind::Mood && sink.last[2].index == 11);
+    }
+
+    FB::Morph::SetExpressionSink(nullptr);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
@@ -0,0 +1,241 @@
+// FB::Fx sounds against a stand-in audio backend: starts, the per-actor voice pool stealing the
+// oldest voice, voices that finished on their own, failed starts and unloading. Visual effects
+// against a stand-in visual backend: one instance per (effect, node), refreshes, detaching by
+// timeline and on unload. And the config resolving Fx keys to forms only once game data has loaded.
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "FBFx.h"
+#include "FBTest.h"
+
+namespace {
+    // Voices play until stopped or finished by the test.
+    class CountingAudio final : public FB::Fx::IAudioBackend {
+    public:
+        const char* Name() const override { return "Counting"; }
+
+        std::uint64_t Start(RE::Actor*, RE::BGSSoundDescriptorForm*) override {
+            if (refuse) {
+                return 0;
+            }
+            ++starts;
+            playing.insert(++lastVoice);
+            return lastVoice;
+        }
+
+        void Stop(std::uint64_t voice) override {
+            ++stops;
+            playing.erase(voice);
+        }
+
+        bool IsPlaying(std::uint64_t voice) override { return playing.count(voice) != 0; }
+
+        std::uint32_t starts = 0;
+        std::uint32_t stops = 0;
+        std::uint64_t lastVoice = 0;
+        std::set<std::uint64_t> playing;
+        bool refuse = false;
+    };
+
+    // Instances stay attached until detached or finished by the test.
+    class CountingVisuals final : public FB::Fx::IVisualBackend {
+    public:
+        const char* Name() const override { return "Counting"; }
+
+        std::uint64_t Attach(RE::Actor*, RE::TESForm*, std::string_view, float) override {
+            ++attaches;
+            attached.insert(++lastInstance);
+            return lastInstance;
+        }
+
+        bool Refresh(std::uint64_t instance, float) override {
+            ++refreshes;
+            return attached.count(instance) != 0;
+        }
+
+        void Detach(std::uint64_t instance) override {
+            ++detaches;
+            attached.erase(instance);
+        }
+
+        std::uint32_t attaches = 0;
+        std::uint32_t refreshes = 0;
+        std::uint32_t detaches = 0;
+        std::uint64_t lastInstance = 0;
+        std::set<std::uint64_t> attached;
+    };
+
+    struct Scene {
+        Scene() {
+            Standin::RegisterForm(&actor);
+            FB::Fx::SetAudioBackend(&audio);
+            FB::Fx::SetVisualBackend(&visuals);
+            FB::Fx::SetVoicesPerActor(2);
+        }
+
+        ~Scene() {
+            FB::Fx::SetAudioBackend(nullptr);
+            FB::Fx::SetVisualBackend(nullptr);
+            FB::Fx::SetVoicesPerActor(4);
+        }
+
+        RE::Actor actor{0x60000001};
+        RE::BGSSoundDescriptorForm sound{0x60000100};
+        RE::TESEffectShader shader{0x60000200};
+        RE::BGSArtObject art{0x60000300};
+        CountingAudio audio;
+        CountingVisuals visuals;
+    };
+
+    const FBCommand* FindFx(const Snapshot& snap, std::string_view opcode) {
+        for (const auto& [key, list] : snap.scripts) {
+            for (const auto& tc : list) {
+                if (tc.command.type == FBCommandType::Fx && tc.command.opcode == opcode) {
+                    return &tc.command;
+                }
+            }
+        }
+        return nullptr;
+    }
+}
+
+FB_TEST(FxStealsOldestVoiceWhenPoolIsFull) {
+    Scene scene;
+    const auto before = FB::Fx::GetAudioStats();
+
+    FB_CHECK(FB::Fx::Play_MainThread(&scene.actor, &scene.sound));
+    FB_CHECK(FB::Fx::Play_MainThread(&scene.actor, &scene.sound));
+    FB_CHECK(scene.audio.stops == 0);
+
+    // Third sound on a pool of two: the first voice is stopped to make room.
+    FB_CHECK(FB::Fx::Play_MainThread(&scene.actor, &scene.sound));
+    FB_CHECK(scene.audio.starts == 3);
+    FB_CHECK(scene.audio.stops == 1);
+    FB_CHECK(scene.audio.playing.count(1) == 0 && scene.audio.playing.size() == 2);
+
+    const auto after = FB::Fx::GetAudioStats();
+    FB_CHECK(after.starts - before.starts == 3);
+    FB_CHECK(after.stops - before.stops == 1);
+    FB_CHECK(after.steals - before.steals == 1);
+    FB_CHECK(after.voices == 2);
+}
+
+FB_TEST(FxFinishedVoicesFreeTheirSlot) {
+    Scene scene;
+    FB::Fx::Play_MainThread(&scene.actor, &scene.sound);
+    FB::Fx::Play_MainThread(&scene.actor, &scene.sound);
+    scene.audio.playing.erase(1);  // the first sound ended by itself
+
+    const auto before = FB::Fx::GetAudioStats();
+    FB_CHECK(FB::Fx::Play_MainThread(&scene.actor, &scene.sound));
+    const auto after = FB::Fx::GetAudioStats();
+    FB_CHECK(after.steals == before.steals);
+    FB_CHECK(scene.audio.stops == 0);
+    FB_CHECK(after.voices == 2);
+}
+
+FB_TEST(FxCountsFailedStartsAndStopsOnUnload) {
+    Scene scene;
+    FB::Fx::Play_MainThread(&scene.actor, &scene.sound);
+    FB::Fx::Play_MainThread(&scene.actor, &scene.sound);
+
+    scene.audio.refuse = true;
+    const auto before = FB::Fx::GetAudioStats();
+    FB_CHECK(!FB::Fx::Play_MainThread(&scene.actor, &scene.sound));
+    FB_CHECK(FB::Fx::GetAudioStats().failed - before.failed == 1);
+
+    // Unloading stops whatever is still playing and forgets the pool.
+    FB::Fx::ForgetActor(scene.actor.formID);
+    FB_CHECK(scene.audio.playing.empty());
+    FB_CHECK(FB::Fx::GetAudioStats().voices == 0);
+    FB_CHECK(FB::Fx::GetAudioStats().stops - before.stops == scene.audio.stops);
+}
+
+FB_TEST(FxVisualsAttachOncePerEffectAndNode) {
+    Scene scene;
+    const auto before = FB::Fx::GetVisualStats();
+
+    FB_CHECK(FB::Fx::Show_MainThread(&scene.actor, &scene.shader, "", 2.0f, 1));
+    FB_CHECK(FB::Fx::Show_MainThread(&scene.actor, &scene.art, "NPC Head [Head]", -1.0f, 1));
+    FB_CHECK(FB::Fx::Show_MainThread(&scene.actor, &scene.art, "NPC Spine2 [Spn2]", -1.0f, 1));
+
+    // Firing one that is still attached refreshes it; one that finished is attached again.
+    FB_CHECK(FB::Fx::Show_MainThread(&scene.actor, &scene.shader, "", 2.0f, 1));
+    scene.visuals.attached.erase(2);
+    FB_CHECK(FB::Fx::Show_MainThread(&scene.actor, &scene.art, "NPC Head [Head]", -1.0f, 1));
+
+    FB_CHECK(scene.visuals.attaches == 4);
+    FB_CHECK(scene.visuals.attached.size() == 3);
+    const auto after = FB::Fx::GetVisualStats();
+    FB_CHECK(after.attaches - before.attaches == 4);
+    FB_CHECK(after.refreshes - before.refreshes == 1);
+    FB_CHECK(after.detaches == before.detaches);
+    FB_CHECK(after.attached == 3);
+}
+
+FB_TEST(FxVisualsDetachByTimelineAndOnUnload) {
+    Scene scene;
+    RE::Actor other(0x60000002);
+    Standin::RegisterForm(&other);
+
+    FB::Fx::Show_MainThread(&scene.actor, &scene.shader, "", -1.0f, 1);
+    FB::Fx::Show_MainThread(&scene.actor, &scene.art, "NPC Head [Head]", -1.0f, 2);
+    FB::Fx::Show_MainThread(&other, &scene.shader, "", -1.0f, 1);
+    FB::Fx::Show_MainThread(&other, &scene.art, "NPC Head [Head]", -1.0f, 2);
+    // Timeline 2 fires the shader again: it owns that instance now.
+    FB::Fx::Show_MainThread(&other, &scene.shader, "", -1.0f, 2);
+
+    const auto before = FB::Fx::GetVisualStats();
+    FB::Fx::DetachSource(1);
+    FB_CHECK(scene.visuals.detaches == 1);
+    FB_CHECK(scene.visuals.attached.size() == 3);
+    FB_CHECK(FB::Fx::GetVisualStats().detaches - before.detaches == 1);
+
+    FB::Fx::DetachSource(1);  // nothing left of timeline 1
+    FB_CHECK(scene.visuals.detaches == 1);
+
+    FB::Fx::ForgetActor(other.formID);
+    FB_CHECK(scene.visuals.detaches == 3);
+    FB_CHECK(scene.visuals.attached.size() == 1);
+
+    const auto after = FB::Fx::GetVisualStats();
+    FB_CHECK(after.detaches - before.detaches == 3);
+    FB_CHECK(after.attached == 1);
+    FB_CHECK(after.attaches - before.attaches == 0);
+}
+
+FB_TEST(FxKeysResolveOnceDataHasLoaded) {
+    RE::BGSSoundDescriptorForm byPlugin(0x05000D62), byId(0x0001A2B3), byEditorId(0x0001A2B4);
+    RE::TESEffectShader shader(0x0001A2B5);
+    for (RE::TESForm* form : std::initializer_list<RE::TESForm*>{&byPlugin, &byId, &byEditorId, &shader}) {
+        Standin::RegisterForm(form);
+    }
+    Standin::RegisterPluginForm("FBTest.esp", 0x000D62, &byPlugin);
+    Standin::SetEditorID("FBTestGrunt", &byEditorId);
+
+    const auto build = [](std::string_view name, std::string_view key) {
+        return FBTest::BuildSnapshot(name,
+                                     "[General]\nHkxAnnotations=false\nStatsLogInterval=0\n\n"
+                                     "[FBFiles]\nFBFx=FBFx.hkx\n\n"
+                                     "[SoundMap]\nPlugin=FBTest.esp|0x000D62\nFull=0x0001A2B3\nEditor=FBTestGrunt\n"
+                                     "WrongType=0x0001A2B5\n",
+                                     "FBFx", "[FB:FBFx.hkx|Caster]\n0.10 FBFx_Play(" + std::string(key) + ")\n");
+    };
+
+    // Before kDataLoaded there are no forms to find: nothing is looked up.
+    auto early = build("FxKeysEarly", "Plugin");
+    FB_CHECK(early && FindFx(*early, "Play") && FindFx(*early, "Play")->form == nullptr);
+
+    FBConfig::SetFormsLoaded();
+    const std::pair<const char*, RE::TESForm*> cases[] = {
+        {"Plugin", &byPlugin}, {"Full", &byId}, {"Editor", &byEditorId}, {"WrongType", nullptr}};
+    for (const auto& [key, expected] : cases) {
+        auto snap = build(std::string("FxKeys") + key, key);
+        const FBCommand* cmd = snap ? FindFx(*snap, "Play") : nullptr;
+        FB_CHECK(cmd && cmd->form == expected);
+    }
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
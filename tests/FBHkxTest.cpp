@@ -0,0 +1,242 @@
+// FB::Hkx against synthetic packfiles: the FB annotations of an animation's tracks for 32- and
+// 64-bit layouts, tagfiles and damaged images rejected without reading out of bounds, and the
+// annotation cache surviving a corrupt cache file.
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FBHkx.h"
+#include "FBTest.h"
+
+namespace {
+    using Track = std::vector<std::pair<float, std::string>>;
+
+    // A minimal hk_2010 packfile: a __classnames__ section naming the class, and a __data__
+    // section holding one animation object, its annotation tracks and their strings, linked by
+    // local fixups. Offsets match FBHkx.cpp's Layout for the pointer size.
+    class PackfileBuilder {
+    public:
+        explicit PackfileBuilder(std::size_t ptr) : _ptr(ptr) {}
+
+        std::vector<std::byte> Build(const std::vector<Track>& tracks,
+                                     std::string_view className = "hkaSplineCompressedAnimation") {
+            const std::size_t tracksField = _ptr == 8 ? 40 : 28;
+            const std::size_t trackSize = _ptr == 8 ? 24 : 16;
+            const std::size_t annotationSize = _ptr == 8 ? 16 : 8;
+
+            _data.assign(tracksField + 2 * _ptr, std::byte{0});
+            _fixups.clear();
+
+            const std::size_t trackArray = Reserve(tracks.size() * trackSize);
+            Pointer(tracksField, trackArray);
+            Put32(tracksField + _ptr, static_cast<std::uint32_t>(tracks.size()));
+
+            for (std::size_t t = 0; t < tracks.size(); ++t) {
+                const std::size_t track = trackArray + t * trackSize;
+                Pointer(track, String("FBTrack" + std::to_string(t)));
+
+                const std::size_t records = Reserve(tracks[t].size() * annotationSize);
+                Pointer(track + _ptr, records);
+                Put32(track + 2 * _ptr, static_cast<std::uint32_t>(tracks[t].size()));
+                for (std::size_t a = 0; a < tracks[t].size(); ++a) {
+                    const std::size_t record = records + a * annotationSize;
+                    std::memcpy(&_data[record], &tracks[t][a].first, sizeof(float));
+                    Pointer(record + _ptr, String(tracks[t][a].second));
+                }
+            }
+
+            std::vector<std::byte> classNames(className.size() + 1, std::byte{0});
+            std::memcpy(classNames.data(), className.data(), className.size());
+
+            std::vector<std::byte> localFixups;
+            for (const auto& [src, dst] : _fixups) {
+                Append32(localFixups, src);
+                Append32(localFixups, dst);
+            }
+            std::vector<std::byte> virtualFixups;
+            Append32(virtualFixups, 0);  // object at 0, class name at offset 0 of section 0
+            Append32(virtualFixups, 0);
+            Append32(virtualFixups, 0);
+
+            std::vector<std::byte> file(64 + 2 * 48, std::byte{0});
+            Write32(file, 0, 0x57E0E057);
+            Write32(file, 4, 0x10C0C010);
+            Write32(file, 12, 8);  // hk_2010
+            file[16] = static_cast<std::byte>(_ptr);
+            file[17] = std::byte{1};  // little-endian
+            Write32(file, 20, 2);
+            AddSection(file, 64, "__classnames__", classNames, {}, {});
+            AddSection(file, 64 + 48, "__data__", _data, localFixups, virtualFixups);
+            return file;
+        }
+
+    private:
+        std::size_t Reserve(std::size_t size) {
+            const std::size_t at = (_data.size() + 15) & ~std::size_t{15};
+            _data.resize(at + size, std::byte{0});
+            return at;
+        }
+
+        std::size_t String(std::string_view text) {
+            const std::size_t at = Reserve(text.size() + 1);
+            std::memcpy(&_data[at], text.data(), text.size());
+            return at;
+        }
+
+        void Pointer(std::size_t field, std::size_t target) {
+            _fixups.emplace_back(static_cast<std::uint32_t>(field), static_cast<std::uint32_t>(target));
+        }
+
+        void Put32(std::size_t at, std::uint32_t value) { Write32(_data, at, value); }
+
+        static void Write32(std::vector<std::byte>& out, std::size_t at, std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out[at + i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+            }
+        }
+
+        static void Append32(std::vector<std::byte>& out, std::uint32_t value) {
+            out.resize(out.size() + 4);
+            Write32(out, out.size() - 4, value);
+        }
+
+        // Section header: tag, then the section's start and its table offsets relative to it.
+        static void AddSection(std::vector<std::byte>& file, std::size_t header, std::string_view tag,
+                               const std::vector<std::byte>& data, const std::vector<std::byte>& localFixups,
+                               const std::vector<std::byte>& virtualFixups) {
+            const auto start = static_cast<std::uint32_t>(file.size());
+            const auto local = static_cast<std::uint32_t>(data.size());
+            const auto global = local + static_cast<std::uint32_t>(localFixups.size());
+            const auto exports = global + static_cast<std::uint32_t>(virtualFixups.size());
+
+            std::memcpy(&file[header], tag.data(), tag.size());
+            Write32(file, header + 20, start);
+            Write32(file, header + 24, local);
+            Write32(file, header + 28, global);
+            Write32(file, header + 32, global);  // virtual fixups
+            Write32(file, header + 36, exports);
+            Write32(file, header + 40, exports);  // imports
+            Write32(file, header + 44, exports);  // end
+
+            file.insert(file.end(), data.begin(), data.end());
+            file.insert(file.end(), localFixups.begin(), localFixups.end());
+            file.insert(file.end(), virtualFixups.begin(), virtualFixups.end());
+        }
+
+        std::size_t _ptr;
+        std::vector<std::byte> _data;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> _fixups;
+    };
+
+    const std::vector<Track> kTracks{
+        {{0.5f, "FBScale_Head(1.2)"}, {0.75f, "SoundPlay.NPCHumanFootstep"}},
+        {{1.25f, "2_FBMorph_Belly(0.5)"}},
+    };
+
+    void WriteBytes(const std::filesystem::path& path, const std::vector<std::byte>& bytes) {
+        FBTest::WriteText(path, std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    }
+}
+
+FB_TEST(HkxReadsFBAnnotations) {
+    for (const std::size_t ptr : {std::size_t{4}, std::size_t{8}}) {
+        const auto image = PackfileBuilder(ptr).Build(kTracks);
+        std::vector<FB::Hkx::Annotation> out;
+        FB_CHECK(FB::Hkx::ParseAnnotations(image, out));
+        FB_CHECK(out.size() == 2);
+        if (out.size() == 2) {
+            FB_CHECK(out[0].time == 0.5f && out[0].text == "FBScale_Head(1.2)");
+            FB_CHECK(out[1].time == 1.25f && out[1].text == "2_FBMorph_Belly(0.5)");
+        }
+    }
+
+    // Objects that are not animations are not read.
+    const auto skeleton = PackfileBuilder(8).Build(kTracks, "hkaSkeleton");
+    std::vector<FB::Hkx::Annotation> out;
+    FB_CHECK(FB::Hkx::ParseAnnotations(skeleton, out));
+    FB_CHECK(out.empty());
+}
+
+FB_TEST(HkxRejectsTagfilesAndDamagedImages) {
+    spdlog::set_level(spdlog::level::err);
+    std::vector<FB::Hkx::Annotation> out;
+
+    auto tagfile = PackfileBuilder(8).Build(kTracks);
+    const std::uint32_t tagMagic[2] = {0xCAB00D1E, 0xD011FACE};
+    std::memcpy(tagfile.data(), tagMagic, sizeof(tagMagic));
+    FB_CHECK(!FB::Hkx::ParseAnnotations(tagfile, out));
+
+    auto bigEndian = PackfileBuilder(8).Build(kTracks);
+    bigEndian[17] = std::byte{0};
+    FB_CHECK(!FB::Hkx::ParseAnnotations(bigEndian, out));
+    FB_CHECK(out.empty());
+
+    // Every truncation: no reads past the end, and never more than the whole file's annotations.
+    const auto image = PackfileBuilder(8).Build(kTracks);
+    for (std::size_t size = 0; size < image.size(); ++size) {
+        std::vector<FB::Hkx::Annotation> partial;
+        FB::Hkx::ParseAnnotations(std::span(image).first(size), partial);
+        FB_CHECK(partial.size() <= 2);
+    }
+
+    // A track count past the limit reads no tracks.
+    auto corrupt = PackfileBuilder(8).Build(kTracks);
+    const std::size_t dataStart = 64 + 2 * 48 + std::string_view("hkaSplineCompressedAnimation").size() + 1;
+    const std::uint32_t hugeCount = 0x7FFFFFFF;
+    std::memcpy(&corrupt[dataStart + 40 + 8], &hugeCount, sizeof(hugeCount));
+    FB_CHECK(FB::Hkx::ParseAnnotations(corrupt, out));
+    FB_CHECK(out.empty());
+
+    spdlog::set_level(spdlog::level::warn);
+}
+
+FB_TEST(HkxRebuildsCorruptCache) {
+    spdlog::set_level(spdlog::level::err);
+    const auto dir = FBTest::ScratchDir("HkxRebuildsCorruptCache");
+    const auto clip = dir / "FBClip.hkx";
+    const auto cachePath = dir / "FullBodiedAnnotations.cache";
+    WriteBytes(clip, PackfileBuilder(8).Build(kTracks));
+
+    // A valid header, then an entry claiming four billion annotations.
+    std::vector<std::byte> cache;
+    const auto append = [&](const void* p, std::size_t n) {
+        const auto* b = static_cast<const std::byte*>(p);
+        cache.insert(cache.end(), b, b + n);
+    };
+    const std::uint32_t header[3] = {0x43414246, 1, 1};
+    append(header, sizeof(header));
+    const std::string key = clip.generic_string();
+    const auto keySize = static_cast<std::uint32_t>(key.size());
+    append(&keySize, sizeof(keySize));
+    append(key.data(), key.size());
+    const std::uint64_t sizeMtimeHash[3] = {0, 0, 0};
+    append(sizeMtimeHash, sizeof(sizeMtimeHash));
+    const std::uint8_t valid = 1;
+    append(&valid, sizeof(valid));
+    const std::uint32_t annotations = 0xFFFFFFFF;
+    append(&annotations, sizeof(annotations));
+    WriteBytes(cachePath, cache);
+
+    FB::Hkx::SetCachePath(cachePath);
+    const auto before = FB::Hkx::GetStats();
+    std::vector<FB::Hkx::Annotation> out;
+    FB_CHECK(FB::Hkx::GetAnnotations(clip, out));
+    FB_CHECK(out.size() == 2);
+    FB_CHECK(FB::Hkx::GetStats().parsed - before.parsed == 1);
+
+    // The rewritten cache loads and serves the clip without parsing it.
+    FB::Hkx::SaveCache();
+    FB::Hkx::SetCachePath(cachePath);
+    out.clear();
+    FB_CHECK(FB::Hkx::GetAnnotations(clip, out));
+    FB_CHECK(out.size() == 2);
+    const auto after = FB::Hkx::GetStats();
+    FB_CHECK(after.hits - before.hits == 1);
+    FB_CHECK(after.parsed - before.parsed == 1);
+
+    spdlog::set_level(spdlog::level::warn);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
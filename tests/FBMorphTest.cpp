@@ -0,0 +1,321 @@
+// FB::Morph body-morph backends: SKEE found through the interface exchange, one batch per actor
+// per flush, and the per-call cost of each sink (a no-op sink, SKEE's interface, the Papyrus
+// bridge through FB::Dispatch) on the stand-in engine. Also the shadow of applied values: a write
+// dropped before it reaches the engine must not suppress the next one.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBDispatch.h"
+#include "FBMorph.h"
+#include "FBSkee.h"
+#include "FBTest.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::uint32_t kActors = 100;
+    constexpr std::uint32_t kMorphsPerActor = 8;
+    constexpr std::uint32_t kFrames = 100;
+
+    // RaceMenu's BodyMorph interface, counting the calls FB::Morph makes.
+    class FakeBodyMorphs final : public SKEE::IBodyMorphInterface {
+    public:
+        std::uint32_t GetVersion() override { return 4; }
+        void Revert() override {}
+
+        void SetMorph(RE::TESObjectREFR*, const char*, const char* morphKey, float) override {
+            ++sets;
+            keyed = keyed && std::strcmp(morphKey, FB::Morph::kMorphKey) == 0;
+        }
+        float GetMorph(RE::TESObjectREFR*, const char*, const char*) override { return 0.0f; }
+        void ClearMorph(RE::TESObjectREFR*, const char*, const char* morphKey) override {
+            ++clears;
+            keyed = keyed && std::strcmp(morphKey, FB::Morph::kMorphKey) == 0;
+        }
+        float GetBodyMorphs(RE::TESObjectREFR*, const char*) override { return 0.0f; }
+        void ClearBodyMorphNames(RE::TESObjectREFR*, const char*) override {}
+        void VisitMorphs(RE::TESObjectREFR*, MorphVisitor&) override {}
+        void VisitKeys(RE::TESObjectREFR*, const char*, MorphKeyVisitor&) override {}
+        void VisitMorphValues(RE::TESObjectREFR*, MorphValueVisitor&) override {}
+        void ClearMorphs(RE::TESObjectREFR*) override {}
+        void ApplyVertexDiff(RE::TESObjectREFR*, RE::NiAVObject*, bool) override {}
+        void ApplyBodyMorphs(RE::TESObjectREFR*, bool) override { ++applies; }
+        void UpdateModelWeight(RE::TESObjectREFR*, bool) override { ++weights; }
+
+        std::uint64_t sets = 0;
+        std::uint64_t clears = 0;
+        std::uint64_t applies = 0;
+        std::uint64_t weights = 0;
+        bool keyed = true;  // every call used our morph key
+    };
+
+    class FakeInterfaceMap final : public SKEE::IInterfaceMap {
+    public:
+        explicit FakeInterfaceMap(SKEE::IPluginInterface* bodyMorph) : _bodyMorph(bodyMorph) {}
+
+        SKEE::IPluginInterface* QueryInterface(const char* name) override {
+            return std::strcmp(name, "BodyMorph") == 0 ? _bodyMorph : nullptr;
+        }
+        bool AddInterface(const char*, SKEE::IPluginInterface*) override { return false; }
+        SKEE::IPluginInterface* RemoveInterface(const char*) override { return nullptr; }
+
+    private:
+        SKEE::IPluginInterface* _bodyMorph;
+    };
+
+    // FB::Morph keeps the backend InitBackend found for the rest of the process.
+    FakeBodyMorphs g_skee;
+    FakeInterfaceMap g_interfaceMap{&g_skee};
+
+    void InstallSkee() {
+        Standin::SetMessageReceiver("SKEE", [](std::uint32_t type, void* data) {
+            if (type != SKEE::InterfaceExchangeMessage::kExchangeInterface || !data) {
+                return false;
+            }
+            static_cast<SKEE::InterfaceExchangeMessage*>(data)->interfaceMap = &g_interfaceMap;
+            return true;
+        });
+        FB::Morph::InitBackend();
+    }
+
+    class NullSink final : public FB::Morph::IBodyMorphSink {
+    public:
+        const char* Name() const override { return "Null"; }
+        void Submit(RE::Actor*, std::span<const RE::BSFixedString>, std::span<const float>,
+                    std::span<const RE::BSFixedString>) override {
+            ++batches;
+        }
+
+        std::uint64_t batches = 0;
+    };
+
+    // Runs every call at once and reports it complete, so FB::Dispatch never waits on the VM.
+    class InstantVm final : public FB::Dispatch::IVirtualMachineBackend {
+    public:
+        bool Dispatch(const FB::Dispatch::VmCall& call,
+                      RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>& callback) override {
+            ++calls;
+            delete call.args;  // the VM owns the arguments
+            (*callback)(RE::BSScript::Variable{});
+            return true;
+        }
+
+        std::uint64_t calls = 0;
+    };
+
+    struct Actors {
+        Actors() {
+            for (std::uint32_t i = 0; i < kActors; ++i) {
+                auto& a = list.emplace_back(std::make_unique<RE::Actor>(0x30000001 + i));
+                a->root3D = &root;
+                Standin::RegisterForm(a.get());
+            }
+        }
+
+        RE::NiNode root{"NPC Root [Root]"};
+        std::vector<std::unique_ptr<RE::Actor>> list;
+    };
+
+    std::array<std::string, kMorphsPerActor> MorphNames() {
+        std::array<std::string, kMorphsPerActor> names;
+        for (std::uint32_t m = 0; m < kMorphsPerActor; ++m) {
+            names[m] = "FBMorphTest" + std::to_string(m);
+        }
+        return names;
+    }
+
+    // Every morph of every actor changes each frame; returns ns per morph write, flush included.
+    double TimeFrames(Actors& actors, bool pumpDispatch) {
+        const auto names = MorphNames();
+        const auto start = Clock::now();
+        for (std::uint32_t f = 0; f < kFrames; ++f) {
+            const float value = static_cast<float>(f % 2);
+            for (const auto& a : actors.list) {
+                for (const auto& name : names) {
+                    FB::Morph::Set(a.get(), name, value);
+                }
+            }
+            FB::Morph::Flush_MainThread();
+            if (pumpDispatch) {
+                FB::Dispatch::Pump();
+            }
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return ns / (static_cast<double>(kFrames) * kActors * kMorphsPerActor);
+    }
+}
+
+FB_TEST(SkeeBackendBatchesPerActor) {
+    InstallSkee();
+    FB_CHECK(std::strcmp(FB::Morph::BackendName(), "SKEE") == 0);
+
+    Actors actors;
+    const auto names = MorphNames();
+    const auto before = g_skee;
+    for (const auto& a : actors.list) {
+        for (const auto& name : names) {
+            FB::Morph::Set(a.get(), name, 0.5f);
+        }
+    }
+    FB::Morph::Flush_MainThread();
+    FB_CHECK(g_skee.sets - before.sets == kActors * kMorphsPerActor);
+    FB_CHECK(g_skee.applies - before.applies == kActors);
+    FB_CHECK(g_skee.weights - before.weights == kActors);
+    FB_CHECK(g_skee.keyed);
+
+    // Unchanged values are suppressed by the shadow: nothing to rebuild.
+    const auto settled = g_skee;
+    for (const auto& name : names) {
+        FB::Morph::Set(actors.list[0].get(), name, 0.5f);
+    }
+    FB::Morph::Flush_MainThread();
+    FB_CHECK(g_skee.sets == settled.sets && g_skee.applies == settled.applies);
+
+    // A clear and a set on one actor: one rebuild.
+    FB::Morph::Clear(actors.list[0].get(), names[0]);
+    FB::Morph::Set(actors.list[0].get(), names[1], 0.75f);
+    FB::Morph::Flush_MainThread();
+    FB_CHECK(g_skee.clears - settled.clears == 1);
+    FB_CHECK(g_skee.sets - settled.sets == 1);
+    FB_CHECK(g_skee.applies - settled.applies == 1);
+}
+
+FB_TEST(SinkPerCallOverhead) {
+    InstallSkee();
+    Actors actors;
+
+    NullSink null;
+    FB::Morph::SetSink(&null);
+    const double nullNs = TimeFrames(actors, false);
+    FB_CHECK(null.batches == static_cast<std::uint64_t>(kFrames) * kActors);
+
+    FB::Morph::SetSink(nullptr);
+    const auto skeeBefore = g_skee.applies;
+    const double skeeNs = TimeFrames(actors, false);
+    FB_CHECK(g_skee.applies - skeeBefore == static_cast<std::uint64_t>(kFrames) * kActors);
+
+    // The Papyrus bridge: FB::Dispatch merges per actor and sends through the VM backend.
+    InstantVm vm;
+    FB::Dispatch::SetBackend(&vm);
+    FB::Dispatch::SetBudget(kActors);
+    Standin::SetMessageReceiver("SKEE", {});
+    FB::Morph::InitBackend();
+    FB_CHECK(std::strcmp(FB::Morph::BackendName(), "Papyrus") == 0);
+    const double papyrusNs = TimeFrames(actors, true);
+    FB_CHECK(vm.calls == static_cast<std::uint64_t>(kFrames) * kActors);
+    FB::Dispatch::SetBackend(nullptr);
+    FB::Dispatch::SetBudget(8);
+
+    std::printf("  ns per morph write, %u actors x %u morphs: null %.0f, SKEE %.0f, Papyrus bridge %.0f\n", kActors,
+                kMorphsPerActor, nullNs, skeeNs, papyrusNs);
+}
+
+namespace {
+    // Refuses every call, like a VM that is not accepting them.
+    class RefusingVm final : public FB::Dispatch::IVirtualMachineBackend {
+    public:
+        bool Dispatch(const FB::Dispatch::VmCall& call,
+                      RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor>&) override {
+            ++calls;
+            delete call.args;
+            return false;
+        }
+
+        std::uint64_t calls = 0;
+    };
+
+    // The Papyrus backends, so writes go through FB::Dispatch.
+    void UsePapyrusBackends() {
+        Standin::SetMessageReceiver("SKEE", {});
+        FB::Morph::InitBackend();
+        FB::Morph::SetSink(nullptr);
+        FB::Morph::SetNativeExpressions(false);
+        FB::Dispatch::SetBudget(64);
+    }
+}
+
+FB_TEST(ShadowRollsBackWhenFlushDropsBatch) {
+    NullSink sink;
+    FB::Morph::SetSink(&sink);
+
+    RE::Actor actor(0x30001001);
+    Standin::RegisterForm(&actor);
+    FB::Morph::Set(&actor, "FBShadowDrop", 0.5f);
+    FB::Morph::Set(&actor, "Aah", 40.0f);
+    FB_CHECK(FB::Morph::GetApplied(actor.formID, "FBShadowDrop") == 0.5f);
+
+    // Unloaded before the flush: the batch never reaches the sink, nor does the shadow keep it.
+    Standin::UnregisterForm(&actor);
+    FB::Morph::Flush_MainThread();
+    FB_CHECK(sink.batches == 0);
+    FB_CHECK(!FB::Morph::GetApplied(actor.formID, "FBShadowDrop"));
+    FB_CHECK(!FB::Morph::GetApplied(actor.formID, "Aah"));
+
+    // The same value is sent again once the actor is back.
+    Standin::RegisterForm(&actor);
+    FB::Morph::Set(&actor, "FBShadowDrop", 0.5f);
+    FB::Morph::Flush_MainThread();
+    FB_CHECK(sink.batches == 1);
+
+    FB::Morph::SetSink(nullptr);
+}
+
+FB_TEST(ShadowRollsBackWhenVmRefuses) {
+    UsePapyrusBackends();
+    RefusingVm refusing;
+    FB::Dispatch::SetBackend(&refusing);
+
+    RE::Actor actor(0x30001002);
+    Standin::RegisterForm(&actor);
+    FB::Morph::Set(&actor, "FBShadowRefused", 0.5f);
+    FB::Morph::Set(&actor, "BigAah", 40.0f);
+    FB::Morph::Flush_MainThread();
+    const auto rejectedBefore = FB::Dispatch::GetStats().rejected;
+    FB::Dispatch::Pump();
+    FB_CHECK(refusing.calls == 2);  // the body-morph batch and the phoneme
+    FB_CHECK(FB::Dispatch::GetStats().rejected - rejectedBefore == 2);
+    FB_CHECK(!FB::Morph::GetApplied(actor.formID, "FBShadowRefused"));
+    FB_CHECK(!FB::Morph::GetApplied(actor.formID, "BigAah"));
+
+    // Retried with the same values, they are sent instead of suppressed.
+    InstantVm vm;
+    FB::Dispatch::SetBackend(&vm);
+    FB::Morph::Set(&actor, "FBShadowRefused", 0.5f);
+    FB::Morph::Set(&actor, "BigAah", 40.0f);
+    FB::Morph::Flush_MainThread();
+    FB::Dispatch::Pump();
+    FB_CHECK(vm.calls == 2);
+    FB_CHECK(FB::Morph::GetApplied(actor.formID, "FBShadowRefused") == 0.5f);
+
+    FB::Dispatch::Pump();  // retire
+    FB::Dispatch::SetBackend(nullptr);
+    FB::Morph::SetNativeExpressions(true);
+}
+
+FB_TEST(ShadowRollsBackWhenDispatchDropsEntry) {
+    UsePapyrusBackends();
+    InstantVm vm;
+    FB::Dispatch::SetBackend(&vm);
+
+    RE::Actor actor(0x30001003);
+    Standin::RegisterForm(&actor);
+    FB::Morph::Set(&actor, "FBShadowQueued", 0.5f);
+    FB::Morph::Flush_MainThread();  // queued in FB::Dispatch
+
+    // Unloaded while the call waits for the pump.
+    Standin::UnregisterForm(&actor);
+    FB::Dispatch::Pump();
+    FB_CHECK(vm.calls == 0);
+    FB_CHECK(!FB::Dispatch::HasPending());
+    FB_CHECK(!FB::Morph::GetApplied(actor.formID, "FBShadowQueued"));
+
+    FB::Dispatch::SetBackend(nullptr);
+    FB::Morph::SetNativeExpressions(true);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
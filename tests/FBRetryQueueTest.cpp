@@ -0,0 +1,111 @@
+// FBRetryQueue: exponential backoff on the wheel, give-up after kMaxAttempts, long gaps, and the
+// due time reported to the pump.
+
+#include <spdlog/spdlog.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "FBRetryQueue.h"
+#include "FBTest.h"
+
+namespace {
+    FBRetryItem MakeItem(std::uint32_t formID) {
+        FBRetryItem item;
+        item.kind = FBRetryItem::Kind::Channel;
+        item.formID = formID;
+        item.channelName = "NPC Head [Head]";
+        return item;
+    }
+
+    // Advances in 10 ms steps from `from` until the item comes back; returns when it did.
+    float CollectOne(FBRetryQueue& queue, float from, FBRetryItem& item) {
+        std::vector<FBRetryItem> out;
+        for (float now = from; now < from + 10.0f; now += 0.01f) {
+            queue.Collect(now, out);
+            if (!out.empty()) {
+                item = std::move(out.front());
+                return now;
+            }
+        }
+        return std::numeric_limits<float>::infinity();
+    }
+}
+
+FB_TEST(RetryBacksOffThenGivesUp) {
+    spdlog::set_level(spdlog::level::err);
+
+    FBRetryQueue queue;
+    FB_CHECK(std::isinf(queue.NextDueSeconds()));
+
+    auto item = MakeItem(0x14);
+    float now = 1.0f;
+    float lastDelay = 0.0f;
+    for (std::uint8_t attempt = 0; attempt < FBRetryQueue::kMaxAttempts; ++attempt) {
+        FB_CHECK(queue.Schedule(item, now));
+        FB_CHECK(queue.Size() == 1);
+        FB_CHECK(queue.NextDueSeconds() > now);
+
+        const float due = CollectOne(queue, now, item);
+        const float delay = due - now;
+        const float expected = FBRetryQueue::kSlotSeconds * static_cast<float>(1u << attempt);
+        FB_CHECK(item.event.retries == attempt + 1);
+        FB_CHECK(delay <= expected + FBRetryQueue::kSlotSeconds + 0.011f);
+        FB_CHECK(delay >= lastDelay);
+        lastDelay = delay;
+        now = due;
+    }
+    FB_CHECK(queue.Size() == 0);
+    FB_CHECK(std::isinf(queue.NextDueSeconds()));
+
+    FB_CHECK(!queue.Schedule(item, now));
+    FB_CHECK(queue.GiveUpCount() == 1);
+    FB_CHECK(queue.RetryCount() == FBRetryQueue::kMaxAttempts);
+
+    spdlog::set_level(spdlog::level::warn);
+}
+
+FB_TEST(RetryCollectsEverythingAfterLongGap) {
+    FBRetryQueue queue;
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        auto item = MakeItem(0x1000 + i);
+        item.event.retries = static_cast<std::uint8_t>(i % FBRetryQueue::kMaxAttempts);
+        FB_CHECK(queue.Schedule(std::move(item), 0.5f));
+    }
+    FB_CHECK(queue.Size() == 100);
+
+    // Nothing is due in the slot it was scheduled from.
+    std::vector<FBRetryItem> out;
+    queue.Collect(0.5f, out);
+    FB_CHECK(out.empty());
+
+    // A stall of many wheel turns: one Collect returns every item.
+    queue.Collect(0.5f + FBRetryQueue::kSlotSeconds * FBRetryQueue::kSlotCount * 10.0f, out);
+    FB_CHECK(out.size() == 100);
+    FB_CHECK(queue.Size() == 0);
+    FB_CHECK(std::isinf(queue.NextDueSeconds()));
+}
+
+FB_TEST(RetryReportsEarliestDue) {
+    FBRetryQueue queue;
+    auto slow = MakeItem(0x14);
+    slow.event.retries = 4;  // 0.8 s
+    FB_CHECK(queue.Schedule(slow, 2.0f));
+    const double slowDue = queue.NextDueSeconds();
+    FB_CHECK(slowDue >= 2.75 && slowDue <= 2.9);
+
+    FB_CHECK(queue.Schedule(MakeItem(0x15), 2.0f));  // 0.05 s
+    FB_CHECK(queue.NextDueSeconds() < 2.11);
+
+    std::vector<FBRetryItem> out;
+    queue.Collect(2.2f, out);
+    FB_CHECK(out.size() == 1 && out[0].formID == 0x15);
+    FB_CHECK(queue.NextDueSeconds() == slowDue);
+
+    queue.Clear();
+    FB_CHECK(queue.Size() == 0);
+    FB_CHECK(std::isinf(queue.NextDueSeconds()));
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
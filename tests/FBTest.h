@@ -0,0 +1,118 @@
+#pragma once
+
+// Minimal test harness: FB_TEST(name) { ... FB_CHECK(cond); ... } and a main() that returns
+// FBTest::RunAll(). Each test starts on a fresh stand-in engine (Standin::Reset).
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FBConfig.h"
+#include "Standin.h"
+
+namespace FBTest {
+    struct Case {
+        const char* name;
+        void (*fn)();
+    };
+
+    inline std::vector<Case>& Cases() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, void (*fn)()) { Cases().push_back({name, fn}); }
+    };
+
+    inline void Fail(const char* file, int line, const char* expr) {
+        ++Failures();
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    }
+
+    // An empty directory for this test under the system temp directory.
+    inline std::filesystem::path ScratchDir(std::string_view name) {
+        const auto dir = std::filesystem::temp_directory_path() / "fb_tests" / name;
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    inline void WriteText(const std::filesystem::path& path, std::string_view text) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    // A Data tree with `general` as FullBodiedIni.ini and `body` as the per-anim INI of clip
+    // `alias`.hkx, built into a snapshot (generation 1). Null if it did not parse.
+    inline std::shared_ptr<Snapshot> BuildSnapshot(std::string_view testName, std::string_view general,
+                                                   std::string_view alias = {}, std::string_view body = {}) {
+        const auto dataRoot = ScratchDir(testName) / "Data";
+        WriteText(dataRoot / "FullBodiedIni.ini", general);
+        if (!alias.empty()) {
+            const auto folder = dataRoot / "meshes" / "actors" / "character" / "animations" /
+                                "OpenAnimationReplacer" / "FBTest" / ("_variants_" + std::string(alias));
+            WriteText(folder / ("FB_" + std::string(alias) + ".ini"), body);
+        }
+
+        auto snap = std::make_shared<Snapshot>();
+        snap->generation = 1;
+        return FBConfig::BuildSnapshot(dataRoot, *snap) ? snap : nullptr;
+    }
+
+    // Runs the cases named on the command line, or all of them.
+    inline int RunAll(int argc = 0, char** argv = nullptr) {
+        spdlog::set_level(spdlog::level::warn);
+
+        int ran = 0;
+        for (const auto& c : Cases()) {
+            bool selected = argc <= 1;
+            for (int i = 1; i < argc; ++i) {
+                selected = selected || std::string_view(argv[i]) == c.name;
+            }
+            if (!selected) {
+                continue;
+            }
+
+            const int before = Failures();
+            const auto start = std::chrono::steady_clock::now();
+            Standin::Reset();
+            c.fn();
+            Standin::Reset();
+            const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            std::printf("%s %s (%.1f ms)\n", Failures() == before ? "[ ok ]" : "[FAIL]", c.name, ms.count());
+            ++ran;
+        }
+
+        std::printf("%d cases, %d failed checks\n", ran, Failures());
+        return Failures() == 0 && ran > 0 ? 0 : 1;
+    }
+}
+
+#define FB_TEST(name)                                             \
+    static void name();                                           \
+    static const FBTest::Registrar name##_registrar{#name, name}; \
+    static void name()
+
+#define FB_CHECK(expr)                                \
+    do {                                              \
+        if (!(expr)) {                                \
+            FBTest::Fail(__FILE__, __LINE__, #expr);  \
+        }                                             \
+    } while (false)
+
+#define FB_CHECK_NEAR(a, b, tolerance) FB_CHECK(std::fabs((a) - (b)) <= (tolerance))
@@ -0,0 +1,147 @@
+// FBUpdate evaluate phase against 1-500 loaded actors: every actor runs a timeline that keeps one
+// scale and one morph tween per channel going, and the frame's Tick (merge the previous pass,
+// apply its writes, flush morphs, submit the next pass) is timed. The morph sink only counts.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FBEvents.h"
+#include "FBMetrics.h"
+#include "FBMorph.h"
+#include "FBTags.h"
+#include "FBTest.h"
+#include "FBTriggers.h"
+#include "FBUpdate.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float kFrameSeconds = 1.0f / 60.0f;
+    constexpr std::uint32_t kWarmupFrames = 30;
+    constexpr std::uint32_t kFrames = 240;
+    constexpr std::array<std::uint32_t, 6> kActorCounts{1, 10, 50, 100, 250, 500};
+    constexpr RE::FormID kFirstActor = 0x10000001;
+
+    class CountingSink final : public FB::Morph::IBodyMorphSink {
+    public:
+        const char* Name() const override { return "FBUpdateBench"; }
+        void Submit(RE::Actor*, std::span<const RE::BSFixedString> setNames, std::span<const float>,
+                    std::span<const RE::BSFixedString>) override {
+            ++batches;
+            sets += setNames.size();
+        }
+
+        std::uint64_t batches = 0;
+        std::uint64_t sets = 0;
+    };
+
+    // A loaded actor with the skeleton the script writes.
+    struct LoadedActor {
+        explicit LoadedActor(RE::FormID id) : actor(id), root("NPC Root [Root]") {
+            Standin::Load3D(actor, root,
+                            {"NPC Head [Head]", "NPC Spine1 [Spn1]", "NPC L Hand [LHnd]", "NPC R Hand [RHnd]"});
+            actor.position = {static_cast<float>(id & 0xFF) * 64.0f, static_cast<float>((id >> 8) & 0xFF) * 64.0f,
+                              0.0f};
+            Standin::RegisterForm(&actor);
+            RE::ProcessLists::GetSingleton()->highActorHandles.push_back(actor.GetHandle());
+        }
+
+        RE::Actor actor;
+        RE::NiNode root;
+    };
+
+    // Four scale and four morph channels, each with a one-second tween starting every second.
+    std::string EvalScript(std::uint32_t seconds) {
+        constexpr std::array<std::string_view, 4> nodes{"Head", "Spine1", "LHand", "RHand"};
+        std::string ini = "[FB:FBEval.hkx|Caster]\n";
+        for (std::uint32_t s = 0; s < seconds; ++s) {
+            for (std::uint32_t c = 0; c < 8; ++c) {
+                const float time = static_cast<float>(s) + static_cast<float>(c) / 8.0f;
+                if (c < 4) {
+                    ini += fmt::format("{:.3f} FBScale_{}({}, tween=1, blend=mul)\n", time, nodes[c],
+                                       s % 2 ? "1.0" : "1.2");
+                } else {
+                    ini += fmt::format("{:.3f} FBMorph_FBEval{}({}, tween=1)\n", time, c - 4, s % 2 ? "0.0" : "1.0");
+                }
+            }
+        }
+        return ini;
+    }
+
+    double Percentile(std::vector<double> samples, double fraction) {
+        std::sort(samples.begin(), samples.end());
+        return samples[static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1))];
+    }
+}
+
+FB_TEST(EvaluatePhaseScalesWithActors) {
+    const auto seconds = static_cast<std::uint32_t>((kWarmupFrames + kFrames) * kFrameSeconds) + 2;
+    auto snap = FBTest::BuildSnapshot("EvaluatePhaseScalesWithActors",
+                                      "[General]\nHkxAnnotations=false\nStatsLogInterval=0\n\n"
+                                      "[FBFiles]\nFBEval=FBEval.hkx\n\n[EventMap]\nFBEval=FBEval.hkx\n",
+                                      "FBEval", EvalScript(seconds));
+    FB_CHECK(snap != nullptr);
+    if (!snap) {
+        return;
+    }
+
+    CountingSink sink;
+    FB::Morph::SetSink(&sink);
+
+    std::printf("  %7s %10s %10s %14s %14s\n", "actors", "p50 us", "p99 us", "p50 us/actor", "tweens/frame");
+    for (const auto count : kActorCounts) {
+        Standin::Reset();
+        std::vector<std::unique_ptr<LoadedActor>> actors;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            actors.push_back(std::make_unique<LoadedActor>(kFirstActor + i));
+        }
+
+        FBConfig config(snap);
+        FBEvents events;
+        FBTriggers triggers;
+        auto update = std::make_unique<FBUpdate>(config, events, triggers);
+        update->Tick(kFrameSeconds);  // takes the snapshot's generation
+
+        FBEvent e{};
+        e.tag = FB::Tags::Intern("FBEval");
+        for (const auto& loaded : actors) {
+            e.actor.formID = loaded->actor.formID;
+            events.Push(e);
+        }
+
+        for (std::uint32_t f = 0; f < kWarmupFrames; ++f) {
+            update->Tick(kFrameSeconds);
+        }
+
+        const auto tweensBefore = FB::Metrics::Get(FB::Metrics::Counter::TweensEvaluated);
+        const auto batchesBefore = sink.batches;
+        std::vector<double> samples;
+        samples.reserve(kFrames);
+        for (std::uint32_t f = 0; f < kFrames; ++f) {
+            const auto start = Clock::now();
+            update->Tick(kFrameSeconds);
+            samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        const auto tweens = FB::Metrics::Get(FB::Metrics::Counter::TweensEvaluated) - tweensBefore;
+        FB_CHECK(update->ActiveTimelineCount() == count);
+        update.reset();  // joins the last pass
+
+        const double p50 = Percentile(samples, 0.50);
+        std::printf("  %7u %10.1f %10.1f %14.2f %14.1f\n", count, p50, Percentile(samples, 0.99), p50 / count,
+                    static_cast<double>(tweens) / kFrames);
+
+        // Every actor's morphs reached the sink and its head was scaled.
+        FB_CHECK(sink.batches - batchesBefore >= count);
+        FB_CHECK(tweens >= static_cast<std::uint64_t>(count) * kFrames);
+        const auto* head = actors.back()->root.GetObjectByName("NPC Head [Head]");
+        FB_CHECK(head && head->local.scale != 1.0f);
+    }
+
+    FB::Morph::SetSink(nullptr);
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
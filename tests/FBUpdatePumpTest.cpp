@@ -0,0 +1,173 @@
+// FBUpdatePump: idle overhead (wakeups, queued tasks, ticks per second while parked) and the dt
+// handed to FBUpdate when a park ends.
+
+#include <chrono>
+#include <thread>
+
+#include "FBEvents.h"
+#include "FBTags.h"
+#include "FBTest.h"
+#include "FBTriggers.h"
+#include "FBUpdate.h"
+#include "FBUpdatePump.h"
+
+namespace {
+    using namespace std::chrono_literals;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto kIdleWindow = 1s;
+
+    struct Counts {
+        std::uint64_t wakeups = 0;
+        std::uint64_t tasks = 0;
+        std::uint64_t ticks = 0;
+    };
+
+    Counts Sample(const FBUpdatePump& pump) {
+        return {pump.WorkerWakeups(), Standin::TasksQueued(), pump.TicksRun()};
+    }
+
+    // The game thread while the fallback worker drives: runs queued tasks every ~2 ms.
+    void RunGameThread(std::chrono::milliseconds duration) {
+        const auto until = Clock::now() + duration;
+        while (Clock::now() < until) {
+            Standin::RunTasks();
+            std::this_thread::sleep_for(2ms);
+        }
+        Standin::RunTasks();
+    }
+
+    struct Harness {
+        explicit Harness(std::shared_ptr<const Snapshot> snap)
+            : config(std::move(snap)), update(config, events, triggers), pump(update) {}
+
+        FBConfig config;
+        FBEvents events;
+        FBTriggers triggers;
+        FBUpdate update;
+        FBUpdatePump pump;
+    };
+
+    std::shared_ptr<Snapshot> EmptySnapshot() {
+        auto snap = std::make_shared<Snapshot>();
+        snap->generation = 1;
+        snap->StatsLogInterval = 0.0f;
+        return snap;
+    }
+}
+
+FB_TEST(IdleWorkerDoesNotWake) {
+    Harness h(EmptySnapshot());
+    h.pump.Start();
+
+    RunGameThread(200ms);  // first ticks, then parked with nothing scheduled
+    FB_CHECK(h.pump.TicksRun() > 0);
+
+    const auto before = Sample(h.pump);
+    RunGameThread(kIdleWindow);
+    const auto after = Sample(h.pump);
+
+    std::printf("  idle: %llu wakeups/s, %llu tasks/s, %llu ticks/s\n",
+                static_cast<unsigned long long>(after.wakeups - before.wakeups),
+                static_cast<unsigned long long>(after.tasks - before.tasks),
+                static_cast<unsigned long long>(after.ticks - before.ticks));
+    FB_CHECK(after.wakeups == before.wakeups);
+    FB_CHECK(after.tasks == before.tasks);
+    FB_CHECK(after.ticks == before.ticks);
+
+    // Wake() un-parks it for a tick, then it parks again.
+    h.pump.Wake();
+    RunGameThread(100ms);
+    const auto woken = Sample(h.pump);
+    FB_CHECK(woken.ticks > after.ticks);
+    FB_CHECK(woken.ticks - after.ticks <= 3);
+    FB_CHECK(woken.tasks - after.tasks <= 3);
+
+    h.pump.Stop();
+}
+
+FB_TEST(IdleFramesDoNotTick) {
+    Harness h(EmptySnapshot());
+    h.pump.Start();
+
+    for (int i = 0; i < 5; ++i) {
+        h.pump.OnFrame();
+    }
+    const auto before = Sample(h.pump);
+
+    for (int frame = 0; frame < 600; ++frame) {
+        h.pump.OnFrame();
+    }
+    const auto after = Sample(h.pump);
+
+    FB_CHECK(after.ticks == before.ticks);
+    FB_CHECK(after.tasks == before.tasks);
+    h.pump.Stop();
+}
+
+FB_TEST(ResumeAfterParkIsClamped) {
+    auto snap = FBTest::BuildSnapshot("ResumeAfterParkIsClamped",
+                                      "[General]\nHkxAnnotations=false\nStatsLogInterval=0\n\n"
+                                      "[FBFiles]\nFBPark=FBPark.hkx\n",
+                                      "FBPark",
+                                      "[FB:FBPark.hkx|Caster]\n"
+                                      "0.20 FBScale_Head(1.2)\n"
+                                      "5.00 FBScale_Head(1.0)\n");
+    FB_CHECK(snap != nullptr);
+    if (!snap) {
+        return;
+    }
+
+    Harness h(snap);
+    h.pump.Start();
+
+    // Settle on the snapshot, then start the timeline between passes.
+    for (int i = 0; i < 3; ++i) {
+        h.pump.OnFrame();
+    }
+    FBEvent e{};
+    e.tag = FB::Tags::Intern("FBPark");
+    e.actor.formID = 0x0F000001;  // no such actor: nothing reaches the engine
+    h.update.StartTimelineUnbound(e, "FBPark.hkx");
+    h.pump.Wake();
+    for (int i = 0; i < 3; ++i) {
+        h.pump.OnFrame();
+    }
+
+    // Parked until the 0.2 s keyframe; the game then stalls for a full second.
+    const float parkedAt = h.update.NowSeconds();
+    const auto ticks = h.pump.TicksRun();
+    h.pump.OnFrame();
+    FB_CHECK(h.pump.TicksRun() == ticks);
+
+    std::this_thread::sleep_for(1s);
+    h.pump.OnFrame();
+    FB_CHECK(h.pump.TicksRun() == ticks + 1);
+
+    // The planned park (at most 0.2 s) plus one clamped step, not the whole stall.
+    const float step = h.update.NowSeconds() - parkedAt;
+    std::printf("  resumed with dt=%.3f s after a 1 s stall\n", step);
+    FB_CHECK(step > 0.1f);
+    FB_CHECK(step <= 0.2f + 0.1f + 1e-3f);
+
+    h.pump.Stop();
+}
+
+FB_TEST(ResumeFromIdleIsClamped) {
+    Harness h(EmptySnapshot());
+    h.pump.Start();
+
+    for (int i = 0; i < 3; ++i) {
+        h.pump.OnFrame();
+    }
+    const float parkedAt = h.update.NowSeconds();
+
+    std::this_thread::sleep_for(300ms);
+    h.pump.Wake();
+    h.pump.OnFrame();
+
+    FB_CHECK(h.update.NowSeconds() - parkedAt <= 0.1f + 1e-3f);
+    h.pump.Stop();
+}
+
+int main(int argc, char** argv) { return FBTest::RunAll(argc, argv); }
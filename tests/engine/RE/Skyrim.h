@@ -0,0 +1,648 @@
+#pragma once
+
+// Stand-in for the parts of CommonLibSSE-NG the plugin sources use, so they build and run on
+// Linux. Declarations follow CommonLib's names and signatures; the behaviour is the smallest
+// that keeps the plugin's logic honest:
+//   - forms live in a registry (Standin::RegisterForm) that LookupByID / LookupByEditorID and
+//     handles resolve through; a handle goes stale once its form is unregistered
+//   - BSFixedString is pooled and case-insensitive, like the engine's string cache
+//   - NiNode trees are real, GetObjectByName searches them
+//   - audio, reference effects and the Papyrus VM are absent: tests install stand-in backends
+//     through FB::Fx / FB::Dispatch / FB::Morph instead
+// Test-side controls are in Standin.h.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace RE {
+    using FormID = std::uint32_t;
+
+    struct NiPoint3 {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        float GetDistance(const NiPoint3& other) const;
+    };
+
+    // Pooled: equal strings (ignoring case) share one data pointer.
+    class BSFixedString {
+    public:
+        BSFixedString() = default;
+        BSFixedString(const char* text);
+        BSFixedString(std::string_view text);
+        BSFixedString(const std::string& text) : BSFixedString(std::string_view(text)) {}
+
+        const char* c_str() const { return _data ? _data : ""; }
+        const char* data() const { return c_str(); }
+        bool empty() const { return !_data || !*_data; }
+        std::size_t size() const { return std::string_view(c_str()).size(); }
+        std::size_t length() const { return size(); }
+
+        bool operator==(const BSFixedString& other) const { return c_str() == other.c_str(); }
+        bool operator==(const char* other) const { return *this == BSFixedString(other); }
+        bool operator==(std::string_view other) const { return *this == BSFixedString(other); }
+
+        operator std::string_view() const { return c_str(); }
+
+    private:
+        const char* _data = nullptr;
+    };
+
+    // Not reference counted here: everything a NiPointer can point to is owned by the test.
+    template <class T>
+    class NiPointer {
+    public:
+        NiPointer() = default;
+        NiPointer(T* ptr) : _ptr(ptr) {}
+
+        T* get() const { return _ptr; }
+        T* operator->() const { return _ptr; }
+        T& operator*() const { return *_ptr; }
+        explicit operator bool() const { return _ptr != nullptr; }
+
+    private:
+        T* _ptr = nullptr;
+    };
+
+    template <class T>
+    class BSTSmartPointer {
+    public:
+        BSTSmartPointer() = default;
+        BSTSmartPointer(T* ptr) : _ptr(ptr) {}
+        template <class U>
+        BSTSmartPointer(const BSTSmartPointer<U>& other) : _ptr(other._ptr) {}
+
+        T* get() const { return _ptr.get(); }
+        T* operator->() const { return _ptr.get(); }
+        T& operator*() const { return *_ptr; }
+        explicit operator bool() const { return _ptr != nullptr; }
+
+    private:
+        template <class>
+        friend class BSTSmartPointer;
+
+        std::shared_ptr<T> _ptr;
+    };
+
+    template <class T, class... Args>
+    BSTSmartPointer<T> make_smart(Args&&... args) {
+        return BSTSmartPointer<T>(new T(std::forward<Args>(args)...));
+    }
+
+    class TESForm;
+    class TESObjectREFR;
+    class Actor;
+
+    namespace detail {
+        TESForm* LookupHandle(std::uint32_t handle);
+    }
+
+    // A handle is the form ID of its reference; get() resolves it through the form registry.
+    template <class T>
+    class BSPointerHandle {
+    public:
+        BSPointerHandle() = default;
+        explicit BSPointerHandle(std::uint32_t handle) : _handle(handle) {}
+
+        NiPointer<T> get() const;
+        std::uint32_t native_handle() const { return _handle; }
+        explicit operator bool() const { return _handle != 0; }
+        bool operator==(const BSPointerHandle&) const = default;
+
+    private:
+        std::uint32_t _handle = 0;
+    };
+
+    using ActorHandle = BSPointerHandle<Actor>;
+    using ObjectRefHandle = BSPointerHandle<TESObjectREFR>;
+
+    enum class FormType : std::uint8_t
+    {
+        None = 0,
+        Sound = 3,
+        EffectShader = 85,
+        SoundRecord = 106,
+        ArtObject = 125,
+        Reference = 61,
+        ActorCharacter = 62
+    };
+
+    class TESForm {
+    public:
+        TESForm() = default;
+        TESForm(FormID id, FormType type) : formID(id), formType(type) {}
+        TESForm(const TESForm&) = delete;
+        TESForm& operator=(const TESForm&) = delete;
+        virtual ~TESForm() = default;
+
+        static TESForm* LookupByID(FormID id);
+        template <class T>
+        static T* LookupByID(FormID id) {
+            auto* form = LookupByID(id);
+            return form ? form->As<T>() : nullptr;
+        }
+        static TESForm* LookupByEditorID(std::string_view editorID);
+
+        template <class T>
+        T* As() {
+            return dynamic_cast<T*>(this);
+        }
+        template <class T>
+        const T* As() const {
+            return dynamic_cast<const T*>(this);
+        }
+
+        FormType GetFormType() const { return formType; }
+        FormID GetFormID() const { return formID; }
+
+        FormID formID = 0;
+        FormType formType = FormType::None;
+    };
+
+    template <class T>
+    NiPointer<T> BSPointerHandle<T>::get() const {
+        auto* form = _handle ? detail::LookupHandle(_handle) : nullptr;
+        return NiPointer<T>(form ? dynamic_cast<T*>(form) : nullptr);
+    }
+
+    //
+    // Scene graph
+    //
+
+    struct NiTransform {
+        float scale = 1.0f;
+        NiPoint3 translate;
+    };
+
+    struct NiUpdateData {
+        enum class Flag : std::uint32_t
+        {
+            kNone = 0,
+            kDirty = 1 << 0
+        };
+
+        float time = 0.0f;
+        Flag flags = Flag::kNone;
+    };
+
+    template <class E>
+    class EnumSet {
+    public:
+        EnumSet& set(E value) {
+            _bits |= static_cast<std::uint32_t>(value);
+            return *this;
+        }
+        bool all(E value) const {
+            const auto bits = static_cast<std::uint32_t>(value);
+            return (_bits & bits) == bits;
+        }
+
+    private:
+        std::uint32_t _bits = 0;
+    };
+
+    class NiNode;
+
+    class NiAVObject {
+    public:
+        enum class Flag : std::uint32_t
+        {
+            kNone = 0,
+            kForceUpdate = 1 << 0
+        };
+
+        explicit NiAVObject(std::string_view name = {}) : name(name) {}
+        NiAVObject(const NiAVObject&) = delete;
+        NiAVObject& operator=(const NiAVObject&) = delete;
+        virtual ~NiAVObject() = default;
+
+        // This object when the name matches, else the first match below it, depth first.
+        virtual NiAVObject* GetObjectByName(const BSFixedString& objectName) {
+            return name == objectName ? this : nullptr;
+        }
+
+        EnumSet<Flag>& GetFlags() { return _flags; }
+        void UpdateWorldData(NiUpdateData* data);
+        void UpdateWorldBound() {}
+
+        BSFixedString name;
+        NiNode* parent = nullptr;
+        NiTransform local;
+        NiTransform world;
+
+    private:
+        EnumSet<Flag> _flags;
+    };
+
+    class NiNode : public NiAVObject {
+    public:
+        using NiAVObject::NiAVObject;
+
+        NiAVObject* GetObjectByName(const BSFixedString& objectName) override;
+
+        // Takes ownership; returns the child.
+        template <class T = NiNode>
+        T* AttachChild(std::string_view childName) {
+            auto child = std::make_unique<T>(childName);
+            child->parent = this;
+            auto* raw = child.get();
+            children.push_back(std::move(child));
+            return raw;
+        }
+
+        std::vector<std::unique_ptr<NiAVObject>> children;
+    };
+
+    //
+    // References and actors
+    //
+
+    struct BSSpinLock {};
+
+    struct BSSpinLockGuard {
+        explicit BSSpinLockGuard(BSSpinLock&) {}
+    };
+
+    class BSFaceGenKeyframeMultiple {
+    public:
+        float* values = nullptr;
+        std::uint32_t count = 0;
+        bool isUpdated = true;
+    };
+
+    class BSFaceGenAnimationData {
+    public:
+        void SetExpressionOverride(std::uint32_t mood, float value) {
+            if (!exprOverride) {
+                overrideMood = mood;
+                overrideValue = value;
+            }
+        }
+
+        BSFaceGenKeyframeMultiple phoneme2;
+        BSFaceGenKeyframeMultiple modifier2;
+        BSSpinLock lock;
+        bool exprOverride = false;
+
+        std::uint32_t overrideMood = 0;
+        float overrideValue = 0.0f;
+    };
+
+    class BSAnimationGraphManager;
+    class ModelReferenceEffect;
+    class ShaderReferenceEffect;
+    class TESEffectShader;
+    class BGSArtObject;
+
+    class TESObjectREFR : public TESForm {
+    public:
+        explicit TESObjectREFR(FormID id, FormType type = FormType::Reference) : TESForm(id, type) {}
+
+        // No reference effects in the stand-in: FB::Fx tests install a visual backend.
+        ModelReferenceEffect* ApplyArtObject(BGSArtObject* art, float time = -1.0f, TESObjectREFR* facing = nullptr,
+                                             bool faceTarget = false, bool attachToCamera = false,
+                                             NiAVObject* attachNode = nullptr, bool interfaceEffect = false);
+        ShaderReferenceEffect* ApplyEffectShader(TESEffectShader* shader, float time = -1.0f,
+                                                 TESObjectREFR* facing = nullptr, bool faceTarget = false,
+                                                 bool attachToCamera = false, NiAVObject* attachNode = nullptr,
+                                                 bool interfaceEffect = false);
+
+        NiAVObject* Get3D1(bool) const { return root3D; }
+        NiAVObject* Get3D() const { return root3D; }
+        bool Is3DLoaded() const { return root3D != nullptr; }
+        NiPoint3 GetPosition() const { return position; }
+        ObjectRefHandle CreateRefHandle() { return ObjectRefHandle(formID); }
+        bool GetAnimationGraphManager(BSTSmartPointer<BSAnimationGraphManager>& out) const;
+
+        NiPoint3 position;
+        NiNode* root3D = nullptr;  // owned by the test
+        BSTSmartPointer<BSAnimationGraphManager> graphManager;
+    };
+
+    enum class ActorValue : std::uint32_t
+    {
+        kNone = static_cast<std::uint32_t>(-1),
+        kSpeedMult = 30
+    };
+
+    class ActorValueOwner {
+    public:
+        float GetBaseActorValue(ActorValue av) {
+            const auto it = values.find(av);
+            return it != values.end() ? it->second : 0.0f;
+        }
+        void SetBaseActorValue(ActorValue av, float value) { values[av] = value; }
+
+        std::unordered_map<ActorValue, float> values;
+    };
+
+    enum class ACTOR_LIFE_STATE : std::uint32_t
+    {
+        kAlive = 0,
+        kDying = 1,
+        kDead = 2,
+        kUnconcious = 3,
+        kReanimate = 4,
+        kRecycle = 5,
+        kRestrained = 6,
+        kEssentialDown = 7,
+        kBleedout = 8
+    };
+
+    class ActorState {
+    public:
+        ACTOR_LIFE_STATE GetLifeState() const { return lifeState; }
+
+        ACTOR_LIFE_STATE lifeState = ACTOR_LIFE_STATE::kAlive;
+    };
+
+    class Actor : public TESObjectREFR {
+    public:
+        explicit Actor(FormID id) : TESObjectREFR(id, FormType::ActorCharacter) {}
+
+        ActorValueOwner* AsActorValueOwner() { return &actorValues; }
+        ActorState* AsActorState() { return &actorState; }
+        void SetLifeState(ACTOR_LIFE_STATE state) { actorState.lifeState = state; }
+        void EnableAI(bool enable) { aiEnabled = enable; }
+        bool IsAIEnabled() const { return aiEnabled; }
+        BSFaceGenAnimationData* GetFaceGenAnimationData() { return faceGen; }
+        ActorHandle GetHandle() { return ActorHandle(formID); }
+        ActorHandle CreateRefHandle() { return ActorHandle(formID); }
+        bool IsDead() const { return actorState.lifeState == ACTOR_LIFE_STATE::kDead; }
+
+        ActorValueOwner actorValues;
+        ActorState actorState;
+        bool aiEnabled = true;
+        BSFaceGenAnimationData* faceGen = nullptr;  // owned by the test; null = no head loaded
+    };
+
+    class Character : public Actor {
+    public:
+        using Actor::Actor;
+    };
+
+    class PlayerCharacter : public Character {
+    public:
+        static constexpr FormID kFormID = 0x14;
+
+        PlayerCharacter() : Character(kFormID) {}
+
+        // Whatever Standin::SetPlayer installed.
+        static PlayerCharacter* GetSingleton();
+    };
+
+    class ProcessLists {
+    public:
+        static ProcessLists* GetSingleton();
+
+        std::vector<ActorHandle> highActorHandles;
+    };
+
+    //
+    // Forms the effect commands resolve to
+    //
+
+    class BSISoundDescriptor {
+    public:
+        virtual ~BSISoundDescriptor() = default;
+    };
+
+    class BGSSoundDescriptorForm : public TESForm, public BSISoundDescriptor {
+    public:
+        explicit BGSSoundDescriptorForm(FormID id) : TESForm(id, FormType::SoundRecord) {}
+    };
+
+    class TESEffectShader : public TESForm {
+    public:
+        explicit TESEffectShader(FormID id) : TESForm(id, FormType::EffectShader) {}
+    };
+
+    class BGSArtObject : public TESForm {
+    public:
+        explicit BGSArtObject(FormID id) : TESForm(id, FormType::ArtObject) {}
+    };
+
+    class BSTempEffect {
+    public:
+        virtual ~BSTempEffect() = default;
+
+        float lifetime = 0.0f;
+        float age = 0.0f;
+        bool initialized = false;
+    };
+
+    class ReferenceEffect : public BSTempEffect {
+    public:
+        bool finished = false;
+    };
+
+    class ModelReferenceEffect : public ReferenceEffect {};
+    class ShaderReferenceEffect : public ReferenceEffect {};
+
+    // No audio device: GetSingleton() is null, so the game audio backend never starts a sound.
+    class BSSoundHandle {
+    public:
+        bool Play() { return false; }
+        bool Stop() { return true; }
+        bool IsPlaying() const { return false; }
+        bool IsValid() const { return false; }
+        void SetObjectToFollow(NiAVObject*) {}
+        bool SetPosition(NiPoint3) { return false; }
+
+        std::uint32_t soundID = static_cast<std::uint32_t>(-1);
+    };
+
+    class BSAudioManager {
+    public:
+        static BSAudioManager* GetSingleton() { return nullptr; }
+        bool BuildSoundDataFromDescriptor(BSSoundHandle&, BSISoundDescriptor*, std::uint32_t = 0x1A) {
+            return false;
+        }
+    };
+
+    // Plugin-local lookups go through the forms Standin::RegisterPluginForm added.
+    class TESDataHandler {
+    public:
+        static TESDataHandler* GetSingleton();
+
+        TESForm* LookupForm(FormID localID, std::string_view plugin);
+        template <class T>
+        T* LookupForm(FormID localID, std::string_view plugin) {
+            auto* form = LookupForm(localID, plugin);
+            return form ? form->As<T>() : nullptr;
+        }
+    };
+
+    class ActorValueList {
+    public:
+        static ActorValueList* GetSingleton();
+        ActorValue LookupActorValueByName(std::string_view name);
+    };
+
+    //
+    // Events
+    //
+
+    enum class BSEventNotifyControl
+    {
+        kContinue = 0,
+        kStop = 1
+    };
+
+    template <class E>
+    class BSTEventSource;
+
+    template <class E>
+    class BSTEventSink {
+    public:
+        virtual ~BSTEventSink() = default;
+        virtual BSEventNotifyControl ProcessEvent(const E* event, BSTEventSource<E>* source) = 0;
+    };
+
+    template <class E>
+    class BSTEventSource {
+    public:
+        void AddEventSink(BSTEventSink<E>* sink) {
+            if (std::find(_sinks.begin(), _sinks.end(), sink) == _sinks.end()) {
+                _sinks.push_back(sink);
+            }
+        }
+        void RemoveEventSink(BSTEventSink<E>* sink) { std::erase(_sinks, sink); }
+
+        void SendEvent(const E* event) {
+            const auto sinks = _sinks;
+            for (auto* sink : sinks) {
+                if (sink->ProcessEvent(event, this) == BSEventNotifyControl::kStop) {
+                    break;
+                }
+            }
+        }
+
+        std::size_t SinkCount() const { return _sinks.size(); }
+
+    private:
+        std::vector<BSTEventSink<E>*> _sinks;
+    };
+
+    struct TESObjectLoadedEvent {
+        FormID formID = 0;
+        bool loaded = false;
+    };
+
+    class ScriptEventSourceHolder : public BSTEventSource<TESObjectLoadedEvent> {
+    public:
+        static ScriptEventSourceHolder* GetSingleton();
+
+        template <class E>
+        void AddEventSink(BSTEventSink<E>* sink) {
+            BSTEventSource<E>::AddEventSink(sink);
+        }
+    };
+
+    struct BSAnimationGraphEvent {
+        BSFixedString tag;
+        BSFixedString payload;
+        const TESObjectREFR* holder = nullptr;
+    };
+
+    class BShkbAnimationGraph : public BSTEventSource<BSAnimationGraphEvent> {};
+
+    class BSAnimationGraphManager {
+    public:
+        std::vector<BSTSmartPointer<BShkbAnimationGraph>> graphs;
+    };
+
+    inline bool TESObjectREFR::GetAnimationGraphManager(BSTSmartPointer<BSAnimationGraphManager>& out) const {
+        out = graphManager;
+        return static_cast<bool>(out);
+    }
+
+    //
+    // Papyrus
+    //
+
+    struct StaticFunctionTag {};
+
+    namespace BSScript {
+        class Object {};
+
+        class Variable {};
+
+        class IFunctionArguments {
+        public:
+            virtual ~IFunctionArguments() = default;
+        };
+
+        class IStackCallbackFunctor {
+        public:
+            virtual ~IStackCallbackFunctor() = default;
+            virtual void operator()(Variable result) = 0;
+            virtual bool CanSave() const { return false; }
+            virtual void SetObject(const BSTSmartPointer<Object>& object) = 0;
+        };
+
+        using VMHandle = std::uint64_t;
+
+        class IObjectHandlePolicy {
+        public:
+            VMHandle GetHandleForObject(FormType, const void*) { return 0; }
+            VMHandle EmptyHandle() { return 0; }
+        };
+
+        // Never reached: SkyrimVM::GetSingleton() is null, so calls go to a stand-in backend.
+        class IVirtualMachine {
+        public:
+            template <class F>
+            void RegisterFunction(std::string_view, std::string_view, F) {}
+            IObjectHandlePolicy* GetObjectHandlePolicy() { return nullptr; }
+            bool DispatchStaticCall(const BSFixedString&, const BSFixedString&, IFunctionArguments*,
+                                    BSTSmartPointer<IStackCallbackFunctor>&) {
+                return false;
+            }
+            bool DispatchMethodCall(VMHandle, const BSFixedString&, const BSFixedString&, IFunctionArguments*,
+                                    BSTSmartPointer<IStackCallbackFunctor>&) {
+                return false;
+            }
+        };
+    }
+
+    // The packed arguments, readable by a stand-in VM backend.
+    template <class... Args>
+    class FunctionArguments final : public BSScript::IFunctionArguments {
+    public:
+        explicit FunctionArguments(Args... args) : values(std::move(args)...) {}
+
+        std::tuple<Args...> values;
+    };
+
+    template <class... Args>
+    BSScript::IFunctionArguments* MakeFunctionArguments(Args&&... args) {
+        return new FunctionArguments<std::decay_t<Args>...>(std::forward<Args>(args)...);
+    }
+
+    class SkyrimVM {
+    public:
+        static SkyrimVM* GetSingleton() { return nullptr; }
+
+        BSTSmartPointer<BSScript::IVirtualMachine> impl;
+    };
+
+    class ConsoleLog {
+    public:
+        static ConsoleLog* GetSingleton() { return nullptr; }
+        void Print(const char*, ...) {}
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// Stand-in for the SKSE interfaces the plugin sources use. Tasks queue until the test runs them
+// on its "game thread" (Standin::RunTasks); messages reach whatever partner the test installed
+// with Standin::SetMessageReceiver (none by default, so SKEE never answers).
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+
+#include "RE/Skyrim.h"
+
+namespace SKSE {
+    class TaskInterface {
+    public:
+        void AddTask(std::function<void()> task);
+    };
+
+    TaskInterface* GetTaskInterface();
+
+    class MessagingInterface {
+    public:
+        struct Message {
+            std::uint32_t type = 0;
+            std::uint32_t dataLen = 0;
+            const char* sender = nullptr;
+            void* data = nullptr;
+        };
+
+        enum : std::uint32_t
+        {
+            kPostLoad,
+            kPostPostLoad,
+            kPreLoadGame,
+            kPostLoadGame,
+            kSaveGame,
+            kDeleteGame,
+            kInputLoaded,
+            kNewGame,
+            kDataLoaded
+        };
+
+        bool Dispatch(std::uint32_t messageType, void* data, std::uint32_t dataLen, const char* receiver);
+    };
+
+    MessagingInterface* GetMessagingInterface();
+
+    namespace log {
+        // Whatever Standin::SetLogDirectory installed.
+        std::optional<std::filesystem::path> log_directory();
+    }
+}
@@ -0,0 +1,290 @@
+#include "Standin.h"
+
+#include <cctype>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "SKSE/SKSE.h"
+
+namespace {
+    std::string Lower(std::string_view text) {
+        std::string out(text);
+        for (auto& c : out) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return out;
+    }
+
+    // The string cache: first spelling of each case-insensitive string, never freed.
+    struct StringPool {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<std::string>> entries;  // by lower case
+    };
+
+    StringPool& Pool() {
+        static StringPool pool;
+        return pool;
+    }
+
+    struct FormRegistry {
+        std::shared_mutex mutex;
+        std::unordered_map<RE::FormID, RE::TESForm*> byID;
+        std::unordered_map<std::string, RE::TESForm*> byEditorID;                 // lower case
+        std::unordered_map<std::string, std::unordered_map<RE::FormID, RE::TESForm*>> byPlugin;  // lower case
+    };
+
+    FormRegistry& Forms() {
+        static FormRegistry registry;
+        return registry;
+    }
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::uint64_t queued = 0;
+    };
+
+    TaskQueue& Tasks() {
+        static TaskQueue queue;
+        return queue;
+    }
+
+    RE::PlayerCharacter* g_player = nullptr;
+    RE::ProcessLists g_processLists;
+    RE::ScriptEventSourceHolder g_scriptEvents;
+    RE::TESDataHandler g_dataHandler;
+    RE::ActorValueList g_actorValues;
+    SKSE::TaskInterface g_taskInterface;
+    SKSE::MessagingInterface g_messaging;
+    std::unordered_map<std::string, Standin::MessageHandler> g_messageReceivers;  // lower case
+    std::optional<std::filesystem::path> g_logDirectory;
+}
+
+namespace RE {
+    float NiPoint3::GetDistance(const NiPoint3& other) const {
+        const float dx = x - other.x;
+        const float dy = y - other.y;
+        const float dz = z - other.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    BSFixedString::BSFixedString(const char* text) : BSFixedString(std::string_view(text ? text : "")) {}
+
+    BSFixedString::BSFixedString(std::string_view text) {
+        auto& pool = Pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        auto [it, inserted] = pool.entries.try_emplace(Lower(text));
+        if (inserted) {
+            it->second = std::make_unique<std::string>(text);
+        }
+        _data = it->second->c_str();
+    }
+
+    void NiAVObject::UpdateWorldData(NiUpdateData*) {
+        world = local;
+        if (parent) {
+            world.scale = parent->world.scale * local.scale;
+            world.translate.x += parent->world.translate.x;
+            world.translate.y += parent->world.translate.y;
+            world.translate.z += parent->world.translate.z;
+        }
+    }
+
+    NiAVObject* NiNode::GetObjectByName(const BSFixedString& objectName) {
+        if (name == objectName) {
+            return this;
+        }
+        for (auto& child : children) {
+            if (auto* found = child->GetObjectByName(objectName); found) {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+    ModelReferenceEffect* TESObjectREFR::ApplyArtObject(BGSArtObject*, float, TESObjectREFR*, bool, bool,
+                                                        NiAVObject*, bool) {
+        return nullptr;
+    }
+
+    ShaderReferenceEffect* TESObjectREFR::ApplyEffectShader(TESEffectShader*, float, TESObjectREFR*, bool, bool,
+                                                            NiAVObject*, bool) {
+        return nullptr;
+    }
+
+    TESForm* TESForm::LookupByID(FormID id) {
+        auto& forms = Forms();
+        std::shared_lock lock(forms.mutex);
+        const auto it = forms.byID.find(id);
+        return it != forms.byID.end() ? it->second : nullptr;
+    }
+
+    TESForm* TESForm::LookupByEditorID(std::string_view editorID) {
+        auto& forms = Forms();
+        std::shared_lock lock(forms.mutex);
+        const auto it = forms.byEditorID.find(Lower(editorID));
+        return it != forms.byEditorID.end() ? it->second : nullptr;
+    }
+
+    TESForm* detail::LookupHandle(std::uint32_t handle) { return TESForm::LookupByID(handle); }
+
+    PlayerCharacter* PlayerCharacter::GetSingleton() { return g_player; }
+
+    ProcessLists* ProcessLists::GetSingleton() { return &g_processLists; }
+
+    ScriptEventSourceHolder* ScriptEventSourceHolder::GetSingleton() { return &g_scriptEvents; }
+
+    TESDataHandler* TESDataHandler::GetSingleton() { return &g_dataHandler; }
+
+    TESForm* TESDataHandler::LookupForm(FormID localID, std::string_view plugin) {
+        auto& forms = Forms();
+        std::shared_lock lock(forms.mutex);
+        const auto file = forms.byPlugin.find(Lower(plugin));
+        if (file == forms.byPlugin.end()) {
+            return nullptr;
+        }
+        const auto it = file->second.find(localID & 0x00FFFFFF);
+        return it != file->second.end() ? it->second : nullptr;
+    }
+
+    ActorValueList* ActorValueList::GetSingleton() { return &g_actorValues; }
+
+    ActorValue ActorValueList::LookupActorValueByName(std::string_view name) {
+        return Lower(name) == "speedmult" ? ActorValue::kSpeedMult : ActorValue::kNone;
+    }
+}
+
+namespace SKSE {
+    void TaskInterface::AddTask(std::function<void()> task) {
+        auto& queue = Tasks();
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        ++queue.queued;
+    }
+
+    TaskInterface* GetTaskInterface() { return &g_taskInterface; }
+
+    bool MessagingInterface::Dispatch(std::uint32_t messageType, void* data, std::uint32_t, const char* receiver) {
+        const auto it = g_messageReceivers.find(Lower(receiver ? receiver : ""));
+        return it != g_messageReceivers.end() && it->second(messageType, data);
+    }
+
+    MessagingInterface* GetMessagingInterface() { return &g_messaging; }
+
+    std::optional<std::filesystem::path> log::log_directory() { return g_logDirectory; }
+}
+
+namespace Standin {
+    void RegisterForm(RE::TESForm* form) {
+        auto& forms = Forms();
+        std::unique_lock lock(forms.mutex);
+        forms.byID[form->formID] = form;
+    }
+
+    void UnregisterForm(RE::TESForm* form) {
+        auto& forms = Forms();
+        std::unique_lock lock(forms.mutex);
+        if (auto it = forms.byID.find(form->formID); it != forms.byID.end() && it->second == form) {
+            forms.byID.erase(it);
+        }
+        std::erase_if(forms.byEditorID, [form](const auto& entry) { return entry.second == form; });
+        for (auto& [plugin, local] : forms.byPlugin) {
+            std::erase_if(local, [form](const auto& entry) { return entry.second == form; });
+        }
+        if (form == g_player) {
+            g_player = nullptr;
+        }
+    }
+
+    void SetEditorID(std::string_view editorID, RE::TESForm* form) {
+        auto& forms = Forms();
+        std::unique_lock lock(forms.mutex);
+        forms.byEditorID[Lower(editorID)] = form;
+    }
+
+    void RegisterPluginForm(std::string_view plugin, RE::FormID localID, RE::TESForm* form) {
+        auto& forms = Forms();
+        std::unique_lock lock(forms.mutex);
+        forms.byPlugin[Lower(plugin)][localID & 0x00FFFFFF] = form;
+    }
+
+    void SetPlayer(RE::PlayerCharacter* player) {
+        if (g_player && g_player != player) {
+            UnregisterForm(g_player);
+        }
+        g_player = player;
+        if (player) {
+            RegisterForm(player);
+        }
+    }
+
+    void Load3D(RE::TESObjectREFR& ref, RE::NiNode& root, std::initializer_list<std::string_view> nodes) {
+        for (const auto name : nodes) {
+            root.AttachChild(name);
+        }
+        ref.root3D = &root;
+    }
+
+    std::size_t RunTasks() {
+        auto& queue = Tasks();
+        std::size_t ran = 0;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty()) {
+                    return ran;
+                }
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            task();
+            ++ran;
+        }
+    }
+
+    std::size_t PendingTasks() {
+        auto& queue = Tasks();
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        return queue.tasks.size();
+    }
+
+    std::uint64_t TasksQueued() {
+        auto& queue = Tasks();
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        return queue.queued;
+    }
+
+    void SetLogDirectory(const std::filesystem::path& directory) { g_logDirectory = directory; }
+
+    void SetMessageReceiver(std::string_view receiver, MessageHandler handler) {
+        if (handler) {
+            g_messageReceivers[Lower(receiver)] = std::move(handler);
+        } else {
+            g_messageReceivers.erase(Lower(receiver));
+        }
+    }
+
+    void Reset() {
+        {
+            auto& forms = Forms();
+            std::unique_lock lock(forms.mutex);
+            forms.byID.clear();
+            forms.byEditorID.clear();
+            forms.byPlugin.clear();
+        }
+        {
+            auto& queue = Tasks();
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.clear();
+        }
+        g_player = nullptr;
+        g_processLists.highActorHandles.clear();
+        g_messageReceivers.clear();
+    }
+}
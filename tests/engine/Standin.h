@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <initializer_list>
+#include <string_view>
+
+#include "RE/Skyrim.h"
+
+// Test-side controls of the stand-in engine. Forms are not owned: a test registers the objects it
+// owns and unregisters them (or calls Reset) before they go away.
+namespace Standin {
+    // LookupByID and handles resolve to `form` until it is unregistered.
+    void RegisterForm(RE::TESForm* form);
+    void UnregisterForm(RE::TESForm* form);
+
+    void SetEditorID(std::string_view editorID, RE::TESForm* form);
+    // TESDataHandler::LookupForm(localID, plugin); the plugin name compares case-insensitively.
+    void RegisterPluginForm(std::string_view plugin, RE::FormID localID, RE::TESForm* form);
+
+    // Registers `player` and makes it PlayerCharacter::GetSingleton(); nullptr removes it.
+    void SetPlayer(RE::PlayerCharacter* player);
+
+    // Gives `ref` the loaded 3D `root`, with one child node per name.
+    void Load3D(RE::TESObjectREFR& ref, RE::NiNode& root, std::initializer_list<std::string_view> nodes);
+
+    // Tasks queued through SKSE::GetTaskInterface(). RunTasks() runs them on the calling thread,
+    // including any they queue, and returns how many ran.
+    std::size_t RunTasks();
+    std::size_t PendingTasks();
+    std::uint64_t TasksQueued();
+
+    void SetLogDirectory(const std::filesystem::path& directory);
+
+    // SKSE messages dispatched to `receiver` (e.g. "SKEE") go to `handler`, which returns whether
+    // it took them; an empty handler removes the receiver.
+    using MessageHandler = std::function<bool(std::uint32_t type, void* data)>;
+    void SetMessageReceiver(std::string_view receiver, MessageHandler handler);
+
+    // Forgets every form, the player, the high-process list, queued tasks and message receivers.
+    void Reset();
+}